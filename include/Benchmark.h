@@ -0,0 +1,265 @@
+#ifndef Benchmark_h
+#define Benchmark_h
+
+#include "DualCore.h"
+#include "Mezclador.h"
+#include "PistaAudio.h"
+
+/*
+ * Microbenchmarks de las rutas críticas del juego.
+ * Se compilan sólo en el entorno esp32dev-bench (-DMODO_BENCHMARK): setup() los
+ * ejecuta en lugar de arrancar el juego e imprime líneas "BENCH <métrica> <valor>".
+ * tools/benchmark.py las compara con la línea base tools/benchmark_base.json.
+ */
+
+#define BENCH_REPETICIONES_SD 20
+#define BENCH_REPETICIONES_CUADRO 200
+#define BENCH_REPETICIONES_CPU 10000
+#define BENCH_ENTRADAS_MARCADOR 1000
+#define BENCH_SEMILLA 0x5EED
+#define BENCH_ARCHIVO_MARCADOR "/bench_marcador.idx"
+
+void ReportarMetrica(const char *nombre, float valor)
+{
+    Serial.printf("BENCH %s %.2f\n", nombre, valor);
+}
+
+//-- Marcador en la SD, sobre un archivo aparte para no tocar los scores reales:
+// inserción, carga del directorio, lugar de un puntaje y lectura de una página
+void BenchMarcador(void)
+{
+    static Marcador prueba(BENCH_ARCHIVO_MARCADOR);
+    EntradaMarcador pagina[SCORES_FILAS];
+    uint32_t lugar;
+    unsigned long total = 0;
+
+    // Iniciar antes de Eliminar: Eliminar toma el mutex que recibe Iniciar
+    prueba.Iniciar(mutexSD, false);
+    prueba.Eliminar();
+    prueba.Iniciar(mutexSD, false);
+    for (int i = 0; i < BENCH_ENTRADAS_MARCADOR; i++)
+    {
+        unsigned long inicio = micros();
+        prueba.Insertar(Aleatorio(1000), "BEN", &lugar);
+        total += micros() - inicio;
+    }
+    ReportarMetrica("marcador_insercion_us", (float)total / BENCH_ENTRADAS_MARCADOR);
+
+    unsigned long inicio = micros();
+    prueba.Iniciar(mutexSD, false);
+    ReportarMetrica("marcador_carga_us", micros() - inicio);
+
+    total = 0;
+    for (int i = 0; i < BENCH_REPETICIONES_SD; i++)
+    {
+        inicio = micros();
+        prueba.Lugar(Aleatorio(1000));
+        total += micros() - inicio;
+    }
+    ReportarMetrica("marcador_lugar_us", (float)total / BENCH_REPETICIONES_SD);
+
+    total = 0;
+    for (int i = 0; i < BENCH_REPETICIONES_SD; i++)
+    {
+        inicio = micros();
+        prueba.LeerPagina(Aleatorio(BENCH_ENTRADAS_MARCADOR), pagina, SCORES_FILAS);
+        total += micros() - inicio;
+    }
+    ReportarMetrica("marcador_pagina_us", (float)total / BENCH_REPETICIONES_SD);
+
+    prueba.Eliminar();
+}
+
+//-- Un cuadro completo del nivel: los ciclos de la lógica (componer y entregar) y el
+// tráfico I2C que genera la tarea de render al mostrarlo. Cada cuadro es uno típico de
+// una partida: el personaje avanza una celda y cambian el tiempo y el puntaje del HUD.
+// El diamante y el generador aleatorio parten de un estado fijo para que el tráfico sea
+// el mismo en cada corrida.
+void BenchCuadroNivel(void)
+{
+    uint32_t ciclos = 0;
+    uint32_t estadoGuardado = estadoAleatorio;
+    Diamante objetivoGuardado = objetivo;
+
+    personaje.ReiniciarValores();
+    SembrarAleatorio(BENCH_SEMILLA);
+    objetivo.x = DisposicionJuego::maxX / 2;
+    objetivo.y = 0;
+    lcd.ReiniciarTrafico();
+    for (int i = 0; i < BENCH_REPETICIONES_CUADRO; i++)
+    {
+        // Recorrer el campo en zigzag: una celda por cuadro y cambio de fila en cada extremo
+        int vuelta = i / DisposicionJuego::maxX;
+        if (i % DisposicionJuego::maxX == 0)
+        {
+            if (vuelta & 1)
+                personaje.Up();
+            else
+                personaje.Down();
+        }
+        else if (vuelta & 1)
+            personaje.Left();
+        else
+            personaje.Right();
+        personaje.puntaje = i * 7;
+
+        uint32_t inicio = ESP.getCycleCount();
+        ActualizarCuadro(BENCH_REPETICIONES_CUADRO - i, 0);
+        pantalla.Presentar();
+        ciclos += ESP.getCycleCount() - inicio;
+
+        // Esperar a que llegue a la LCD para contar el tráfico de cada cuadro
+        while (pantalla.Pendiente())
+            vTaskDelay(1);
+    }
+    TraficoLCD trafico = lcd.Trafico();
+    personaje.ReiniciarValores();
+    objetivo = objetivoGuardado;
+    estadoAleatorio = estadoGuardado;
+
+    ReportarMetrica("nivel_cuadro_ciclos", (float)ciclos / BENCH_REPETICIONES_CUADRO);
+    ReportarMetrica("lcd_cuadro_comandos", (float)trafico.comandos / BENCH_REPETICIONES_CUADRO);
+    ReportarMetrica("lcd_cuadro_datos", (float)trafico.datos / BENCH_REPETICIONES_CUADRO);
+    ReportarMetrica("lcd_cuadro_transacciones", (float)trafico.Transacciones() / BENCH_REPETICIONES_CUADRO);
+    ReportarMetrica("lcd_cuadro_bytes_i2c", (float)trafico.BytesI2C() / BENCH_REPETICIONES_CUADRO);
+}
+
+//-- Colisión y reubicación del diamante (Objetos.h), en ciclos de CPU
+void BenchObjetos(void)
+{
+    volatile int colisiones = 0;
+    Diamante diamante(0, 0);
+
+    uint32_t inicio = ESP.getCycleCount();
+    for (int i = 0; i < BENCH_REPETICIONES_CPU; i++)
+        colisiones += diamante.Colision(i % 14, i & 1, diamante.GetX(), diamante.GetY());
+    uint32_t ciclosColision = ESP.getCycleCount() - inicio;
+
+    inicio = ESP.getCycleCount();
+    for (int i = 0; i < BENCH_REPETICIONES_CPU; i++)
+        diamante.RehubicarObjeto();
+    uint32_t ciclosReubicar = ESP.getCycleCount() - inicio;
+
+    ReportarMetrica("colision_ciclos", (float)ciclosColision / BENCH_REPETICIONES_CPU);
+    ReportarMetrica("reubicar_ciclos", (float)ciclosReubicar / BENCH_REPETICIONES_CPU);
+}
+
+//-- Un bloque del mezclador de audio con todas las voces ocupadas (el peor caso), en ciclos.
+// Un bloque dura MEZCLADOR_BLOQUE / MEZCLADOR_FRECUENCIA s: ~2.8 M ciclos a 240 MHz
+size_t FuenteBench(void *contexto, int16_t *destino, size_t muestras)
+{
+    uint32_t &fase = *(uint32_t *)contexto;
+    for (size_t i = 0; i < muestras; i++)
+        destino[i] = (int16_t)(fase++ * 97);
+    return muestras;
+}
+
+void BenchMezclador(void)
+{
+    static Mezclador mezclador;
+    static int16_t salida[MEZCLADOR_BLOQUE * 2];
+    static int16_t muestra[MEZCLADOR_BLOQUE];
+    uint32_t fase = 0;
+
+    for (size_t i = 0; i < MEZCLADOR_BLOQUE; i++)
+        muestra[i] = (int16_t)((i * 251) & 0x3FFF) - 0x2000;
+    mezclador.ReproducirFuente(MEZCLADOR_VOZ_MUSICA, FuenteBench, &fase, Q15_UNO, 0);
+    for (int v = 1; v < MEZCLADOR_VOCES; v++)
+    {
+        if (v & 1)
+            mezclador.ReproducirTono(440 * v, 60000, Q15_UNO / 2, (v & 2) ? -16384 : 16384);
+        else
+            mezclador.ReproducirMuestra(muestra, MEZCLADOR_BLOQUE, Q15_UNO / 2, 0, true);
+    }
+
+    const int bloques = 100;
+    uint32_t inicio = ESP.getCycleCount();
+    for (int i = 0; i < bloques; i++)
+        mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    uint32_t ciclos = ESP.getCycleCount() - inicio;
+
+    ReportarMetrica("mezclador_bloque_ciclos", (float)ciclos / bloques);
+}
+
+//-- Decodificación de un bloque IMA-ADPCM de la música (1017 muestras, ~46 ms de audio)
+void BenchADPCM(void)
+{
+    static uint8_t bloque[PISTA_TAM_BLOQUE];
+    static int16_t muestras[PISTA_MAX_MUESTRAS];
+
+    // Nibbles variados para recorrer todos los caminos del decodificador
+    bloque[0] = 0;
+    bloque[1] = 0;
+    bloque[2] = 40;
+    bloque[3] = 0;
+    for (size_t i = 4; i < PISTA_TAM_BLOQUE; i++)
+        bloque[i] = (uint8_t)(i * 37);
+
+    const int bloques = 100;
+    uint32_t inicio = ESP.getCycleCount();
+    for (int i = 0; i < bloques; i++)
+        DecodificarBloqueIMA(bloque, PISTA_TAM_BLOQUE, muestras);
+    uint32_t ciclos = ESP.getCycleCount() - inicio;
+
+    ReportarMetrica("adpcm_bloque_ciclos", (float)ciclos / bloques);
+}
+
+//-- Costo de un BITACORA() para la tarea que llama (el formateo lo hace la tarea de la
+// bitácora). Usa una instancia propia sin tarea y la vacía antes de que se llene.
+void BenchBitacora(void)
+{
+    static Bitacora prueba;
+    const int llamadas = BITACORA_CAPACIDAD / 2;
+    const int rondas = BENCH_REPETICIONES_CPU / llamadas;
+
+    uint32_t ciclos = 0;
+    for (int i = 0; i < rondas; i++)
+    {
+        uint32_t inicio = ESP.getCycleCount();
+        for (int j = 0; j < llamadas; j++)
+            prueba.Escribir<MSG_CUADROS>(i, j, 0);
+        ciclos += ESP.getCycleCount() - inicio;
+        prueba.Descartar();
+    }
+
+    ReportarMetrica("bitacora_llamada_ciclos", (float)ciclos / (rondas * llamadas));
+}
+
+//-- Formateo de campos de ancho fijo (Formato.h) y el HUD completo sobre el cuadro, en ciclos
+void BenchFormato(void)
+{
+    char texto[6];
+    volatile char sumidero = 0;
+
+    uint32_t inicio = ESP.getCycleCount();
+    for (int i = 0; i < BENCH_REPETICIONES_CPU; i++)
+    {
+        FormatearEntero(texto, sizeof(texto), i * 37);
+        sumidero = sumidero + texto[5];
+    }
+    uint32_t ciclosEntero = ESP.getCycleCount() - inicio;
+
+    inicio = ESP.getCycleCount();
+    for (int i = 0; i < BENCH_REPETICIONES_CPU; i++)
+        DibujarHUD<GeometriaJuego>(i % 100, i);
+    uint32_t ciclosHUD = ESP.getCycleCount() - inicio;
+    pantalla.clear();
+
+    ReportarMetrica("formato_entero_ciclos", (float)ciclosEntero / BENCH_REPETICIONES_CPU);
+    ReportarMetrica("hud_ciclos", (float)ciclosHUD / BENCH_REPETICIONES_CPU);
+}
+
+void EjecutarBenchmarks(void)
+{
+    Serial.println("BENCH_INICIO");
+    BenchMarcador();
+    BenchCuadroNivel();
+    BenchObjetos();
+    BenchMezclador();
+    BenchADPCM();
+    BenchBitacora();
+    BenchFormato();
+    Serial.println("BENCH_FIN");
+}
+
+#endif
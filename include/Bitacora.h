@@ -0,0 +1,332 @@
+#ifndef Bitacora_h
+#define Bitacora_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <type_traits>
+
+/*
+ * Bitácora diferida.
+ * BITACORA(MSG_..., args) no formatea ni toca la UART: guarda el identificador del
+ * mensaje, la hora y hasta cuatro argumentos de 32 bits en un anillo sin candados
+ * (varios productores en ambos núcleos, un consumidor). Una tarea de baja prioridad
+ * los saca cada BITACORA_PERIODO_MS, les da formato y los escribe por Serial. Si el
+ * anillo está lleno el registro se pierde y se cuenta por módulo; la tarea avisa de
+ * las pérdidas.
+ *
+ * Los mensajes se declaran una sola vez en MENSAJES_BITACORA con su módulo, su nivel
+ * y su formato. Cada módulo tiene un nivel máximo fijado al compilar (por ejemplo
+ * -DBITACORA_NIVEL_JUEGO=NIVEL_DEPURACION); los mensajes por encima de él no generan
+ * código ni evalúan sus argumentos. El número de argumentos se comprueba contra el
+ * formato con static_assert.
+ *
+ * Los formatos sólo usan conversiones de 32 bits (%d %u %ld %lu %x %c %s) y %s sólo
+ * con cadenas que vivan todo el programa (literales), porque se formatean después.
+ */
+
+#define BITACORA_CAPACIDAD 64 // Registros en el anillo (potencia de dos)
+#define BITACORA_MAX_ARGUMENTOS 4
+#define BITACORA_PERIODO_MS 50
+#define BITACORA_PILA 3072
+
+enum NivelBitacora
+{
+    NIVEL_ERROR,
+    NIVEL_AVISO,
+    NIVEL_INFO,
+    NIVEL_DEPURACION
+};
+
+enum ModuloBitacora
+{
+    MOD_SISTEMA,
+    MOD_JUEGO,
+    MOD_SD,
+    MOD_AUDIO,
+    NUM_MODULOS
+};
+
+// Nivel máximo de cada módulo; se cambian con -D al compilar
+#ifndef BITACORA_NIVEL_SISTEMA
+#define BITACORA_NIVEL_SISTEMA NIVEL_INFO
+#endif
+#ifndef BITACORA_NIVEL_JUEGO
+#define BITACORA_NIVEL_JUEGO NIVEL_INFO
+#endif
+#ifndef BITACORA_NIVEL_SD
+#define BITACORA_NIVEL_SD NIVEL_INFO
+#endif
+#ifndef BITACORA_NIVEL_AUDIO
+#define BITACORA_NIVEL_AUDIO NIVEL_INFO
+#endif
+
+// X(identificador, módulo, nivel, formato)
+#define MENSAJES_BITACORA(X)                                                                                     \
+    X(MSG_ESTADO_JUEGO, MOD_JUEGO, NIVEL_DEPURACION, "Estado %d")                                                \
+    X(MSG_INICIO_PARTIDA, MOD_JUEGO, NIVEL_DEPURACION, "Entro en juego completo")                                \
+    X(MSG_PARTIDA_RESTAURADA, MOD_JUEGO, NIVEL_INFO, "Partida restaurada (nivel %u, %u pts) en %lu us")          \
+    X(MSG_AUTORES_FIN, MOD_JUEGO, NIVEL_DEPURACION, "Finalizó la ronda FOR de autores")                          \
+    X(MSG_AUTORES_ERROR, MOD_JUEGO, NIVEL_ERROR, "Error: el ciclo no finalizó correctamente")                     \
+    X(MSG_JUEGO_COMPLETADO, MOD_JUEGO, NIVEL_INFO, "Juego completado con éxito")                                 \
+    X(MSG_FIN_DEL_JUEGO, MOD_JUEGO, NIVEL_INFO, "Fin del juego")                                                 \
+    X(MSG_NUEVO_SCORE, MOD_JUEGO, NIVEL_INFO, "Nuevo Score")                                                     \
+    X(MSG_CUADROS, MOD_JUEGO, NIVEL_INFO, "Cuadros: %lu producidos, %lu mostrados, %lu descartados")             \
+    X(MSG_INVARIANTE, MOD_JUEGO, NIVEL_ERROR, "Invariante %d violada en la línea %u")                            \
+    X(MSG_SNAPSHOT_ERROR, MOD_SD, NIVEL_ERROR, "Error guardando el snapshot de la partida")                       \
+    X(MSG_PERFIL_ERROR, MOD_SD, NIVEL_ERROR, "Error guardando el perfil")                                        \
+    X(MSG_SCORE_ERROR, MOD_SD, NIVEL_ERROR, "Error guardando el score")                                          \
+    X(MSG_MARCADOR_ERROR, MOD_SD, NIVEL_ERROR, "Error creando el marcador")                                      \
+    X(MSG_MARCADOR_INVALIDO, MOD_SD, NIVEL_ERROR, "Marcador %s inválido; no se modifica")                        \
+    X(MSG_MARCADOR_MIGRADO, MOD_SD, NIVEL_INFO, "Marcador: %d puntajes migrados de %s")                          \
+    X(MSG_PERFILES_ERROR, MOD_SD, NIVEL_ERROR, "Error abriendo o creando los perfiles")                          \
+    X(MSG_TELEMETRIA_ERROR, MOD_SD, NIVEL_ERROR, "Error al abrir telemetria.bin")                                \
+    X(MSG_TELEMETRIA_INCOMPLETA, MOD_SD, NIVEL_ERROR, "Escritura incompleta en telemetria.bin: %lu perdidos")    \
+    X(MSG_I2S_ERROR, MOD_AUDIO, NIVEL_ERROR, "Error configurando el I2S")                                        \
+    X(MSG_PISTA_INVALIDA, MOD_AUDIO, NIVEL_AVISO, "Pista %s no encontrada o inválida")                           \
+    X(MSG_AUDIO, MOD_AUDIO, NIVEL_INFO, "Audio: %lu ciclos/bloque (max %lu), %lu bloques sin música a tiempo")
+
+#define BITACORA_ENUM(id, modulo, nivel, formato) id,
+#define BITACORA_MODULO(id, modulo, nivel, formato) modulo,
+#define BITACORA_NIVEL(id, modulo, nivel, formato) nivel,
+#define BITACORA_FORMATO(id, modulo, nivel, formato) formato,
+
+enum MensajeBitacora
+{
+    MENSAJES_BITACORA(BITACORA_ENUM) NUM_MENSAJES
+};
+
+constexpr uint8_t modulosBitacora[NUM_MENSAJES] = {MENSAJES_BITACORA(BITACORA_MODULO)};
+constexpr uint8_t nivelesBitacora[NUM_MENSAJES] = {MENSAJES_BITACORA(BITACORA_NIVEL)};
+constexpr const char *formatosBitacora[NUM_MENSAJES] = {MENSAJES_BITACORA(BITACORA_FORMATO)};
+constexpr uint8_t nivelesModulo[NUM_MODULOS] = {BITACORA_NIVEL_SISTEMA, BITACORA_NIVEL_JUEGO, BITACORA_NIVEL_SD, BITACORA_NIVEL_AUDIO};
+static const char *nombresModulo[NUM_MODULOS] = {"SISTEMA", "JUEGO", "SD", "AUDIO"};
+static const char letrasNivel[] = {'E', 'W', 'I', 'D'};
+
+constexpr bool BitacoraHabilitado(MensajeBitacora id)
+{
+    return nivelesBitacora[id] <= nivelesModulo[modulosBitacora[id]];
+}
+
+// Conversiones de un formato ("%%" no cuenta)
+constexpr uint8_t ArgumentosFormato(const char *formato)
+{
+    uint8_t n = 0;
+    for (; *formato; formato++)
+    {
+        if (*formato != '%')
+            continue;
+        if (formato[1] == '%')
+            formato++;
+        else
+            n++;
+    }
+    return n;
+}
+
+template <typename T>
+constexpr bool ArgumentoValido(void)
+{
+    return ((std::is_integral<T>::value || std::is_enum<T>::value) && sizeof(T) <= sizeof(uint32_t)) ||
+           std::is_same<T, const char *>::value || std::is_same<T, char *>::value;
+}
+
+struct RegistroBitacora
+{
+    uint16_t mensaje; // MensajeBitacora
+    uint32_t tiempo;  // micros()
+    uintptr_t argumentos[BITACORA_MAX_ARGUMENTOS];
+};
+
+class Bitacora
+{
+public:
+    Bitacora();
+
+    void Iniciar(UBaseType_t prioridad, BaseType_t nucleo);
+
+    // Usar con la macro BITACORA, que descarta los mensajes deshabilitados al compilar
+    template <MensajeBitacora ID, typename... A>
+    void Escribir(A... argumentos);
+
+    uint32_t Descartados(ModuloBitacora modulo);
+    uint32_t Escritos(void);
+
+    // Saca, formatea e imprime lo que haya en el anillo (lo hace la tarea)
+    void Vaciar(void);
+    // Saca lo que haya sin imprimirlo; sólo para instancias sin tarea (benchmark)
+    void Descartar(void);
+
+private:
+    // Anillo acotado con número de secuencia por celda: cada productor reserva una
+    // posición con compare-exchange y la publica al escribir la secuencia
+    struct Celda
+    {
+        std::atomic<uint32_t> secuencia;
+        RegistroBitacora registro;
+    };
+
+    Celda celdas[BITACORA_CAPACIDAD];
+    std::atomic<uint32_t> escritura;
+    uint32_t lectura; // Sólo la usa el consumidor
+    std::atomic<uint32_t> descartados[NUM_MODULOS];
+    std::atomic<uint32_t> escritos;
+    uint32_t descartadosReportados[NUM_MODULOS];
+
+    bool Encolar(const RegistroBitacora &registro);
+    bool Desencolar(RegistroBitacora &registro);
+    static void TareaBitacora(void *pvParameters);
+};
+
+Bitacora bitacora;
+
+#define BITACORA(id, ...)                                  \
+    do                                                     \
+    {                                                      \
+        if constexpr (BitacoraHabilitado(id))              \
+            bitacora.Escribir<id>(__VA_ARGS__);            \
+    } while (0)
+
+// Desarrollo de métodos
+
+Bitacora::Bitacora()
+{
+    for (uint32_t i = 0; i < BITACORA_CAPACIDAD; i++)
+        celdas[i].secuencia.store(i, std::memory_order_relaxed);
+    escritura.store(0, std::memory_order_relaxed);
+    lectura = 0;
+    for (uint8_t m = 0; m < NUM_MODULOS; m++)
+    {
+        descartados[m].store(0, std::memory_order_relaxed);
+        descartadosReportados[m] = 0;
+    }
+    escritos.store(0, std::memory_order_relaxed);
+}
+
+void Bitacora::Iniciar(UBaseType_t prioridad, BaseType_t nucleo)
+{
+    xTaskCreatePinnedToCore(
+        TareaBitacora,
+        "Bitacora",
+        BITACORA_PILA,
+        this,
+        prioridad,
+        NULL,
+        nucleo);
+}
+
+template <MensajeBitacora ID, typename... A>
+void Bitacora::Escribir(A... argumentos)
+{
+    static_assert(sizeof...(A) <= BITACORA_MAX_ARGUMENTOS, "Demasiados argumentos para la bitácora");
+    static_assert(sizeof...(A) == ArgumentosFormato(formatosBitacora[ID]), "Los argumentos no coinciden con el formato del mensaje");
+    static_assert((ArgumentoValido<A>() && ...), "La bitácora sólo guarda enteros de 32 bits y cadenas literales");
+
+    RegistroBitacora registro;
+    registro.mensaje = ID;
+    registro.tiempo = micros();
+    uint8_t i = 0;
+    ((registro.argumentos[i++] = (uintptr_t)argumentos), ...);
+    (void)i;
+
+    if (Encolar(registro))
+        escritos.fetch_add(1, std::memory_order_relaxed);
+    else
+        descartados[modulosBitacora[ID]].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t Bitacora::Descartados(ModuloBitacora modulo)
+{
+    return descartados[modulo].load(std::memory_order_relaxed);
+}
+
+uint32_t Bitacora::Escritos(void)
+{
+    return escritos.load(std::memory_order_relaxed);
+}
+
+bool Bitacora::Encolar(const RegistroBitacora &registro)
+{
+    uint32_t posicion = escritura.load(std::memory_order_relaxed);
+    Celda *celda;
+    while (true)
+    {
+        celda = &celdas[posicion & (BITACORA_CAPACIDAD - 1)];
+        int32_t diferencia = (int32_t)(celda->secuencia.load(std::memory_order_acquire) - posicion);
+        if (diferencia == 0)
+        {
+            // Celda libre en esta vuelta: reservarla
+            if (escritura.compare_exchange_weak(posicion, posicion + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diferencia < 0)
+        {
+            return false; // El consumidor no ha liberado la celda: anillo lleno
+        }
+        else
+        {
+            posicion = escritura.load(std::memory_order_relaxed); // Otro productor la tomó
+        }
+    }
+
+    celda->registro = registro;
+    celda->secuencia.store(posicion + 1, std::memory_order_release);
+    return true;
+}
+
+bool Bitacora::Desencolar(RegistroBitacora &registro)
+{
+    Celda &celda = celdas[lectura & (BITACORA_CAPACIDAD - 1)];
+    if ((int32_t)(celda.secuencia.load(std::memory_order_acquire) - (lectura + 1)) < 0)
+        return false; // Vacía, o el productor aún no termina de escribirla
+
+    registro = celda.registro;
+    celda.secuencia.store(lectura + BITACORA_CAPACIDAD, std::memory_order_release);
+    lectura++;
+    return true;
+}
+
+void Bitacora::Vaciar(void)
+{
+    RegistroBitacora r;
+    while (Desencolar(r))
+    {
+        uint8_t modulo = modulosBitacora[r.mensaje];
+        Serial.printf("%lu %c %s: ", (unsigned long)(r.tiempo / 1000), letrasNivel[nivelesBitacora[r.mensaje]], nombresModulo[modulo]);
+        Serial.printf(formatosBitacora[r.mensaje], r.argumentos[0], r.argumentos[1], r.argumentos[2], r.argumentos[3]);
+        Serial.println();
+    }
+
+    for (uint8_t m = 0; m < NUM_MODULOS; m++)
+    {
+        uint32_t total = descartados[m].load(std::memory_order_relaxed);
+        if (total != descartadosReportados[m])
+        {
+            Serial.printf("Bitacora: %lu mensajes de %s descartados (anillo lleno)\n",
+                          (unsigned long)(total - descartadosReportados[m]), nombresModulo[m]);
+            descartadosReportados[m] = total;
+        }
+    }
+}
+
+void Bitacora::Descartar(void)
+{
+    RegistroBitacora r;
+    while (Desencolar(r))
+        ;
+}
+
+void Bitacora::TareaBitacora(void *pvParameters)
+{
+    Bitacora *b = (Bitacora *)pvParameters;
+    TickType_t ultimoDespertar = xTaskGetTickCount();
+
+    while (true)
+    {
+        b->Vaciar();
+        vTaskDelayUntil(&ultimoDespertar, BITACORA_PERIODO_MS / portTICK_PERIOD_MS);
+    }
+}
+
+#endif
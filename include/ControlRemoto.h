@@ -0,0 +1,386 @@
+#ifndef ControlRemoto_h
+#define ControlRemoto_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Entrada.h"
+#include "Renderizador.h"
+#include "Invariantes.h"
+#include "Reloj.h"
+
+/*
+ * Protocolo binario de control remoto por UART.
+ * Trama: 0xA5 0x5A | tipo | longitud | datos[longitud] | CRC16 (little-endian)
+ * El CRC es CRC-16/CCITT-FALSE sobre tipo, longitud y datos. Las tramas conviven
+ * con el texto de depuración de Serial: el receptor se resincroniza con los bytes
+ * de sincronía y descarta lo que no pase el CRC. El cliente de la PC está en
+ * tools/control_remoto.py.
+ */
+
+#define REMOTO_SINC0 0xA5
+#define REMOTO_SINC1 0x5A
+#define REMOTO_MAX_DATOS 200
+
+// Comandos (PC -> tablero)
+#define REMOTO_PING 0x01      // datos: cualquiera, se devuelven en PONG
+#define REMOTO_INYECTAR 0x02  // datos: u16 x, u16 y, u8 botones (bit0 ENTER, bit1 EXIT)
+#define REMOTO_LIBERAR 0x03   // vuelve a leer los pines reales
+#define REMOTO_ESTADO 0x04    // pide un EstadoRemoto
+#define REMOTO_PANTALLA 0x05  // pide el último cuadro entregado a la LCD
+#define REMOTO_STREAM 0x06    // datos: u8 modo, u16 periodo (ms)
+#define REMOTO_INVARIANTES 0x07 // pide el registro de invariantes violadas
+#define REMOTO_ESCALA 0x08      // datos: u32 escala del reloj del juego en milésimas (1000 = tiempo real)
+
+// Respuestas (tablero -> PC)
+#define REMOTO_ACK 0x80
+#define REMOTO_PONG 0x81
+#define REMOTO_R_ESTADO 0x84
+#define REMOTO_R_PANTALLA 0x85
+#define REMOTO_R_INVARIANTES 0x87 // u16 violaciones, u8 última, u16 línea, u32 tiempo
+#define REMOTO_NACK 0xFF
+
+// Códigos de error del NACK
+#define REMOTO_ERROR_CRC 1
+#define REMOTO_ERROR_TIPO 2
+#define REMOTO_ERROR_LONGITUD 3
+
+// Modos de envío continuo de estado
+enum ModoStream
+{
+    STREAM_APAGADO,
+    STREAM_POR_TICK,  // Un estado por cada actualización de la lógica
+    STREAM_PERIODICO  // Un estado cada 'periodo' ms
+};
+
+// Estado que se reporta a la PC (little-endian)
+struct __attribute__((packed)) EstadoRemoto
+{
+    uint8_t estado;         // GameState
+    uint8_t nivel;          // Nivel actual (1..n)
+    uint16_t puntaje;
+    int16_t tiempoRestante; // Segundos
+    uint8_t personajeX, personajeY;
+    uint8_t diamanteX, diamanteY;
+    uint8_t banderas;       // bit0 juego en progreso, bit1 pausa, bit2 entrada inyectada
+    uint32_t tick;          // Actualizaciones de la lógica desde el arranque
+    uint32_t tiempo;        // millis()
+};
+
+#define ESTADO_BANDERA_JUEGO 0x01
+#define ESTADO_BANDERA_PAUSA 0x02
+#define ESTADO_BANDERA_INYECCION 0x04
+
+class ControlRemoto
+{
+public:
+    typedef void (*LlenarEstado)(EstadoRemoto *estado);
+
+    ControlRemoto(Entrada *entrada, Renderizador *pantalla, RelojJuego *reloj, LlenarEstado llenarEstado);
+
+    void Iniciar(UBaseType_t prioridad, BaseType_t nucleo);
+    // Lo llama la lógica del juego en cada actualización
+    void NotificarTick(void);
+    bool EntradaInyectada(void);
+
+    static uint16_t CRC16(const uint8_t *datos, size_t n, uint16_t crc = 0xFFFF);
+
+private:
+    enum FaseTrama
+    {
+        FASE_SINC0,
+        FASE_SINC1,
+        FASE_TIPO,
+        FASE_LONGITUD,
+        FASE_DATOS,
+        FASE_CRC0,
+        FASE_CRC1
+    };
+
+    Entrada *entrada;
+    Renderizador *pantalla;
+    RelojJuego *reloj;
+    LlenarEstado llenarEstado;
+    TaskHandle_t tarea;
+
+    // Receptor
+    FaseTrama fase;
+    uint8_t tipo;
+    uint8_t longitud;
+    uint8_t recibidos;
+    uint8_t datos[REMOTO_MAX_DATOS];
+    uint16_t crcRecibido;
+
+    // Envío continuo
+    volatile uint8_t modoStream;
+    uint16_t periodoStream;
+    unsigned long ultimoStream;
+    volatile bool tickPendiente;
+
+    void ProcesarByte(uint8_t b);
+    void EjecutarComando(void);
+    void Enviar(uint8_t tipo, const uint8_t *datos, uint8_t longitud);
+    void EnviarEstado(void);
+    void EnviarAck(uint8_t comando);
+    void EnviarNack(uint8_t comando, uint8_t codigo);
+    static void TareaRemota(void *pvParameters);
+};
+
+// Desarrollo de métodos
+
+ControlRemoto::ControlRemoto(Entrada *entrada, Renderizador *pantalla, RelojJuego *reloj, LlenarEstado llenarEstado)
+{
+    this->entrada = entrada;
+    this->pantalla = pantalla;
+    this->reloj = reloj;
+    this->llenarEstado = llenarEstado;
+    tarea = NULL;
+    fase = FASE_SINC0;
+    modoStream = STREAM_APAGADO;
+    periodoStream = 0;
+    ultimoStream = 0;
+    tickPendiente = false;
+}
+
+void ControlRemoto::Iniciar(UBaseType_t prioridad, BaseType_t nucleo)
+{
+    xTaskCreatePinnedToCore(
+        TareaRemota,
+        "ControlRemoto",
+        4096,
+        this,
+        prioridad,
+        &tarea,
+        nucleo);
+
+    // Despertar a la tarea cuando llegan bytes en lugar de sondear la UART
+    Serial.onReceive([this]()
+                     { if (tarea != NULL) xTaskNotifyGive(tarea); });
+}
+
+void ControlRemoto::NotificarTick(void)
+{
+    if (modoStream == STREAM_POR_TICK && tarea != NULL)
+    {
+        tickPendiente = true;
+        xTaskNotifyGive(tarea);
+    }
+}
+
+bool ControlRemoto::EntradaInyectada(void)
+{
+    return entrada->InyeccionActiva();
+}
+
+uint16_t ControlRemoto::CRC16(const uint8_t *datos, size_t n, uint16_t crc)
+{
+    while (n--)
+    {
+        crc ^= (uint16_t)(*datos++) << 8;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+// Máquina de estados del receptor de tramas
+void ControlRemoto::ProcesarByte(uint8_t b)
+{
+    switch (fase)
+    {
+    case FASE_SINC0:
+        if (b == REMOTO_SINC0)
+            fase = FASE_SINC1;
+        break;
+    case FASE_SINC1:
+        fase = (b == REMOTO_SINC1) ? FASE_TIPO : (b == REMOTO_SINC0 ? FASE_SINC1 : FASE_SINC0);
+        break;
+    case FASE_TIPO:
+        tipo = b;
+        fase = FASE_LONGITUD;
+        break;
+    case FASE_LONGITUD:
+        longitud = b;
+        recibidos = 0;
+        if (longitud > REMOTO_MAX_DATOS)
+        {
+            EnviarNack(tipo, REMOTO_ERROR_LONGITUD);
+            fase = FASE_SINC0;
+        }
+        else
+        {
+            fase = (longitud == 0) ? FASE_CRC0 : FASE_DATOS;
+        }
+        break;
+    case FASE_DATOS:
+        datos[recibidos++] = b;
+        if (recibidos == longitud)
+            fase = FASE_CRC0;
+        break;
+    case FASE_CRC0:
+        crcRecibido = b;
+        fase = FASE_CRC1;
+        break;
+    case FASE_CRC1:
+    {
+        crcRecibido |= (uint16_t)b << 8;
+        uint8_t cabecera[2] = {tipo, longitud};
+        uint16_t crc = CRC16(datos, longitud, CRC16(cabecera, 2));
+        if (crc == crcRecibido)
+            EjecutarComando();
+        else
+            EnviarNack(tipo, REMOTO_ERROR_CRC);
+        fase = FASE_SINC0;
+        break;
+    }
+    }
+}
+
+void ControlRemoto::EjecutarComando(void)
+{
+    switch (tipo)
+    {
+    case REMOTO_PING:
+        Enviar(REMOTO_PONG, datos, longitud);
+        break;
+    case REMOTO_INYECTAR:
+        if (longitud != 5)
+        {
+            EnviarNack(tipo, REMOTO_ERROR_LONGITUD);
+            break;
+        }
+        entrada->Inyectar(datos[0] | (datos[1] << 8), datos[2] | (datos[3] << 8), datos[4] & 0x01, datos[4] & 0x02);
+        EnviarAck(tipo);
+        break;
+    case REMOTO_LIBERAR:
+        entrada->LiberarInyeccion();
+        EnviarAck(tipo);
+        break;
+    case REMOTO_ESTADO:
+        EnviarEstado();
+        break;
+    case REMOTO_PANTALLA:
+    {
+        uint8_t respuesta[2 + PANTALLA_MAX_FILAS * PANTALLA_MAX_COLUMNAS];
+        respuesta[0] = pantalla->Columnas();
+        respuesta[1] = pantalla->Filas();
+        size_t n = pantalla->Volcar(respuesta + 2, sizeof(respuesta) - 2);
+        Enviar(REMOTO_R_PANTALLA, respuesta, 2 + n);
+        break;
+    }
+    case REMOTO_STREAM:
+        if (longitud != 3 || datos[0] > STREAM_PERIODICO)
+        {
+            EnviarNack(tipo, REMOTO_ERROR_LONGITUD);
+            break;
+        }
+        periodoStream = datos[1] | (datos[2] << 8);
+        if (periodoStream == 0)
+            periodoStream = 1;
+        modoStream = datos[0];
+        ultimoStream = millis();
+        EnviarAck(tipo);
+        break;
+    case REMOTO_INVARIANTES:
+    {
+        uint8_t respuesta[9];
+        uint16_t violaciones = invariantes.violaciones;
+        uint16_t linea = invariantes.linea;
+        uint32_t tiempo = invariantes.tiempo;
+        memcpy(respuesta, &violaciones, 2);
+        respuesta[2] = invariantes.ultima;
+        memcpy(respuesta + 3, &linea, 2);
+        memcpy(respuesta + 5, &tiempo, 4);
+        Enviar(REMOTO_R_INVARIANTES, respuesta, sizeof(respuesta));
+        break;
+    }
+    case REMOTO_ESCALA:
+    {
+        uint32_t escala;
+        if (longitud != 4)
+        {
+            EnviarNack(tipo, REMOTO_ERROR_LONGITUD);
+            break;
+        }
+        memcpy(&escala, datos, 4);
+        reloj->ConfigurarEscala(escala);
+        EnviarAck(tipo);
+        break;
+    }
+    default:
+        EnviarNack(tipo, REMOTO_ERROR_TIPO);
+        break;
+    }
+}
+
+// Arma la trama completa y la escribe de una sola vez para no mezclarse con otros prints
+void ControlRemoto::Enviar(uint8_t tipo, const uint8_t *datos, uint8_t longitud)
+{
+    uint8_t trama[4 + 255 + 2];
+    trama[0] = REMOTO_SINC0;
+    trama[1] = REMOTO_SINC1;
+    trama[2] = tipo;
+    trama[3] = longitud;
+    memcpy(trama + 4, datos, longitud);
+    uint16_t crc = CRC16(trama + 2, 2 + longitud);
+    trama[4 + longitud] = crc & 0xFF;
+    trama[5 + longitud] = crc >> 8;
+    Serial.write(trama, 6 + longitud);
+}
+
+void ControlRemoto::EnviarEstado(void)
+{
+    EstadoRemoto estado;
+    llenarEstado(&estado);
+    if (entrada->InyeccionActiva())
+        estado.banderas |= ESTADO_BANDERA_INYECCION;
+    estado.tiempo = millis();
+    Enviar(REMOTO_R_ESTADO, (const uint8_t *)&estado, sizeof(estado));
+}
+
+void ControlRemoto::EnviarAck(uint8_t comando)
+{
+    Enviar(REMOTO_ACK, &comando, 1);
+}
+
+void ControlRemoto::EnviarNack(uint8_t comando, uint8_t codigo)
+{
+    uint8_t respuesta[2] = {comando, codigo};
+    Enviar(REMOTO_NACK, respuesta, 2);
+}
+
+// Tarea que atiende la UART; duerme hasta que llegan bytes o toca enviar estado
+void ControlRemoto::TareaRemota(void *pvParameters)
+{
+    ControlRemoto *remoto = (ControlRemoto *)pvParameters;
+
+    while (true)
+    {
+        TickType_t espera = portMAX_DELAY;
+        if (remoto->modoStream == STREAM_PERIODICO)
+        {
+            unsigned long transcurrido = millis() - remoto->ultimoStream;
+            espera = (transcurrido >= remoto->periodoStream) ? 0 : (remoto->periodoStream - transcurrido) / portTICK_PERIOD_MS;
+        }
+        ulTaskNotifyTake(pdTRUE, espera);
+
+        while (Serial.available() > 0)
+            remoto->ProcesarByte(Serial.read());
+
+        if (remoto->modoStream == STREAM_PERIODICO && millis() - remoto->ultimoStream >= remoto->periodoStream)
+        {
+            remoto->ultimoStream += remoto->periodoStream;
+            // Si la tarea se atrasó más de un periodo no se acumulan envíos
+            if (millis() - remoto->ultimoStream >= remoto->periodoStream)
+                remoto->ultimoStream = millis();
+            remoto->EnviarEstado();
+        }
+        else if (remoto->modoStream == STREAM_POR_TICK && remoto->tickPendiente)
+        {
+            remoto->tickPendiente = false;
+            remoto->EnviarEstado();
+        }
+    }
+}
+
+#endif
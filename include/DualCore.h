@@ -6,7 +6,30 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include "Objetos.h"
+#include "Entrada.h"
+#include "Telemetria.h"
+#include "Pantalla.h"
+#include "Renderizador.h"
+#include "Geometria.h"
+#include "Reloj.h"
+#include "Snapshot.h"
+#include "Marcador.h"
+#include "Perfiles.h"
+#include "Seqlock.h"
+#include "ControlRemoto.h"
+#include "Energia.h"
+#include "Invariantes.h"
+#include "Bitacora.h"
+#include "Formato.h"
+#ifdef AUDIO_I2S
+#include "SalidaAudio.h"
+#include "PistaAudio.h"
+#endif
+#ifdef TRAZAR_LATENCIA
+#include "Latencia.h"
+#endif
 #include "DualCore.h"
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
@@ -37,6 +60,15 @@
 #define I2S_BCLK 26
 #define I2S_LRC 25
 
+#ifdef AUDIO_I2S
+// Mezclador de música y efectos hacia el amplificador I2S (en lugar del buzzer)
+SalidaAudio salidaAudio(I2S_BCLK, I2S_LRC, I2S_DOUT);
+
+// Pista de música en curso (.adp): la MusicTask la lee de la SD y el mezclador la decodifica
+ReproductorPista musica;
+#define MUSICA_RELLENO_MS 20 // Periodo de relleno del anillo mientras suena una pista
+#endif
+
 File root; // Instancia de la clase para SD
 
 // Audio audio; // Instancia de la clase para Audio
@@ -44,40 +76,107 @@ File root; // Instancia de la clase para SD
 // Pin del buzzer
 #define BUZZER_PIN 4
 
-// Valores maximos del joystick
-#define MAX_VERT 4095
-#define MAX_HORI 4095
-
-// Variables para leer los valores del Joystick
-int valueX = 0; // to store the X-axis value
-int valueY = 0; // to store the Y-axis value
-
 // Variables globales para almacenar el puntaje y nivel del juego actual (Funciona para almacenar valores cuando se pausa el juego).
 int checkPointPuntaje = 0;
 int checkPointNivel = 0;
 
 /* --- CARACTERES PERSONALIZADOS --- */
+// Posiciones en la CGRAM
+#define GLIFO_PERSONAJE 0
+#define GLIFO_DIAMANTE 1
+#define GLIFO_DIAMANTE_GRANDE 2 // Primer mosaico del diamante del intro
+
 // Personaje
-byte characterPersonaje[] = {B01110, B01010, B01110, B11111, B00100, B00100, B01010, B10001};
+constexpr Glifo characterPersonaje = CompilarGlifo(
+    ".###."
+    ".#.#."
+    ".###."
+    "#####"
+    "..#.."
+    "..#.."
+    ".#.#."
+    "#...#");
 
 // Diamante
-byte characterDiamante[] = {B00000, B00000, B01110, B11111, B11111, B01110, B00100, B00000};
+constexpr Glifo characterDiamante = CompilarGlifo(
+    "....."
+    "....."
+    ".###."
+    "#####"
+    "#####"
+    ".###."
+    "..#.."
+    ".....");
+
+// Diamante grande del intro (3x2 celdas)
+constexpr auto spriteDiamante = CompilarSprite<3, 2>(
+    "..............."
+    "..............."
+    "..###########.."
+    ".#...#...#...#."
+    "#.#...#.#...#.#"
+    "#..#...#...#..#"
+    "#...#.#.#.#...#"
+    ".#...#...#...#."
+    "..#.##...##.#.."
+    "...#..#.#..#..."
+    "....#..#..#...."
+    ".....#...#....."
+    "......###......"
+    "..............."
+    "..............."
+    "...............");
+
+static_assert(GLIFO_DIAMANTE_GRANDE + spriteDiamante.celdas <= GLIFOS_CGRAM, "Los glifos no caben en la CGRAM");
 
 /*~ Instancia de la clase para el manejo de la pantalla ( Dirección I2C, cantidad de columnas, cantidad de filas ) ~*/
-LiquidCrystal_I2C lcd(0x27, 16, 2);
+PantallaLCD lcd(0x27, GeometriaJuego::columnas, GeometriaJuego::filas);
+static_assert(GeometriaJuego::columnas <= PANTALLA_MAX_COLUMNAS && GeometriaJuego::filas <= PANTALLA_MAX_FILAS,
+              "La geometría elegida excede el espejo de la pantalla");
+
+// La lógica dibuja cuadros en RAM; la tarea de render es la única que habla con la LCD
+Renderizador pantalla(&lcd);
+
+#ifdef TRAZAR_LATENCIA
+// Latencia del joystick a la LCD por etapas; se vuelca por Serial al terminar cada partida
+TrazadorLatencia latencia;
+#endif
+
+// Capa de entrada (joystick y botones convertidos en eventos)
+Entrada entrada(VRX_PIN, VRY_PIN, BTN_ENTER, BTN_EXIT);
+
+// Suscripciones de cada consumidor de eventos
+SuscripcionEntrada subMenu;   // Menús: arriba/abajo y ENTER
+SuscripcionEntrada subNombre; // Selector de nombre: direcciones con repetición y ENTER
+SuscripcionEntrada subJuego;  // Movimiento del personaje
+SuscripcionEntrada subPausa;  // Botón EXIT durante el juego
+SuscripcionEntrada subScores; // Pantalla de scores: desplazamiento y EXIT
+SuscripcionEntrada subEnergia; // Cualquier control: despierta al gobernador de energía
 
 // Creación de objetos del Personaje y Diamante
 Personaje personaje(0, 0);
-Diamante objetivo(random(13), random(2));
+Diamante objetivo(random(GeometriaJuego::campoAncho), random(GeometriaJuego::campoAlto));
 
-// Banderas globales (No usadas aún)
+// Banderas globales. Sólo las escribe la tarea de lógica; las tareas del otro núcleo
+// leen estadoPublicado
 bool isPauseActivated = false;
 bool isGameInProgress = false;
 bool isTheLevelFinishedWithSuccess = false;
 bool isAudioStopped = false;
 
-// Variable para registrar el contador de tiempo
-unsigned long inicioMilis = 0;
+// Reloj del juego (pausable y escalable) y sus temporizadores
+RelojJuego reloj;
+TemporizadorJuego temporizadorNivel;  // Duración del nivel en curso
+TemporizadorJuego temporizadorCuadro; // Siguiente actualización de la lógica
+TemporizadorJuego temporizadorSnapshot; // Siguiente snapshot periódico de la partida
+
+// Snapshot de la partida en la NVS; partidaGuardada es la copia que usa la reanudación
+AlmacenSnapshot almacenSnapshot;
+SnapshotJuego partidaGuardada;
+
+// Valores del cuadro actual que se reportan por el control remoto
+int tiempoRestanteActual = 0;
+uint32_t ticksLogica = 0;
 
 /* -- INSTANCIAS FREE-RTOS para TASKs -- */
 TaskHandle_t MusicTask_t;
@@ -88,6 +187,17 @@ TaskHandle_t GamePauseTask_t;
 QueueHandle_t musicQueue;
 QueueHandle_t gameQueue;
 
+// Mutex para el acceso a la SD (la usan el juego y la telemetría desde núcleos distintos)
+SemaphoreHandle_t mutexSD;
+
+// Registro binario de sesiones en la SD
+Telemetria telemetria;
+
+// Todos los puntajes, ordenados, en la SD
+Marcador marcador;
+#define SCORES_FILAS GeometriaJuego::filas // Entradas por página en la pantalla de scores
+AlmacenPerfiles perfiles;
+
 // Enumeración para los estados de la música
 enum MusicState
 {
@@ -112,6 +222,25 @@ enum GameState
 volatile MusicState currentMusicState = MUSIC_INTRO;
 volatile GameState currentGameState = STATE_INTRO;
 
+// Vista inmutable del juego que la tarea de lógica publica en cada tick y en cada
+// cambio de estado; los lectores de otros núcleos la copian sin candados
+struct GameSnapshot
+{
+    uint32_t tick;
+    GameState estado;
+    bool enJuego;
+    bool pausa;
+    uint8_t nivel; // 1..n
+    int16_t puntaje;
+    int16_t tiempoRestante;
+    int8_t personajeX, personajeY;
+    int8_t diamanteX, diamanteY;
+};
+Seqlock<GameSnapshot> estadoPublicado;
+
+// PauseTask sólo solicita la pausa; la tarea de lógica la atiende entre cuadros
+volatile bool pausaSolicitada = false;
+
 // Variables globales para elegir nombre
 int posChar = 0;                     // posicion del caracter
 int posLetra = 0;                    // posicion de la letra
@@ -125,13 +254,32 @@ void ReadMaxScores(void);                                         // Leer scores
 void IntroGame(void);                                             // Ejecutar el intro
 void PrintDirectory(File dir, int numTabs);                       // Imprimir directorio
 void ActivarBuzzer(unsigned int frecuency, unsigned long millis); // Activar PinBuzzer
+void ReproducirPista(const char *ruta);                           // Música precodificada de la SD
+void DetenerPista(void);                                          // Silenciar la música
 void MostrarMenuPausa(void);                                      // Menú de pausa
 void MostrarMenuPrincipal(void);                                  // Menú principal
+int SeleccionarOpcion(void);                                      // Flecha de selección en menús
 bool nivel(int contador, int puntosRequeridos, int puntajeEntrante);
+void ActualizarCuadro(int tiempoRestante, int puntajeEntrante); // Un cuadro del nivel
+template <typename G>
+void DibujarHUD(int tiempoRestante, int puntaje); // HUD según la geometría de la pantalla
 void JuegoCompleto(void); // Lógica completa del juego
 void EvaluarNivelFinal(void);
 char *ElegirNombre(void);
-void GuardarScore(int Puntaje, char *Nombre);
+uint32_t GuardarScore(int Puntaje, char *Nombre); // Devuelve el lugar obtenido
+void LlenarEstadoRemoto(EstadoRemoto *estado); // Estado para el protocolo UART
+bool JuegoInteractivo(void);                   // Consulta del gobernador de energía
+void CapturarPartida(SnapshotJuego *snapshot, uint8_t banderas);
+void AplicarPartida(const SnapshotJuego *snapshot);
+void GuardarPartida(uint8_t banderas); // Captura y escribe en la NVS
+bool RestaurarPartida(void);           // Al arrancar: carga la última partida sin terminar
+void PublicarEstado(void);             // Publica el GameSnapshot del tick actual
+
+// Protocolo binario por UART para pruebas automatizadas
+ControlRemoto controlRemoto(&entrada, &pantalla, &reloj, LlenarEstadoRemoto);
+
+// Frecuencia del CPU y sueño ligero según el estado del juego
+GobernadorEnergia energia(&entrada, &telemetria, JuegoInteractivo);
 
 /*--- CLASE MAESTRA --- */
 
@@ -154,6 +302,7 @@ DualCoreESP32::DualCoreESP32()
 {
     musicQueue = xQueueCreate(1, sizeof(MusicState));
     gameQueue = xQueueCreate(1, sizeof(GameState));
+    mutexSD = xSemaphoreCreateMutex();
 }
 
 // Creación de Tareas(3) Para el DualCore
@@ -200,16 +349,68 @@ void DualCoreESP32 ::ConfigCores(void)
     PrintDirectory(root, 0);
     Serial.println("");
 
+    // Tarea que imprime la bitácora; antes de los módulos que escriben en ella
+    bitacora.Iniciar(1, NUCLEO_SECUNDARIO);
+
+    // Marcador ordenado (la primera vez importa GameData.json)
+    marcador.Iniciar(mutexSD);
+    perfiles.Iniciar(mutexSD);
+#ifdef AUDIO_I2S
+    musica.Iniciar(mutexSD);
+#endif
+
     /*~ Inicializar la pantalla LCD ~*/
     lcd.init();
     lcd.backlight();
 
-    // Creación de caracteres principales
-    lcd.createChar(0, characterPersonaje);
-    lcd.createChar(1, characterDiamante);
-
-    // Registrar tiempo
-    inicioMilis = millis();
+    // Los 8 caracteres personalizados se cargan aquí, antes de que exista la tarea de render
+    lcd.createChar(GLIFO_PERSONAJE, characterPersonaje);
+    lcd.createChar(GLIFO_DIAMANTE, characterDiamante);
+    for (uint8_t i = 0; i < spriteDiamante.celdas; i++)
+        lcd.createChar(GLIFO_DIAMANTE_GRANDE + i, spriteDiamante.mosaicos[i]);
+
+    // Temporizadores del juego
+    temporizadorNivel = reloj.Temporizador("nivel");
+    temporizadorCuadro = reloj.Temporizador("cuadro");
+    temporizadorSnapshot = reloj.Temporizador("snapshot");
+
+    // Generador aleatorio del juego y snapshots de la partida
+    SembrarAleatorio(esp_random());
+    if (!almacenSnapshot.Iniciar())
+        Serial.println(F("No se pudo abrir la NVS de la partida"));
+
+    // Suscripciones a la capa de entrada (antes de crear las tareas que las usan)
+    subMenu = entrada.Suscribir(MASCARA_CONTROL(CONTROL_ARRIBA) | MASCARA_CONTROL(CONTROL_ABAJO) | MASCARA_CONTROL(CONTROL_ENTER),
+                                MASCARA_TIPO(EVENTO_PRESIONAR));
+    subNombre = entrada.Suscribir(MASCARA_DIRECCIONES | MASCARA_CONTROL(CONTROL_ENTER), MASCARA_PULSACIONES);
+    subJuego = entrada.Suscribir(MASCARA_DIRECCIONES, MASCARA_PULSACIONES);
+    subPausa = entrada.Suscribir(MASCARA_CONTROL(CONTROL_EXIT), MASCARA_TIPO(EVENTO_PRESIONAR));
+    subScores = entrada.Suscribir(MASCARA_CONTROL(CONTROL_ARRIBA) | MASCARA_CONTROL(CONTROL_ABAJO) | MASCARA_CONTROL(CONTROL_EXIT),
+                                  MASCARA_PULSACIONES);
+    subEnergia = entrada.Suscribir(MASCARA_TODOS_CONTROLES, MASCARA_TIPO(EVENTO_PRESIONAR));
+
+    // Tarea de muestreo de la entrada
+    entrada.Iniciar(2, NUCLEO_SECUNDARIO);
+
+    // Tarea de baja prioridad que vacía la telemetría en la SD
+    telemetria.Iniciar(mutexSD, 1, NUCLEO_SECUNDARIO);
+
+    // Tarea que envía los cuadros a la LCD
+#ifdef TRAZAR_LATENCIA
+    pantalla.AlMostrar(TrazadorLatencia::CuadroMostrado, &latencia);
+#endif
+    pantalla.Iniciar(2, NUCLEO_SECUNDARIO);
+
+    // Tarea que atiende el protocolo de control remoto
+    controlRemoto.Iniciar(1, NUCLEO_SECUNDARIO);
+
+    // Tarea que ajusta la energía en los estados sin interacción
+    energia.Iniciar(subEnergia, 1, NUCLEO_SECUNDARIO);
+
+#ifdef AUDIO_I2S
+    // Tarea que mezcla el audio; la más prioritaria del núcleo para no dejar vacío el DMA
+    salidaAudio.Iniciar(3, NUCLEO_SECUNDARIO);
+#endif
 
     // Tarea para la música
     xTaskCreatePinnedToCore(
@@ -244,76 +445,78 @@ void DualCoreESP32 ::ConfigCores(void)
 
 // --- TASKS DE LOS CORES --
 
-// Tarea para manejar la pausa del juego.
+// Tarea para manejar la pausa del juego. Duerme hasta que llega un evento de EXIT.
 void DualCoreESP32 ::PauseTask(void *pvParameters)
 {
+    EventoEntrada evento;
+
     while (true)
     {
-        if (!digitalRead(BTN_EXIT) && isGameInProgress == true)
-            isPauseActivated = true;
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+        if (entrada.Esperar(subPausa, &evento, portMAX_DELAY) && estadoPublicado.Leer().enJuego)
+            pausaSolicitada = true;
     }
 }
 
-// Tarea para cambiar entre música
+// Tarea para cambiar entre música. Duerme hasta que llega un cambio de música;
+// si se reactiva audio.loop() habrá que volver a despertarla periódicamente.
 void DualCoreESP32 ::MusicTask(void *pvParameters)
 {
     MusicState newState;
 
     while (true)
     {
-        if (xQueueReceive(musicQueue, &newState, 0) == pdTRUE)
+#ifdef AUDIO_I2S
+        // Mientras suena una pista, despertar periódicamente para rellenar su anillo
+        TickType_t espera = musica.Activa() ? pdMS_TO_TICKS(MUSICA_RELLENO_MS) : portMAX_DELAY;
+#else
+        TickType_t espera = portMAX_DELAY;
+#endif
+        if (xQueueReceive(musicQueue, &newState, espera) == pdTRUE)
         {
             currentMusicState = newState;
 
-            // Detener la música actual
-            // audio.stopSong();
-            // vTaskDelay(10 / portTICK_PERIOD_MS);
-
+            // Las pistas se generan con tools/transcodificar.py; abrir una nueva
+            // reemplaza a la actual
             switch (currentMusicState)
             {
             case MUSIC_INTRO:
-                // if (!SD.exists("/intro.mp3"))
-                // Serial.println("Archivo intro.mp3 no encontrado");
-                // audio.connecttoFS(SD,"/intro.mp3");
+                ReproducirPista("/intro.adp");
                 break;
             case MUSIC_MENU:
-                // if (!SD.exists("/menu.mp3"))
-                // Serial.println("Archivo menu.mp3 no encontrado");
-                // audio.connecttoFS(SD,"/menu.mp3");
+                ReproducirPista("/menu.adp");
                 break;
             case MUSIC_GAME:
-                // if (!SD.exists("/game.mp3"))
-                // Serial.println("Archivo game.mp3 no encontrado");
-                // audio.connecttoFS(SD,"/game.mp3");
+                ReproducirPista("/game.adp");
                 break;
             case MUSIC_PAUSE:
-                // audio.stopSong();
-                // isAudioStopped = true;
+                DetenerPista();
                 break;
             case MUSIC_ELEVATOR:
-                // if (!SD.exists("/elevator.mp3"))
-                // Serial.println("Archivo elevator.mp3 no encontrado");
-                // audio.connecttoFS(SD,"/elevator.mp3");
+                ReproducirPista("/elevator.adp");
                 break;
             default:
                 break;
             }
         }
-        // audio.loop();
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+
+#ifdef AUDIO_I2S
+        // Mantener lleno el anillo de la pista; es la única lectura de la SD de esta tarea
+        musica.Rellenar();
+#endif
     }
 }
 
-// Tarea para correr toda la lógica del juego
+// Tarea para correr toda la lógica del juego. Duerme hasta que llega un nuevo estado.
 void DualCoreESP32 ::GameLogicTask(void *pvParameters)
 {
     GameState newState;
     while (1)
     {
-        if (xQueueReceive(gameQueue, &newState, 0) == pdTRUE)
+        if (xQueueReceive(gameQueue, &newState, portMAX_DELAY) == pdTRUE)
         {
             currentGameState = newState;
+            PublicarEstado();
+            BITACORA(MSG_ESTADO_JUEGO, currentGameState);
             switch (currentGameState)
             {
             // INTRODUCCIÓN
@@ -340,11 +543,11 @@ void DualCoreESP32 ::GameLogicTask(void *pvParameters)
             case STATE_PAUSE:
                 ChangeMusic(MUSIC_PAUSE);
                 MostrarMenuPausa();
+                break;
             default:
                 break;
             }
         }
-        vTaskDelay(1 / portTICK_PERIOD_MS);
     }
 }
 
@@ -359,58 +562,151 @@ void ChangeMusic(MusicState newState)
 //-- Función para cambiar el estado del juego; cambiar entre funciones
 void ChangeGameState(GameState newState)
 {
-    xQueueSend(gameQueue, &newState, 0);
+    // Sólo debe haber un estado pendiente; si la cola está llena el nuevo se perdería
+    bool encolado = xQueueSend(gameQueue, &newState, 0) == pdTRUE;
+    VERIFICAR(encolado, INV_ESTADO_PERDIDO);
+    (void)encolado;
 }
 
-//-- Estado STATE_SCORES;
-// Lee la el archivo JSON e imprime los 4 mejores Scores guardados
-void ReadMaxScores(void)
+//-- Publica la vista del juego para las tareas del otro núcleo (sólo desde la tarea de lógica)
+void PublicarEstado(void)
 {
-    // Borrar pantalla
-    lcd.clear();
+    GameSnapshot snapshot;
+    snapshot.tick = ticksLogica;
+    snapshot.estado = currentGameState;
+    snapshot.enJuego = isGameInProgress;
+    snapshot.pausa = isPauseActivated;
+    snapshot.nivel = checkPointNivel + 1;
+    snapshot.puntaje = personaje.ImprimirPuntaje();
+    snapshot.tiempoRestante = tiempoRestanteActual;
+    snapshot.personajeX = personaje.GetX();
+    snapshot.personajeY = personaje.GetY();
+    snapshot.diamanteX = objetivo.GetX();
+    snapshot.diamanteY = objetivo.GetY();
+    estadoPublicado.Publicar(snapshot);
+}
 
-    File JsonFile = SD.open("/GameData.json");
-    if (!JsonFile)
-    {
-        Serial.println("Error opening GameData.json");
-        return;
-    }
+//-- Copia el estado actual del juego para el control remoto
+void LlenarEstadoRemoto(EstadoRemoto *estado)
+{
+    GameSnapshot snapshot = estadoPublicado.Leer();
+    estado->estado = snapshot.estado;
+    estado->nivel = snapshot.nivel;
+    estado->puntaje = snapshot.puntaje;
+    estado->tiempoRestante = snapshot.tiempoRestante;
+    estado->personajeX = snapshot.personajeX;
+    estado->personajeY = snapshot.personajeY;
+    estado->diamanteX = snapshot.diamanteX;
+    estado->diamanteY = snapshot.diamanteY;
+    estado->banderas = (snapshot.enJuego ? ESTADO_BANDERA_JUEGO : 0) | (snapshot.pausa ? ESTADO_BANDERA_PAUSA : 0);
+    estado->tick = snapshot.tick;
+}
 
-    // JSON Doc
-    JsonDocument doc;
-    deserializeJson(doc, JsonFile);
-    JsonArray bestScores = doc["bestScores"].as<JsonArray>();
-    JsonFile.close(); // Cierra el archivo antes de entrar en el bucle
+//-- Sólo una partida en curso (o una sesión de control remoto) necesita el CPU a toda velocidad
+bool JuegoInteractivo(void)
+{
+    GameSnapshot snapshot = estadoPublicado.Leer();
+    return (snapshot.estado == STATE_GAME && !snapshot.pausa) || entrada.InyeccionActiva();
+}
 
-    int scoreCount = bestScores.size();
-    int state = digitalRead(BTN_EXIT);
-    int contador = 0;
-    while (digitalRead(BTN_EXIT))
-    {
-        JsonObject score = bestScores[contador];
-        const char *name = score["name"];
-        int scoreValue = score["score"];
+//-- Copia el estado de la partida en curso al snapshot
+void CapturarPartida(SnapshotJuego *snapshot, uint8_t banderas)
+{
+    snapshot->banderas = banderas;
+    snapshot->nivel = checkPointNivel;
+    snapshot->puntaje = personaje.ImprimirPuntaje();
+    snapshot->puntajeNivel = checkPointPuntaje;
+    snapshot->transcurridoNivel = reloj.Transcurrido(temporizadorNivel);
+    snapshot->personajeX = personaje.GetX();
+    snapshot->personajeY = personaje.GetY();
+    snapshot->diamanteX = objetivo.GetX();
+    snapshot->diamanteY = objetivo.GetY();
+    snapshot->aleatorio = estadoAleatorio;
+}
+
+//-- Vuelve a poner la partida en el estado del snapshot (el temporizador del nivel lo
+// reprograma JuegoCompleto, que conoce la duración de cada nivel)
+void AplicarPartida(const SnapshotJuego *snapshot)
+{
+    checkPointNivel = snapshot->nivel;
+    checkPointPuntaje = snapshot->puntajeNivel;
+    personaje.puntaje = snapshot->puntaje;
+    // Un snapshot de un campo más ancho (firmware anterior) no debe dejar objetos fuera
+    personaje.x = (snapshot->personajeX <= DisposicionJuego::maxX) ? snapshot->personajeX : DisposicionJuego::maxX;
+    personaje.y = (snapshot->personajeY <= DisposicionJuego::maxY) ? snapshot->personajeY : DisposicionJuego::maxY;
+    objetivo.x = (snapshot->diamanteX <= DisposicionJuego::maxX) ? snapshot->diamanteX : DisposicionJuego::maxX;
+    objetivo.y = (snapshot->diamanteY <= DisposicionJuego::maxY) ? snapshot->diamanteY : DisposicionJuego::maxY;
+    SembrarAleatorio(snapshot->aleatorio);
+}
+
+void GuardarPartida(uint8_t banderas)
+{
+    CapturarPartida(&partidaGuardada, banderas);
+    if (!almacenSnapshot.Guardar(&partidaGuardada))
+        BITACORA(MSG_SNAPSHOT_ERROR);
+}
+
+//-- Si hay una partida sin terminar en la NVS, dejarla en pausa lista para reanudar
+bool RestaurarPartida(void)
+{
+    unsigned long inicio = micros();
+    if (!almacenSnapshot.Cargar(&partidaGuardada))
+        return false;
+
+    isPauseActivated = true;
+    isGameInProgress = true;
+    PublicarEstado();
+    reloj.Pausar();
+    telemetria.IniciarSesion(partidaGuardada.nivel + 1, partidaGuardada.puntaje);
+    telemetria.Pausa(partidaGuardada.nivel + 1, partidaGuardada.puntaje);
+    BITACORA(MSG_PARTIDA_RESTAURADA, partidaGuardada.nivel + 1, partidaGuardada.puntaje, (uint32_t)(micros() - inicio));
+    return true;
+}
+
+//-- Estado STATE_SCORES;
+// Muestra el marcador completo por páginas; el joystick se desplaza una fila y
+// sólo se lee de la SD la página visible
+void ReadMaxScores(void)
+{
+    EventoEntrada evento;
+    EntradaMarcador pagina[SCORES_FILAS];
+    uint32_t primero = 0;
+    uint32_t total = marcador.Total();
 
-        if (name && strlen(name) > 0)
+    entrada.Vaciar(subScores);
+    while (true)
+    {
+        pantalla.clear();
+        if (total == 0)
+        {
+            pantalla.setCursor(0, 0);
+            pantalla.print("Sin scores");
+        }
+        uint8_t leidas = marcador.LeerPagina(primero, pagina, SCORES_FILAS);
+        for (uint8_t fila = 0; fila < leidas; fila++)
         {
-            lcd.setCursor(0, 0);
-            lcd.print(contador + 1); // Posición
-            lcd.print(" Pos| Name: ");
-            lcd.print(name);
-            lcd.setCursor(7, 1);
-            lcd.print("Score: ");
-            lcd.print(scoreValue);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-            lcd.clear();
+            // "   12 ABC   1234": lugar, nombre y puntaje alineado a la derecha. Cinco
+            // dígitos cubren el marcador lleno (MARCADOR_MAX_BLOQUES * MARCADOR_POR_BLOQUE)
+            CampoLCD<0, 5>::Entero(pantalla, fila, primero + fila + 1);
+            CampoLCD<6, 3>::Texto(pantalla, fila, pagina[fila].nombre);
+            CampoLCD<10, 6>::Entero(pantalla, fila, pagina[fila].puntaje);
         }
 
-        // Cambio al menú principal
-        if (!digitalRead(BTN_EXIT))
-            ChangeGameState(STATE_MENU);
-        contador++;
-        if (contador > 4)
-            contador = 0;
+        pantalla.Presentar();
+
+        // Dormir hasta el siguiente evento (las repeticiones se aceleran al mantener)
+        if (!entrada.Esperar(subScores, &evento, portMAX_DELAY))
+            continue;
+        if (evento.control == CONTROL_EXIT)
+            break;
+        if (evento.control == CONTROL_ARRIBA && primero > 0)
+            primero--;
+        else if (evento.control == CONTROL_ABAJO && primero + SCORES_FILAS < total)
+            primero++;
     }
+
+    // Cambio al menú principal
+    ChangeGameState(STATE_MENU);
 }
 
 //-- Función para reproducir el Intro del juego
@@ -423,78 +719,69 @@ void IntroGame()
     const char *title = "Catch the";
     const char *nameGame = "Diamonds";
 
-    byte diamondTopLeft[] = {B00000, B00000, B00111, B01000, B10100, B10010, B10001, B01000};
-    byte diamondTop[] = {B00000, B00000, B11111, B10001, B01010, B00100, B01010, B10001};
-    byte diamondTopRight[] = {B00000, B00000, B11100, B00010, B00101, B01001, B10001, B00010};
-    byte diamondBottomLeft[] = {B00101, B00010, B00001, B00000, B00000, B00000, B00000, B00000};
-    byte diamondBottom[] = {B10001, B01010, B00100, B10001, B01110, B00000, B00000, B00000};
-    byte diamondBottomRight[] = {B10100, B01000, B10000, B00000, B00000, B00000, B00000, B00000};
-
-    // Crea los caracteres del diamante del 3 al 6
-    lcd.createChar(2, diamondTopLeft);
-    lcd.createChar(3, diamondTop);
-    lcd.createChar(4, diamondTopRight);
-    lcd.createChar(5, diamondBottomLeft);
-    lcd.createChar(6, diamondBottom);
-    lcd.createChar(7, diamondBottomRight);
-
     // Iniciar eliminando todo en pantalla
-    lcd.clear();
+    pantalla.clear();
 
     // "Feria" de caracteres
-    lcd.write(characterFull);
-    for (int i = 0; i < 17; i++)
+    pantalla.write(characterFull);
+    for (int i = 0; i <= GeometriaJuego::columnas; i++)
     {
-        lcd.setCursor(i + 1, 0);
-        lcd.write(characterFull);
-        lcd.setCursor(i, 1);
-        lcd.write(characterFull);
-        vTaskDelay(100 / portTICK_PERIOD_MS);
+        pantalla.setCursor(i + 1, 0);
+        pantalla.write(characterFull);
+        pantalla.setCursor(i, 1);
+        pantalla.write(characterFull);
+        pantalla.Presentar();
+        reloj.Esperar(100);
     }
 
-    for (int i = 15; i > 0; i--)
+    for (int i = GeometriaJuego::columnas - 1; i > 0; i--)
     {
-        lcd.setCursor(i - 1, 0);
-        lcd.write(characterEmpty);
-        lcd.setCursor(i, 1);
-        lcd.write(characterEmpty);
-        vTaskDelay(100 / portTICK_PERIOD_MS);
+        pantalla.setCursor(i - 1, 0);
+        pantalla.write(characterEmpty);
+        pantalla.setCursor(i, 1);
+        pantalla.write(characterEmpty);
+        pantalla.Presentar();
+        reloj.Esperar(100);
     }
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-    lcd.clear();
-
-    // Dibuja el diamante
-    lcd.setCursor(6, 0);
-    for (int i = 2; i <= 4; i++)
-        lcd.write(byte(i));
+    pantalla.Presentar();
+    reloj.Esperar(500);
+    pantalla.clear();
 
-    lcd.setCursor(6, 1);
-    for (int i = 5; i <= 7; i++)
-        lcd.write(byte(i));
+    // Dibuja el diamante, mosaico por mosaico
+    for (uint8_t fila = 0; fila < spriteDiamante.alto; fila++)
+    {
+        pantalla.setCursor(DisposicionJuego::Centrar(spriteDiamante.ancho), fila);
+        for (uint8_t columna = 0; columna < spriteDiamante.ancho; columna++)
+            pantalla.write(GLIFO_DIAMANTE_GRANDE + fila * spriteDiamante.ancho + columna);
+    }
 
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
-    lcd.clear();
+    pantalla.Presentar();
+    reloj.Esperar(2000);
+    pantalla.clear();
 
     // Titulo del juego desplazándose
-    lcd.print(title);
+    pantalla.print(title);
     for (int i = 0; i < 7; i++)
     {
         // Mostrar el título desplazándose
-        lcd.scrollDisplayRight();
-        vTaskDelay(200 / portTICK_PERIOD_MS);
+        pantalla.scrollDisplayRight();
+        pantalla.Presentar();
+        reloj.Esperar(200);
     }
 
     // Nombre del juego
-    lcd.setCursor(8, 1);
-    lcd.print(nameGame);
+    pantalla.setCursor(8, 1);
+    pantalla.print(nameGame);
     for (int i = 0; i < 7; i++)
     {
-        lcd.scrollDisplayLeft();
-        vTaskDelay(200 / portTICK_PERIOD_MS);
+        pantalla.scrollDisplayLeft();
+        pantalla.Presentar();
+        reloj.Esperar(200);
     }
-    vTaskDelay(200 / portTICK_PERIOD_MS);
+    pantalla.Presentar();
+    reloj.Esperar(200);
 
-    lcd.clear();
+    pantalla.clear();
 
     // Imprimir nombre de los autores
     const int numAutores = sizeof(autores) / sizeof(autores[0]);
@@ -502,33 +789,34 @@ void IntroGame()
 
     for (int i = 0; i < numAutores; i += 2)
     {
-        lcd.clear();
+        pantalla.clear();
 
         // Primer autor
-        lcd.setCursor(0, 0);
-        lcd.print(autores[i]);
+        pantalla.setCursor(0, 0);
+        pantalla.print(autores[i]);
 
         // Segundo autor (si existe)
         if (i + 1 < numAutores)
         {
-            lcd.setCursor(0, 1);
-            lcd.print(autores[i + 1]);
+            pantalla.setCursor(0, 1);
+            pantalla.print(autores[i + 1]);
         }
         if (i + 2 >= numAutores)
         {
             finalizadoCorrectamente = true;
         }
-        vTaskDelay(1200 / portTICK_PERIOD_MS);
+        pantalla.Presentar();
+        reloj.Esperar(1200);
     }
 
     if (finalizadoCorrectamente)
     {
-        Serial.println("Finalizó la ronda FOR de autores");
+        BITACORA(MSG_AUTORES_FIN);
         ChangeGameState(STATE_MENU);
     }
     else
     {
-        Serial.println("Error: el ciclo no finalizó correctamente");
+        BITACORA(MSG_AUTORES_ERROR);
     }
 }
 
@@ -565,223 +853,333 @@ void PrintDirectory(File dir, int numTabs)
 
 void ActivarBuzzer(unsigned int frecuency, unsigned long millis)
 {
+#ifdef AUDIO_I2S
+    // Los efectos se suman a la música en el mezclador en vez de interrumpirla
+    salidaAudio.Tono(frecuency, millis);
+#else
     tone(BUZZER_PIN, frecuency, millis);
+#endif
 }
 
-void MostrarMenuPrincipal(void)
+// Sin salida I2S no hay por dónde sonar la música: el buzzer queda para los efectos
+void ReproducirPista(const char *ruta)
+{
+#ifdef AUDIO_I2S
+    if (!musica.Abrir(ruta))
+    {
+        BITACORA(MSG_PISTA_INVALIDA, ruta);
+        return;
+    }
+    salidaAudio.Musica(ReproductorPista::Fuente, &musica);
+#else
+    (void)ruta;
+#endif
+}
+
+void DetenerPista(void)
+{
+#ifdef AUDIO_I2S
+    musica.Cerrar();
+    salidaAudio.DetenerMusica();
+#endif
+}
+
+//-- Mueve la flecha entre las dos filas del menú hasta que se presiona ENTER.
+// La tarea duerme entre eventos del joystick.
+int SeleccionarOpcion(void)
 {
     int optionToSelect = 0;
-    lcd.clear();
-    lcd.setCursor(1, 0);
-    lcd.print("Comenzar");
-    lcd.setCursor(1, 1);
-    lcd.print("Scores");
+    EventoEntrada evento;
+
+    entrada.Vaciar(subMenu);
+    pantalla.setCursor(0, optionToSelect);
+    pantalla.write(0x7E); // Flecha (→)
 
-    while (digitalRead(BTN_ENTER))
+    while (true)
     {
-        valueY = analogRead(VRY_PIN); // Leer eje Y del joystick
+        pantalla.Presentar();
+        if (!entrada.Esperar(subMenu, &evento, portMAX_DELAY))
+            continue;
+        if (evento.control == CONTROL_ENTER)
+            break;
+
         // Cambiar selección del menú
-        // Ajustar para mover hacia abajo
-        if (valueY < 1000)
+        int nuevaOpcion = (evento.control == CONTROL_ABAJO) ? 1 : 0;
+        if (nuevaOpcion != optionToSelect)
         {
-            lcd.setCursor(0, 0);
-            lcd.write(0x20);
-            optionToSelect = 1;
+            pantalla.setCursor(0, optionToSelect);
+            pantalla.write(0x20);
+            optionToSelect = nuevaOpcion;
+            pantalla.setCursor(0, optionToSelect);
+            pantalla.write(0x7E); // Flecha (→)
             ActivarBuzzer(2000, 50);
         }
-        if (valueY == MAX_VERT)
-        {
-            lcd.setCursor(0, 1);
-            lcd.write(0x20);
-            optionToSelect = 0;
-            ActivarBuzzer(2000, 50);
-        }
-        lcd.setCursor(0, optionToSelect);
-        lcd.write(0x7E); // Flecha (→)
-        vTaskDelay(10 / portTICK_PERIOD_MS);
     }
+    return optionToSelect;
+}
+
+void MostrarMenuPrincipal(void)
+{
+    pantalla.clear();
+    pantalla.setCursor(1, 0);
+    pantalla.print("Comenzar");
+    pantalla.setCursor(1, 1);
+    pantalla.print("Scores");
+
+    int optionToSelect = SeleccionarOpcion();
 
     // Serial.println("Sale del programa");
     switch (optionToSelect)
     {
     case 0: // Se envía a iniciar juego
         ChangeGameState(STATE_GAME);
+        break;
     case 1: // Se envía a scores
         ChangeGameState(STATE_SCORES);
+        break;
     }
 }
 
 void MostrarMenuPausa(void)
 {
-    int optionToSelect = 0;
-    lcd.clear();
-    lcd.setCursor(1, 0);
-    lcd.print("Reanudar");
-    lcd.setCursor(1, 1);
-    lcd.print("Menu principal");
+    pantalla.clear();
+    pantalla.setCursor(1, 0);
+    pantalla.print("Reanudar");
+    pantalla.setCursor(1, 1);
+    pantalla.print("Menu principal");
 
-    while (digitalRead(BTN_ENTER))
-    {
-        valueY = analogRead(VRY_PIN); // Leer eje Y del joystick
-        // Cambiar selección del menú
-        // Ajustar para mover hacia abajo
-        if (valueY < 1000)
-        {
-            lcd.setCursor(0, 0);
-            lcd.write(0x20);
-            optionToSelect = 1;
-            ActivarBuzzer(2000, 50);
-        }
-        if (valueY == MAX_VERT)
-        {
-            lcd.setCursor(0, 1);
-            lcd.write(0x20);
-            optionToSelect = 0;
-            ActivarBuzzer(2000, 50);
-        }
-        lcd.setCursor(0, optionToSelect);
-        lcd.write(0x7E); // Flecha (→)
-        vTaskDelay(10 / portTICK_PERIOD_MS);
-    }
+    int optionToSelect = SeleccionarOpcion();
 
     // Serial.println("Sale del programa");
     switch (optionToSelect)
     {
     case 0: // Se reinicia el juego
         ChangeGameState(STATE_GAME);
+        break;
     case 1: // Se envía menú principal
+        // Se descarta la partida pausada para que "Comenzar" no la reanude
         isGameInProgress = false;
+        isPauseActivated = false;
+        PublicarEstado();
+        reloj.Reanudar();
+        almacenSnapshot.Descartar();
+        telemetria.TerminarSesion(checkPointNivel, personaje.ImprimirPuntaje(), true);
         ChangeGameState(STATE_MENU);
+        break;
     }
 }
 
 void mostrarMensaje(const char *linea1, const char *linea2)
 {
-    lcd.clear();
-    lcd.setCursor(0, 0);
-    lcd.print(linea1);
-    lcd.setCursor(0, 1);
-    lcd.print(linea2);
+    pantalla.clear();
+    pantalla.setCursor(0, 0);
+    pantalla.print(linea1);
+    pantalla.setCursor(0, 1);
+    pantalla.print(linea2);
+    pantalla.Presentar();
 }
 
 bool nivel(int duracionEnSegundos, int puntosRequeridos, int puntajeEntrante)
 {
-    static unsigned long lastUpdateTime = 0;
-    const unsigned long UPDATE_INTERVAL = 100; // Actualizar cada 100ms
-
-    unsigned long currentMillis = millis();
+    const unsigned long UPDATE_INTERVAL = 100; // Actualizar cada 100ms de juego
 
-    // Actualizar solo cada UPDATE_INTERVAL milisegundos
-    if (currentMillis - lastUpdateTime >= UPDATE_INTERVAL)
+    // Actualizar solo cuando vence el temporizador del cuadro
+    if (reloj.Vencido(temporizadorCuadro))
     {
-        lastUpdateTime = currentMillis;
+        reloj.Programar(temporizadorCuadro, UPDATE_INTERVAL);
+        unsigned long inicioCuadro = micros();
 
-        lcd.clear();
-
-        // Calcular el tiempo restante
-        int tiempoRestante = duracionEnSegundos - (currentMillis - inicioMilis) / 1000;
+        // Calcular el tiempo restante (el reloj no avanza durante la pausa)
+        int tiempoRestante = duracionEnSegundos - reloj.Transcurrido(temporizadorNivel) / 1000;
+        tiempoRestanteActual = tiempoRestante;
+        ticksLogica++;
 
         if (tiempoRestante >= 0)
         {
-            // Mover personaje con joystick
-            valueX = analogRead(VRX_PIN);
-            valueY = analogRead(VRY_PIN);
-
-            if (valueX == MAX_HORI)
-            {
-                personaje.Right();
-            }
-            if (valueX < 100)
-            {
-                personaje.Left();
-            }
-            if (valueY == MAX_VERT)
-            {
-                personaje.Up();
-            }
-            if (valueY < 100)
-            {
-                personaje.Down();
-            }
-
-            // Dibujar en la pantalla LCD
-            lcd.setCursor(personaje.GetX(), personaje.GetY());
-            lcd.write(0);
-            lcd.setCursor(objetivo.GetX(), objetivo.GetY());
-            lcd.write(1);
-            // Verificar colisión
-            if (objetivo.Colision(personaje.GetX(), personaje.GetY(), objetivo.GetX(), objetivo.GetY()))
-            {
-                ActivarBuzzer(1000, 10);
-                personaje.IncrementarPuntaje();
-                objetivo.RehubicarObjeto();
-            }
-            lcd.setCursor(14, 0);
-            lcd.print(tiempoRestante);
-            lcd.setCursor(14, 1);
-            lcd.print(personaje.ImprimirPuntaje());
+            ActualizarCuadro(tiempoRestante, puntajeEntrante);
+            pantalla.Presentar();
+            PublicarEstado();
 
+            telemetria.RegistrarCuadro(micros() - inicioCuadro);
+            controlRemoto.NotificarTick();
             return false; // El nivel sigue activo
         }
 
+        // El tiempo se acabó: una pausa durante el mensaje ya no debe interrumpir el nivel
+        isGameInProgress = false;
+        pausaSolicitada = false;
+        PublicarEstado();
+
         // El tiempo se acabó, verificar resultado
         if (personaje.ImprimirPuntaje() - puntajeEntrante >= puntosRequeridos)
         {
             mostrarMensaje("Nivel completado!", " =============> ");
-            vTaskDelay(2000 / portTICK_PERIOD_MS); // Dar tiempo para leer el mensaje
+            reloj.Esperar(2000); // Dar tiempo para leer el mensaje
             return true;
         }
         else
         {
             mostrarMensaje("Tiempo agotado", "Intenta de nuevo");
-            vTaskDelay(2000 / portTICK_PERIOD_MS);
+            reloj.Esperar(2000);
             return true;
         }
     }
     return false; // No ha pasado suficiente tiempo para actualizar
 }
 
-void EvaluarNivelFinal(int puntajeFinal)
+//-- Un cuadro del nivel: mover al personaje, dibujar, detectar colisión y HUD
+void ActualizarCuadro(int tiempoRestante, int puntajeEntrante)
 {
-    File JsonFile = SD.open("/GameData.json");
-    if (!JsonFile)
+    pantalla.clear();
+
+    // Mover personaje con los eventos del joystick acumulados desde el último cuadro
+    EventoEntrada evento;
+#ifdef TRAZAR_LATENCIA
+    uint32_t traza = 0;
+#endif
+    while (entrada.Esperar(subJuego, &evento, 0))
     {
-        Serial.println("Error opening Scores");
-        return;
+#ifdef TRAZAR_LATENCIA
+        // Se sigue el evento más antiguo del cuadro: es el que más espera
+        if (traza == 0)
+            traza = latencia.Abrir(evento.muestraUs, evento.publicadoUs);
+#endif
+        switch (evento.control)
+        {
+        case CONTROL_DERECHA:
+            personaje.Right();
+            break;
+        case CONTROL_IZQUIERDA:
+            personaje.Left();
+            break;
+        case CONTROL_ARRIBA:
+            personaje.Up();
+            break;
+        case CONTROL_ABAJO:
+            personaje.Down();
+            break;
+        default:
+            break;
+        }
     }
-    // JSON Doc con tamaño predefinido
-    JsonDocument doc;
-    deserializeJson(doc, JsonFile);
-    JsonArray bestScores = doc["bestScores"].as<JsonArray>();
-    JsonFile.close(); // Cierra el archivo antes de entrar en el bucle
-    JsonObject score = bestScores[0];
-    PuntajeTop = bestScores[0]["score"]; // Puntaje Top del Json
-
-    char *nick = nullptr;
 
-    if (personaje.ImprimirPuntaje() >= puntajeFinal)
+    // Dibujar en la pantalla LCD
+    pantalla.setCursor(personaje.GetX(), personaje.GetY());
+    pantalla.write(byte(GLIFO_PERSONAJE));
+    pantalla.setCursor(objetivo.GetX(), objetivo.GetY());
+    pantalla.write(byte(GLIFO_DIAMANTE));
+    // Verificar colisión
+    if (objetivo.Colision(personaje.GetX(), personaje.GetY(), objetivo.GetX(), objetivo.GetY()))
     {
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Ganaste el juego!");
-        Serial.println("Juego completado con éxito");
+        ActivarBuzzer(1000, 10);
+        personaje.IncrementarPuntaje();
+        objetivo.RehubicarObjeto();
+    }
+    VERIFICAR(personaje.ImprimirPuntaje() >= puntajeEntrante, INV_PUNTAJE_DECRECE);
+    VERIFICAR(personaje.GetX() >= 0 && personaje.GetX() <= DisposicionJuego::maxX &&
+                  personaje.GetY() >= 0 && personaje.GetY() <= DisposicionJuego::maxY,
+              INV_POSICION_PERSONAJE);
+    DibujarHUD<GeometriaJuego>(tiempoRestante, personaje.ImprimirPuntaje());
+
+#ifdef TRAZAR_LATENCIA
+    if (traza != 0)
+        pantalla.Trazar(traza); // Renderizador::Presentar (en nivel) marca la entrega
+#endif
+}
 
-        if (personaje.ImprimirPuntaje() >= PuntajeTop)
+//-- Tiempo y puntaje a la derecha del campo en campos de ancho fijo; las ramas se
+// resuelven al compilar
+template <typename G>
+void DibujarHUD(int tiempoRestante, int puntaje)
+{
+    typedef CampoLCD<G::hudColumna, G::hudAncho> CampoHUD;
+
+    if constexpr (G::hudSeparador)
+    {
+        for (uint8_t fila = 0; fila < G::filas; fila++)
         {
-            // mostrarMensaje("!Nuevo Puntaje!","Con "+ personaje.ImprimirPuntaje());
-            nick = ElegirNombre();
-            GuardarScore(personaje.ImprimirPuntaje(), nick);
-            Serial.println("Nuevo Score");
+            pantalla.setCursor(Disposicion<G>::columnaSeparador, fila);
+            pantalla.write('|');
         }
     }
+    if constexpr (G::hudEtiquetas)
+    {
+        CampoHUD::Texto(pantalla, G::hudFilaTiempo, "Tiempo");
+        CampoHUD::Entero(pantalla, G::hudFilaTiempo + 1, tiempoRestante);
+        CampoHUD::Texto(pantalla, G::hudFilaPuntaje, "Puntos");
+        CampoHUD::Entero(pantalla, G::hudFilaPuntaje + 1, puntaje);
+    }
     else
     {
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Lo siento...");
-        lcd.setCursor(0, 1);
-        lcd.print("Fin del juego");
-        Serial.println("Fin del juego");
+        CampoHUD::Entero(pantalla, G::hudFilaTiempo, tiempoRestante);
+        CampoHUD::Entero(pantalla, G::hudFilaPuntaje, puntaje);
+    }
+}
+
+void EvaluarNivelFinal(int puntajeFinal)
+{
+    PuntajeTop = marcador.Mejor(); // Puntaje Top del marcador
+
+    if (personaje.ImprimirPuntaje() >= puntajeFinal)
+    {
+        pantalla.clear();
+        pantalla.setCursor(0, 0);
+        pantalla.print("Ganaste el juego!");
+        BITACORA(MSG_JUEGO_COMPLETADO);
+    }
+    else
+    {
+        pantalla.clear();
+        pantalla.setCursor(0, 0);
+        pantalla.print("Lo siento...");
+        pantalla.setCursor(0, 1);
+        pantalla.print("Fin del juego");
+        BITACORA(MSG_FIN_DEL_JUEGO);
+    }
+    pantalla.Presentar();
+    reloj.Esperar(2000);
+
+    // Se guardan todos los puntajes, no sólo los mejores
+    pantalla.clear();
+    pantalla.setCursor(0, 0);
+    pantalla.print("Puntaje: ");
+    pantalla.print(personaje.ImprimirPuntaje());
+    personaje.AsignarNombre(ElegirNombre());
+    char *nick = personaje.ImprimirNombre();
+    uint32_t lugar = GuardarScore(personaje.ImprimirPuntaje(), nick);
+
+    // Cada diamante atrapado suma un punto, así que el puntaje es también el total de diamantes
+    Perfil perfil;
+    bool conPerfil = perfiles.RegistrarPartida(nick, personaje.ImprimirPuntaje(), checkPointNivel, personaje.ImprimirPuntaje(), &perfil);
+    if (!conPerfil)
+        BITACORA(MSG_PERFIL_ERROR);
+
+    if (lugar > 0)
+    {
+        char linea[17];
+        snprintf(linea, sizeof(linea), "de %lu", (unsigned long)marcador.Total());
+        pantalla.clear();
+        pantalla.setCursor(0, 0);
+        pantalla.print("Lugar ");
+        pantalla.print(lugar);
+        pantalla.setCursor(0, 1);
+        pantalla.print(linea);
+        if (personaje.ImprimirPuntaje() >= PuntajeTop)
+            BITACORA(MSG_NUEVO_SCORE);
+    }
+    pantalla.Presentar();
+
+    if (conPerfil)
+    {
+        char linea[17];
+        reloj.Esperar(2000);
+        pantalla.clear();
+        pantalla.setCursor(0, 0);
+        snprintf(linea, sizeof(linea), "%s %lu partidas", perfil.nick, (unsigned long)perfil.partidas);
+        pantalla.print(linea);
+        pantalla.setCursor(0, 1);
+        snprintf(linea, sizeof(linea), "Mejor %lu Niv %u", (unsigned long)perfil.mejorPuntaje, perfil.nivelMaximo);
+        pantalla.print(linea);
     }
 
     // Cambiamos estado del juego a terminado
@@ -794,66 +1192,108 @@ void JuegoCompleto()
     const int tiempos[NIVELES] = {10, 10, 10};
     const int puntosRequeridos[NIVELES] = {1, 1, 1};
 
+    // Reanudar siempre desde el snapshot: el de la pausa o el restaurado al arrancar
+    if (isPauseActivated)
+    {
+        AplicarPartida(&partidaGuardada);
+    }
     // Reiniciamos valores cada vez que se inicie el juego
-    if (!isPauseActivated)
+    else
     {
-        Serial.println("Entro en juego completo");
+        BITACORA(MSG_INICIO_PARTIDA);
         personaje.ReiniciarValores();
         checkPointNivel = 0;
         checkPointPuntaje = 0;
+        telemetria.IniciarSesion(1, 0);
     }
 
     for (int i = checkPointNivel; i < NIVELES; i++)
     {
-        lcd.clear();
+        pantalla.clear();
 
         // Si no se inicializa desde una pausa, mostrar
         if (!isPauseActivated)
         {
-            lcd.print("Nivel ");
-            lcd.print(i + 1);
-            lcd.setCursor(0, 1);
-            lcd.print("Alcanza: ");
-            lcd.print(puntosRequeridos[i] + personaje.ImprimirPuntaje());
-            lcd.print(" pts.");
+            pantalla.print("Nivel ");
+            pantalla.print(i + 1);
+            pantalla.setCursor(0, 1);
+            pantalla.print("Alcanza: ");
+            pantalla.print(puntosRequeridos[i] + personaje.ImprimirPuntaje());
+            pantalla.print(" pts.");
 
             // Guardamos puntaje del personaje
             checkPointPuntaje = personaje.ImprimirPuntaje();
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
+            pantalla.Presentar();
+            reloj.Esperar(1000);
+
+            // El tiempo del nivel empieza a contar aquí
+            reloj.Programar(temporizadorNivel, tiempos[i] * 1000);
+            GuardarPartida(0);
         }
         else
         {
-            personaje.puntaje = checkPointPuntaje;
+            // Reanudar desde la pausa conservando el puntaje y el tiempo transcurrido del nivel
+            reloj.Programar(temporizadorNivel, tiempos[i] * 1000, partidaGuardada.transcurridoNivel);
             isPauseActivated = false;
+            reloj.Reanudar();
+            telemetria.Reanudar(i + 1);
         }
-
-        inicioMilis = millis(); // Reiniciar el tiempo al inicio de cada nivel
+        reloj.Programar(temporizadorSnapshot, SNAPSHOT_PERIODO);
+        VERIFICAR(i >= 0 && i < NIVELES, INV_INDICE_NIVEL);
 
         bool nivelCompletado = false;
         isGameInProgress = true;
+        pausaSolicitada = false; // Una solicitud vieja no debe pausar el nivel nuevo
+        PublicarEstado();
+        entrada.Vaciar(subJuego);
 
         while (!nivelCompletado)
         {
+            if (pausaSolicitada)
+            {
+                pausaSolicitada = false;
+                isPauseActivated = true;
+                PublicarEstado();
+            }
+
             if (!isPauseActivated)
             {
                 // Serial.println(isPauseActivated);
                 nivelCompletado = nivel(tiempos[i], puntosRequeridos[i], checkPointPuntaje);
-                vTaskDelay(10 / portTICK_PERIOD_MS);
+
+                // Snapshot periódico para sobrevivir a un corte de energía
+                if (!nivelCompletado && reloj.Vencido(temporizadorSnapshot))
+                {
+                    GuardarPartida(0);
+                    reloj.Programar(temporizadorSnapshot, SNAPSHOT_PERIODO);
+                }
+                // Dormir hasta el siguiente cuadro (0 ticks si el reloj va acelerado)
+                vTaskDelay(reloj.TicksHasta(temporizadorCuadro));
             }
             else
             {
+                reloj.Pausar();
+                GuardarPartida(SNAPSHOT_BANDERA_PAUSA);
+                telemetria.Pausa(i + 1, personaje.ImprimirPuntaje());
                 break;
             }
         }
 
+        // Una pausa interrumpe el nivel: salir sin evaluarlo ni avanzar al siguiente.
+        // Antes se seguía con el siguiente nivel y la bandera de pausa lo "reanudaba".
+        if (isPauseActivated)
+            break;
+
+        telemetria.CerrarCuadros(i + 1);
+        telemetria.NivelTerminado(i + 1, personaje.ImprimirPuntaje() - checkPointPuntaje, puntosRequeridos[i]);
+
         // Si no alcanzó los puntos requeridos, terminar el juego
         if (personaje.ImprimirPuntaje() - checkPointPuntaje < puntosRequeridos[i])
         {
             break;
         }
 
-        if (!isPauseActivated)
-            checkPointNivel++;
+        checkPointNivel++;
     }
 
     if (isPauseActivated)
@@ -862,99 +1302,93 @@ void JuegoCompleto()
     }
     else
     {
+        isGameInProgress = false;
+        PublicarEstado();
+        almacenSnapshot.Descartar();
+        telemetria.TerminarSesion(checkPointNivel, personaje.ImprimirPuntaje(), false);
+        EstadisticasRender render = pantalla.Estadisticas();
+        BITACORA(MSG_CUADROS, render.producidos, render.mostrados, render.descartados);
+#ifdef AUDIO_I2S
+        BITACORA(MSG_AUDIO, salidaAudio.CiclosBloque(), salidaAudio.CiclosMaximos(), musica.Faltantes());
+#endif
+#ifdef TRAZAR_LATENCIA
+        latencia.Volcar();
+#endif
         EvaluarNivelFinal(puntosRequeridos[NIVELES - 1]);
-        vTaskDelay(2000 / portTICK_PERIOD_MS); // Dar tiempo para leer el mensaje final
+        pantalla.Presentar();
+        reloj.Esperar(2000); // Dar tiempo para leer el mensaje final
         ChangeGameState(STATE_MENU);
     }
 }
 
 char *ElegirNombre(void)
 {
-    while (digitalRead(BTN_ENTER))
+    const char abc[] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z'};
+    EventoEntrada evento;
+
+    pantalla.setCursor(0, 1);
+    pantalla.print("Nickname: ");
+    entrada.Vaciar(subNombre);
+
+    while (true)
     {
-        valueX = analogRead(VRX_PIN);
-        valueY = analogRead(VRY_PIN);
-        Serial.println("Entro");
-        char abc[] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z'};
+        // Mostrar las tres letras del nombre
+        for (int j = 0; j < 3; j++)
+        {
+            pantalla.setCursor(10 + (j * 2), 1);
+            pantalla.print(nom[j]);
+        }
+        // Mover cursor a la posición actual y activar parpadeo
+        pantalla.setCursor(10 + (posChar * 2), 1);
+        pantalla.blink();
 
-        // Mover posicion:
-        if (valueX == MAX_HORI)
+        pantalla.Presentar();
+
+        // Dormir hasta el siguiente evento (las repeticiones se aceleran al mantener)
+        if (!entrada.Esperar(subNombre, &evento, portMAX_DELAY))
+            continue;
+        if (evento.control == CONTROL_ENTER)
+            break;
+
+        switch (evento.control)
         {
+        // Mover posicion:
+        case CONTROL_DERECHA:
             posChar = (posChar < 2) ? posChar + 1 : 2;
-        } // Derecha
-        if (valueX < 1000)
-        {
+            posLetra = nom[posChar] - 'A';
+            break;
+        case CONTROL_IZQUIERDA:
             posChar = (posChar > 0) ? posChar - 1 : 0;
-        } // Izquierda
-
+            posLetra = nom[posChar] - 'A';
+            break;
         // mover letras:
-        if (valueY < 1000)
-        {
+        case CONTROL_ABAJO:
             posLetra = (posLetra < 25) ? posLetra + 1 : 0;
-        } // Abajo
-        if (valueY == MAX_VERT)
-        {
+            break;
+        case CONTROL_ARRIBA:
             posLetra = (posLetra > 0) ? posLetra - 1 : 25;
-        } // Arriba
+            break;
+        default:
+            break;
+        }
+        VERIFICAR(posChar >= 0 && posChar <= 2 && posLetra >= 0 && posLetra <= 25, INV_POSICION_NOMBRE);
         // Asignar la letra seleccionada a la posición correspondiente
         nom[posChar] = abc[posLetra];
-
-        lcd.setCursor(0, 1);
-        lcd.print("Nickname: ");
-        // Serial.println(PuntajeTop);
-        //  Mover cursor a la posición actual y activar parpadeo
-        lcd.setCursor(10 + (posChar * 2), 1);
-        lcd.print(nom[posChar]);
-        lcd.blink();
-
-        // Mostrar las tres letras del nombre
-        for (int j = 0; j < 3; j++)
-        {
-            lcd.setCursor(10 + (j * 2), 1);
-            lcd.print(nom[j]);
-        }
     }
+    pantalla.noBlink();
     char *nombre = nom;
     return nombre;
 }
 
-void GuardarScore(int Puntaje, char *Nombre)
+uint32_t GuardarScore(int Puntaje, char *Nombre)
 {
-    bool Iterador = true;
-    int Contador = 3;
-    File JsonFile = SD.open("/GameData.json");
-    if (!JsonFile)
-    {
-        Serial.println("Error opening Scores");
-        return;
-    }
-    // JSON Doc con tamaño predefinido
-    JsonDocument doc;
-    deserializeJson(doc, JsonFile);
-    JsonArray bestScores = doc["bestScores"].as<JsonArray>();
-    JsonFile.close(); // Cierra el archivo antes de entrar en el bucle
-    while (Iterador)
-    {
-        bestScores[Contador]["score"] = bestScores[Contador - 1]["score"];
-        bestScores[Contador]["name"] = bestScores[Contador - 1]["name"];
-        Contador--;
-        if (Contador < 1)
-            Iterador = false;
-    }
-
-    bestScores[0]["score"] = Puntaje;
-    bestScores[0]["name"] = Nombre;
-
-    // Guardar los cambios en el archivo JSON
-    JsonFile = SD.open("/GameData.json", FILE_WRITE);
-    if (!JsonFile)
+    uint32_t lugar = 0;
+    if (!marcador.Insertar(Puntaje, Nombre, &lugar))
     {
-        Serial.println("Error opening Scores for writing");
-        return;
+        BITACORA(MSG_SCORE_ERROR);
+        return 0;
     }
-    // Sobreescribir el archivo con los nuevos datos
-    serializeJson(doc, JsonFile);
-    JsonFile.close();
+    return lugar;
 }
 
 #endif
\ No newline at end of file
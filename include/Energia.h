@@ -0,0 +1,163 @@
+#ifndef Energia_h
+#define Energia_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Entrada.h"
+#include "Telemetria.h"
+#include "ModeloEnergia.h"
+
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/uart.h>
+#endif
+
+/*
+ * Gobernador de energía.
+ * En los estados no interactivos (intro, menús, scores, pausa) baja la frecuencia
+ * del CPU cuando el jugador deja de usar los controles y, más tarde, alarga el
+ * periodo de muestreo de la entrada y permite el sueño ligero automático. Cualquier
+ * evento de la entrada regresa de inmediato al nivel activo. La decisión y la
+ * contabilidad de tiempos están en ModeloEnergia; esta clase sólo las aplica.
+ *
+ * El sueño ligero automático necesita un núcleo compilado con CONFIG_PM_ENABLE y
+ * CONFIG_FREERTOS_USE_TICKLESS_IDLE; sin ellos ENERGIA_SUENO sólo reduce la
+ * frecuencia y el muestreo.
+ */
+
+#define ENERGIA_MHZ_ACTIVO 240
+#define ENERGIA_MHZ_AHORRO 80
+#define ENERGIA_MHZ_MINIMO 40         // Frecuencia del cristal, entre despertares
+#define ENERGIA_MUESTREO_SUENO 50     // ms entre muestras de la entrada en ENERGIA_SUENO
+#define ENERGIA_PERIODO_REVISION 1000 // ms máximos entre revisiones del estado del juego
+
+// Devuelve true si el juego necesita el nivel activo (partida en curso, control remoto...)
+typedef bool (*ConsultaInteractivo)(void);
+
+class GobernadorEnergia
+{
+public:
+    GobernadorEnergia(Entrada *entrada, Telemetria *telemetria, ConsultaInteractivo interactivo);
+
+    // sub: suscripción a los eventos PRESIONAR de todos los controles
+    void Iniciar(SuscripcionEntrada sub, UBaseType_t prioridad, BaseType_t nucleo);
+
+    NivelEnergia Nivel(void);
+    uint32_t TiempoEn(NivelEnergia nivel);
+    uint32_t ConsumoPromedio(void);
+
+private:
+    Entrada *entrada;
+    Telemetria *telemetria;
+    ConsultaInteractivo interactivo;
+    SuscripcionEntrada sub;
+    ModeloEnergia modelo;
+    portMUX_TYPE candado;
+
+    void Aplicar(NivelEnergia nivel);
+    static void TareaGobernador(void *pvParameters);
+};
+
+// Desarrollo de métodos
+
+GobernadorEnergia::GobernadorEnergia(Entrada *entrada, Telemetria *telemetria, ConsultaInteractivo interactivo)
+{
+    this->entrada = entrada;
+    this->telemetria = telemetria;
+    this->interactivo = interactivo;
+    sub = -1;
+    portMUX_INITIALIZE(&candado);
+}
+
+void GobernadorEnergia::Iniciar(SuscripcionEntrada sub, UBaseType_t prioridad, BaseType_t nucleo)
+{
+    this->sub = sub;
+    modelo.Reiniciar(millis());
+
+#if CONFIG_PM_ENABLE
+    // Que un byte del control remoto despierte al CPU del sueño ligero
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+#endif
+    Aplicar(ENERGIA_ACTIVO);
+
+    xTaskCreatePinnedToCore(
+        TareaGobernador,
+        "Energia",
+        2048,
+        this,
+        prioridad,
+        NULL,
+        nucleo);
+}
+
+NivelEnergia GobernadorEnergia::Nivel(void)
+{
+    return modelo.Nivel();
+}
+
+uint32_t GobernadorEnergia::TiempoEn(NivelEnergia nivel)
+{
+    portENTER_CRITICAL(&candado);
+    uint32_t tiempo = modelo.TiempoEn(nivel, millis());
+    portEXIT_CRITICAL(&candado);
+    return tiempo;
+}
+
+uint32_t GobernadorEnergia::ConsumoPromedio(void)
+{
+    portENTER_CRITICAL(&candado);
+    uint32_t consumo = modelo.ConsumoPromedio(millis());
+    portEXIT_CRITICAL(&candado);
+    return consumo;
+}
+
+void GobernadorEnergia::Aplicar(NivelEnergia nivel)
+{
+    uint32_t mhz = (nivel == ENERGIA_ACTIVO) ? ENERGIA_MHZ_ACTIVO : ENERGIA_MHZ_AHORRO;
+
+#if CONFIG_PM_ENABLE
+    // Con el administrador de energía activo la frecuencia se fija por medio de él
+    esp_pm_config_esp32_t config;
+    config.max_freq_mhz = mhz;
+    config.min_freq_mhz = (nivel == ENERGIA_SUENO) ? ENERGIA_MHZ_MINIMO : mhz;
+    config.light_sleep_enable = (nivel == ENERGIA_SUENO);
+    esp_pm_configure(&config);
+#else
+    setCpuFrequencyMhz(mhz);
+#endif
+
+    entrada->ConfigurarMuestreo((nivel == ENERGIA_SUENO) ? ENERGIA_MUESTREO_SUENO : ENTRADA_PERIODO_MUESTREO);
+}
+
+// Duerme hasta un evento de entrada o hasta el siguiente cambio de nivel por inactividad
+void GobernadorEnergia::TareaGobernador(void *pvParameters)
+{
+    GobernadorEnergia *g = (GobernadorEnergia *)pvParameters;
+    EventoEntrada evento;
+
+    while (true)
+    {
+        uint32_t espera = g->modelo.ProximoCambio(g->interactivo(), millis());
+        if (espera > ENERGIA_PERIODO_REVISION)
+            espera = ENERGIA_PERIODO_REVISION;
+
+        bool actividad = g->entrada->Esperar(g->sub, &evento, pdMS_TO_TICKS(espera) + 1);
+        bool interactivo = g->interactivo();
+
+        portENTER_CRITICAL(&g->candado);
+        bool cambio = actividad ? g->modelo.Actividad(interactivo, millis())
+                                : g->modelo.Actualizar(interactivo, millis());
+        portEXIT_CRITICAL(&g->candado);
+
+        if (cambio)
+        {
+            g->Aplicar(g->modelo.Nivel());
+            g->telemetria->Energia(g->modelo.Nivel(), g->modelo.NivelAnterior(), g->modelo.DuracionAnterior());
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,356 @@
+#ifndef Entrada_h
+#define Entrada_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+/*
+ * Capa de entrada semántica.
+ * Una tarea muestrea el joystick y los botones, elimina rebotes y convierte las
+ * muestras crudas en eventos (presionar, soltar, repetir y mantener). Cada
+ * consumidor (menús, selector de nombre, juego, pausa) se suscribe con su propia
+ * cola y se bloquea en ella hasta que llega un evento.
+ */
+
+// Umbrales del joystick para considerar una dirección como activa
+#define ENTRADA_UMBRAL_ALTO 4000
+#define ENTRADA_UMBRAL_BAJO 1000
+
+// Configuración por defecto (milisegundos)
+#define ENTRADA_PERIODO_MUESTREO 5
+#define ENTRADA_TIEMPO_REBOTE 20
+#define ENTRADA_RETARDO_INICIAL 400
+#define ENTRADA_REPETICION_INICIAL 200
+#define ENTRADA_REPETICION_MINIMA 40
+#define ENTRADA_ACELERACION 80 // Porcentaje del intervalo anterior en cada repetición
+#define ENTRADA_TIEMPO_MANTENER 1000
+
+// Límites de suscriptores y tamaño de sus colas
+#define ENTRADA_MAX_SUSCRIPTORES 6
+#define ENTRADA_TAM_COLA 8
+
+// Controles físicos que genera la capa
+enum ControlEntrada
+{
+    CONTROL_ARRIBA,
+    CONTROL_ABAJO,
+    CONTROL_IZQUIERDA,
+    CONTROL_DERECHA,
+    CONTROL_ENTER,
+    CONTROL_EXIT,
+    NUM_CONTROLES
+};
+
+// Tipos de evento
+enum TipoEvento
+{
+    EVENTO_PRESIONAR,
+    EVENTO_SOLTAR,
+    EVENTO_REPETIR,
+    EVENTO_MANTENER
+};
+
+// Máscaras para las suscripciones
+#define MASCARA_CONTROL(c) (1 << (c))
+#define MASCARA_TIPO(t) (1 << (t))
+#define MASCARA_DIRECCIONES (MASCARA_CONTROL(CONTROL_ARRIBA) | MASCARA_CONTROL(CONTROL_ABAJO) | MASCARA_CONTROL(CONTROL_IZQUIERDA) | MASCARA_CONTROL(CONTROL_DERECHA))
+#define MASCARA_BOTONES (MASCARA_CONTROL(CONTROL_ENTER) | MASCARA_CONTROL(CONTROL_EXIT))
+#define MASCARA_TODOS_CONTROLES (MASCARA_DIRECCIONES | MASCARA_BOTONES)
+#define MASCARA_PULSACIONES (MASCARA_TIPO(EVENTO_PRESIONAR) | MASCARA_TIPO(EVENTO_REPETIR))
+#define MASCARA_TODOS_TIPOS 0x0F
+
+struct EventoEntrada
+{
+    uint8_t control;       // ControlEntrada
+    uint8_t tipo;          // TipoEvento
+    uint16_t repeticiones; // Número de repeticiones desde que se presionó
+    unsigned long tiempo;  // millis() de la muestra que generó el evento
+    // micros() de la primera muestra cruda del cambio y de la publicación (trazas de latencia)
+    uint32_t muestraUs;
+    uint32_t publicadoUs;
+};
+
+// Identificador de suscripción
+typedef int8_t SuscripcionEntrada;
+
+class Entrada
+{
+public:
+    Entrada(uint8_t pinX, uint8_t pinY, uint8_t pinEnter, uint8_t pinExit);
+
+    void Iniciar(UBaseType_t prioridad, BaseType_t nucleo);
+
+    // Configuración del autorepetido
+    void ConfigurarRepeticion(uint16_t retardoInicial, uint16_t intervaloInicial, uint16_t intervaloMinimo, uint8_t aceleracion);
+
+    // Periodo de muestreo en ms (el gobernador de energía lo alarga en reposo)
+    void ConfigurarMuestreo(uint16_t periodo);
+
+    // Suscripciones
+    SuscripcionEntrada Suscribir(uint8_t mascaraControles, uint8_t mascaraTipos);
+    void Activar(SuscripcionEntrada sub, bool activa);
+    bool Esperar(SuscripcionEntrada sub, EventoEntrada *evento, TickType_t espera);
+    void Vaciar(SuscripcionEntrada sub);
+
+    // Estado filtrado (sin rebotes) de un control
+    bool Presionado(ControlEntrada control);
+
+    // Procesa una muestra cruda; la tarea la llama en cada periodo. 'ahoraUs' es el
+    // micros() en que se leyeron los pines
+    void ProcesarMuestra(int x, int y, bool enter, bool exit, unsigned long ahora, uint32_t ahoraUs = 0);
+
+    // Sustituye la lectura de los pines por valores externos (control remoto)
+    void Inyectar(int x, int y, bool enter, bool exit);
+    void LiberarInyeccion(void);
+    bool InyeccionActiva(void);
+
+private:
+    struct EstadoControl
+    {
+        bool crudo;
+        bool filtrado;
+        unsigned long cambioCrudo;
+        uint32_t cambioCrudoUs;
+        unsigned long inicioPresion;
+        unsigned long siguienteRepeticion;
+        uint16_t intervalo;
+        uint16_t repeticiones;
+        bool mantenidoEnviado;
+    };
+
+    struct Suscriptor
+    {
+        QueueHandle_t cola;
+        uint8_t mascaraControles;
+        uint8_t mascaraTipos;
+        bool activa;
+    };
+
+    uint8_t pinX, pinY, pinEnter, pinExit;
+    uint16_t retardoInicial, intervaloInicial, intervaloMinimo;
+    uint8_t aceleracion;
+    volatile uint16_t periodoMuestreo;
+    EstadoControl controles[NUM_CONTROLES];
+    uint32_t muestraUs; // Muestra en proceso
+    Suscriptor suscriptores[ENTRADA_MAX_SUSCRIPTORES];
+    uint8_t numSuscriptores;
+
+    // Valores inyectados; se leen desde la tarea de muestreo
+    volatile bool inyeccionActiva;
+    volatile int xInyectado, yInyectado;
+    volatile bool enterInyectado, exitInyectado;
+
+    void ActualizarControl(uint8_t control, bool crudo, unsigned long ahora);
+    void Publicar(uint8_t control, uint8_t tipo, uint16_t repeticiones, unsigned long ahora, uint32_t origenUs);
+    static void TareaMuestreo(void *pvParameters);
+};
+
+// Desarrollo de métodos
+
+Entrada::Entrada(uint8_t pinX, uint8_t pinY, uint8_t pinEnter, uint8_t pinExit)
+{
+    this->pinX = pinX;
+    this->pinY = pinY;
+    this->pinEnter = pinEnter;
+    this->pinExit = pinExit;
+    numSuscriptores = 0;
+    inyeccionActiva = false;
+    periodoMuestreo = ENTRADA_PERIODO_MUESTREO;
+    memset(controles, 0, sizeof(controles));
+    muestraUs = 0;
+    ConfigurarRepeticion(ENTRADA_RETARDO_INICIAL, ENTRADA_REPETICION_INICIAL, ENTRADA_REPETICION_MINIMA, ENTRADA_ACELERACION);
+}
+
+void Entrada::Iniciar(UBaseType_t prioridad, BaseType_t nucleo)
+{
+    xTaskCreatePinnedToCore(
+        TareaMuestreo,
+        "Entrada",
+        2048,
+        this,
+        prioridad,
+        NULL,
+        nucleo);
+}
+
+void Entrada::ConfigurarRepeticion(uint16_t retardoInicial, uint16_t intervaloInicial, uint16_t intervaloMinimo, uint8_t aceleracion)
+{
+    this->retardoInicial = retardoInicial;
+    this->intervaloInicial = intervaloInicial;
+    this->intervaloMinimo = intervaloMinimo;
+    this->aceleracion = aceleracion;
+}
+
+void Entrada::ConfigurarMuestreo(uint16_t periodo)
+{
+    periodoMuestreo = periodo;
+}
+
+// Registra un consumidor; las suscripciones deben crearse antes de arrancar las tareas
+SuscripcionEntrada Entrada::Suscribir(uint8_t mascaraControles, uint8_t mascaraTipos)
+{
+    if (numSuscriptores >= ENTRADA_MAX_SUSCRIPTORES)
+        return -1;
+
+    Suscriptor &s = suscriptores[numSuscriptores];
+    s.cola = xQueueCreate(ENTRADA_TAM_COLA, sizeof(EventoEntrada));
+    s.mascaraControles = mascaraControles;
+    s.mascaraTipos = mascaraTipos;
+    s.activa = true;
+    return numSuscriptores++;
+}
+
+void Entrada::Activar(SuscripcionEntrada sub, bool activa)
+{
+    suscriptores[sub].activa = activa;
+    if (!activa)
+        xQueueReset(suscriptores[sub].cola);
+}
+
+// Bloquea al consumidor hasta recibir un evento o agotar la espera
+bool Entrada::Esperar(SuscripcionEntrada sub, EventoEntrada *evento, TickType_t espera)
+{
+    return xQueueReceive(suscriptores[sub].cola, evento, espera) == pdTRUE;
+}
+
+// Descarta eventos viejos (por ejemplo, al entrar a un menú)
+void Entrada::Vaciar(SuscripcionEntrada sub)
+{
+    xQueueReset(suscriptores[sub].cola);
+}
+
+bool Entrada::Presionado(ControlEntrada control)
+{
+    return controles[control].filtrado;
+}
+
+void Entrada::ProcesarMuestra(int x, int y, bool enter, bool exit, unsigned long ahora, uint32_t ahoraUs)
+{
+    muestraUs = ahoraUs;
+    ActualizarControl(CONTROL_ARRIBA, y >= ENTRADA_UMBRAL_ALTO, ahora);
+    ActualizarControl(CONTROL_ABAJO, y < ENTRADA_UMBRAL_BAJO, ahora);
+    ActualizarControl(CONTROL_DERECHA, x >= ENTRADA_UMBRAL_ALTO, ahora);
+    ActualizarControl(CONTROL_IZQUIERDA, x < ENTRADA_UMBRAL_BAJO, ahora);
+    ActualizarControl(CONTROL_ENTER, enter, ahora);
+    ActualizarControl(CONTROL_EXIT, exit, ahora);
+}
+
+void Entrada::ActualizarControl(uint8_t control, bool crudo, unsigned long ahora)
+{
+    EstadoControl &c = controles[control];
+
+    // Antirrebote: el valor crudo debe mantenerse estable ENTRADA_TIEMPO_REBOTE ms
+    if (crudo != c.crudo)
+    {
+        c.crudo = crudo;
+        c.cambioCrudo = ahora;
+        c.cambioCrudoUs = muestraUs;
+    }
+
+    if (c.crudo != c.filtrado && ahora - c.cambioCrudo >= ENTRADA_TIEMPO_REBOTE)
+    {
+        c.filtrado = c.crudo;
+        if (c.filtrado)
+        {
+            c.inicioPresion = ahora;
+            c.siguienteRepeticion = ahora + retardoInicial;
+            c.intervalo = intervaloInicial;
+            c.repeticiones = 0;
+            c.mantenidoEnviado = false;
+            Publicar(control, EVENTO_PRESIONAR, 0, ahora, c.cambioCrudoUs);
+        }
+        else
+        {
+            Publicar(control, EVENTO_SOLTAR, c.repeticiones, ahora, c.cambioCrudoUs);
+        }
+        return;
+    }
+
+    if (!c.filtrado)
+        return;
+
+    // Autorepetido con intervalo que se acelera hasta el mínimo
+    if ((long)(ahora - c.siguienteRepeticion) >= 0)
+    {
+        c.repeticiones++;
+        Publicar(control, EVENTO_REPETIR, c.repeticiones, ahora, muestraUs);
+        c.siguienteRepeticion = ahora + c.intervalo;
+        uint16_t siguiente = (uint32_t)c.intervalo * aceleracion / 100;
+        c.intervalo = (siguiente > intervaloMinimo) ? siguiente : intervaloMinimo;
+    }
+
+    if (!c.mantenidoEnviado && ahora - c.inicioPresion >= ENTRADA_TIEMPO_MANTENER)
+    {
+        c.mantenidoEnviado = true;
+        Publicar(control, EVENTO_MANTENER, c.repeticiones, ahora, muestraUs);
+    }
+}
+
+void Entrada::Inyectar(int x, int y, bool enter, bool exit)
+{
+    xInyectado = x;
+    yInyectado = y;
+    enterInyectado = enter;
+    exitInyectado = exit;
+    inyeccionActiva = true;
+}
+
+void Entrada::LiberarInyeccion(void)
+{
+    inyeccionActiva = false;
+}
+
+bool Entrada::InyeccionActiva(void)
+{
+    return inyeccionActiva;
+}
+
+// Entrega el evento a cada suscriptor interesado; si su cola está llena se descarta
+void Entrada::Publicar(uint8_t control, uint8_t tipo, uint16_t repeticiones, unsigned long ahora, uint32_t origenUs)
+{
+    EventoEntrada evento = {control, tipo, repeticiones, ahora, origenUs, (uint32_t)micros()};
+
+    for (uint8_t i = 0; i < numSuscriptores; i++)
+    {
+        Suscriptor &s = suscriptores[i];
+        if (s.activa && (s.mascaraControles & MASCARA_CONTROL(control)) && (s.mascaraTipos & MASCARA_TIPO(tipo)))
+            xQueueSend(s.cola, &evento, 0);
+    }
+}
+
+// Tarea que muestrea los pines periódicamente
+void Entrada::TareaMuestreo(void *pvParameters)
+{
+    Entrada *entrada = (Entrada *)pvParameters;
+    TickType_t ultimoDespertar = xTaskGetTickCount();
+
+    while (true)
+    {
+        int x, y;
+        bool enter, exit;
+        uint32_t muestraUs = micros();
+
+        if (entrada->inyeccionActiva)
+        {
+            x = entrada->xInyectado;
+            y = entrada->yInyectado;
+            enter = entrada->enterInyectado;
+            exit = entrada->exitInyectado;
+        }
+        else
+        {
+            x = analogRead(entrada->pinX);
+            y = analogRead(entrada->pinY);
+            // Los botones usan pull-up: LOW significa presionado
+            enter = !digitalRead(entrada->pinEnter);
+            exit = !digitalRead(entrada->pinExit);
+        }
+
+        entrada->ProcesarMuestra(x, y, enter, exit, millis(), muestraUs);
+        vTaskDelayUntil(&ultimoDespertar, entrada->periodoMuestreo / portTICK_PERIOD_MS);
+    }
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef Formato_h
+#define Formato_h
+
+#include <Arduino.h>
+
+/*
+ * Campos de texto de ancho fijo para la pantalla.
+ * Un CampoLCD<COLUMNA, ANCHO> ocupa siempre ANCHO celdas desde COLUMNA: los enteros
+ * se alinean a la derecha y se rellenan con espacios, y los textos se alinean a la
+ * izquierda y se recortan. Así, cuando un valor pierde dígitos (10 -> 9), el campo
+ * borra las celdas que ya no usa. Se formatea en un búfer en la pila, sin printf ni
+ * memoria dinámica.
+ * El campo escribe su ancho completo en el cuadro; sólo las celdas que cambiaron
+ * respecto a lo que muestra la LCD viajan por I2C (lo decide el Renderizador).
+ * Un entero que no cabe se satura a nueves ("99" en un campo de dos).
+ */
+
+#define FORMATO_MAX_ANCHO 11 // "-2147483648"
+
+// Escribe exactamente 'ancho' caracteres en destino (sin terminador)
+void FormatearEntero(char *destino, uint8_t ancho, int32_t valor);
+void FormatearTexto(char *destino, uint8_t ancho, const char *texto);
+
+template <uint8_t COLUMNA, uint8_t ANCHO>
+struct CampoLCD
+{
+    static constexpr uint8_t columna = COLUMNA;
+    static constexpr uint8_t ancho = ANCHO;
+    static_assert(ANCHO > 0 && ANCHO <= FORMATO_MAX_ANCHO, "Ancho de campo no soportado");
+
+    // P: cualquier destino con setCursor() y write() (Renderizador, PantallaLCD)
+    template <typename P>
+    static void Entero(P &pantalla, uint8_t fila, int32_t valor);
+    template <typename P>
+    static void Texto(P &pantalla, uint8_t fila, const char *texto);
+};
+
+// Desarrollo de métodos
+
+void FormatearEntero(char *destino, uint8_t ancho, int32_t valor)
+{
+    bool negativo = valor < 0;
+    uint32_t magnitud = negativo ? 0u - (uint32_t)valor : (uint32_t)valor;
+    uint8_t digitosDisponibles = negativo ? ancho - 1 : ancho;
+
+    // Dígitos de derecha a izquierda
+    int8_t i = ancho - 1;
+    uint8_t digitos = 0;
+    do
+    {
+        if (digitos == digitosDisponibles)
+        {
+            // No cabe: saturar al mayor valor que se puede mostrar
+            for (i = negativo ? 1 : 0; i < ancho; i++)
+                destino[i] = '9';
+            if (negativo)
+                destino[0] = '-';
+            return;
+        }
+        destino[i--] = '0' + magnitud % 10;
+        magnitud /= 10;
+        digitos++;
+    } while (magnitud != 0);
+
+    if (negativo)
+        destino[i--] = '-';
+    while (i >= 0)
+        destino[i--] = ' ';
+}
+
+void FormatearTexto(char *destino, uint8_t ancho, const char *texto)
+{
+    uint8_t i = 0;
+    for (; i < ancho && texto[i] != '\0'; i++)
+        destino[i] = texto[i];
+    for (; i < ancho; i++)
+        destino[i] = ' ';
+}
+
+template <uint8_t COLUMNA, uint8_t ANCHO>
+template <typename P>
+void CampoLCD<COLUMNA, ANCHO>::Entero(P &pantalla, uint8_t fila, int32_t valor)
+{
+    char texto[ANCHO];
+    FormatearEntero(texto, ANCHO, valor);
+    pantalla.setCursor(COLUMNA, fila);
+    pantalla.write((const uint8_t *)texto, ANCHO);
+}
+
+template <uint8_t COLUMNA, uint8_t ANCHO>
+template <typename P>
+void CampoLCD<COLUMNA, ANCHO>::Texto(P &pantalla, uint8_t fila, const char *texto)
+{
+    char celdas[ANCHO];
+    FormatearTexto(celdas, ANCHO, texto);
+    pantalla.setCursor(COLUMNA, fila);
+    pantalla.write((const uint8_t *)celdas, ANCHO);
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef Geometria_h
+#define Geometria_h
+
+#include <stdint.h>
+
+/*
+ * Geometría de la pantalla en tiempo de compilación.
+ * Geometria<COLUMNAS, FILAS> calcula con constexpr el campo de juego (donde se mueven
+ * el personaje y el diamante) y la posición del HUD (tiempo y puntaje). Los paneles
+ * conocidos tienen su propia especialización; cualquier otro tamaño usa el cálculo
+ * genérico. El juego usa GeometriaJuego, que se elige con una bandera de compilación
+ * (PANTALLA_20X4 o PANTALLA_40X4; sin bandera, 16x2), así que los límites son
+ * constantes y no cuestan nada en tiempo de ejecución.
+ */
+
+// Disposición genérica: HUD de 3 dígitos a la derecha, separado del campo por una columna
+template <uint8_t COLUMNAS, uint8_t FILAS>
+struct Geometria
+{
+    static constexpr uint8_t columnas = COLUMNAS;
+    static constexpr uint8_t filas = FILAS;
+
+    static constexpr uint8_t hudAncho = 3;
+    static constexpr bool hudSeparador = true;  // Columna '|' entre el campo y el HUD
+    static constexpr bool hudEtiquetas = false; // Rótulos sobre cada valor
+    static constexpr uint8_t campoAncho = COLUMNAS - hudAncho - 1;
+    static constexpr uint8_t campoAlto = FILAS;
+    static constexpr uint8_t hudColumna = campoAncho + 1;
+    static constexpr uint8_t hudFilaTiempo = 0;
+    static constexpr uint8_t hudFilaPuntaje = 1;
+};
+
+// LCD original: el HUD ocupa las tres últimas columnas, sin separador (con dos, un
+// puntaje de 100 se mostraba como "99")
+template <>
+struct Geometria<16, 2>
+{
+    static constexpr uint8_t columnas = 16;
+    static constexpr uint8_t filas = 2;
+
+    static constexpr uint8_t hudAncho = 3;
+    static constexpr bool hudSeparador = false;
+    static constexpr bool hudEtiquetas = false;
+    static constexpr uint8_t campoAncho = 13;
+    static constexpr uint8_t campoAlto = 2;
+    static constexpr uint8_t hudColumna = 13;
+    static constexpr uint8_t hudFilaTiempo = 0;
+    static constexpr uint8_t hudFilaPuntaje = 1;
+};
+
+// 20x4: campo de 16x4 y HUD de 3 dígitos tras el separador
+template <>
+struct Geometria<20, 4>
+{
+    static constexpr uint8_t columnas = 20;
+    static constexpr uint8_t filas = 4;
+
+    static constexpr uint8_t hudAncho = 3;
+    static constexpr bool hudSeparador = true;
+    static constexpr bool hudEtiquetas = false;
+    static constexpr uint8_t campoAncho = 16;
+    static constexpr uint8_t campoAlto = 4;
+    static constexpr uint8_t hudColumna = 17;
+    static constexpr uint8_t hudFilaTiempo = 0;
+    static constexpr uint8_t hudFilaPuntaje = 2;
+};
+
+// 40x4: sobra espacio para rotular los valores (rótulo en una fila, valor en la siguiente)
+template <>
+struct Geometria<40, 4>
+{
+    static constexpr uint8_t columnas = 40;
+    static constexpr uint8_t filas = 4;
+
+    static constexpr uint8_t hudAncho = 7;
+    static constexpr bool hudSeparador = true;
+    static constexpr bool hudEtiquetas = true;
+    static constexpr uint8_t campoAncho = 32;
+    static constexpr uint8_t campoAlto = 4;
+    static constexpr uint8_t hudColumna = 33;
+    static constexpr uint8_t hudFilaTiempo = 0;
+    static constexpr uint8_t hudFilaPuntaje = 2;
+};
+
+// Límites derivados, válidos para cualquier especialización
+template <typename G>
+struct Disposicion
+{
+    static constexpr uint8_t maxX = G::campoAncho - 1;
+    static constexpr uint8_t maxY = G::campoAlto - 1;
+    static constexpr uint8_t columnaSeparador = G::campoAncho;
+    // Columna para centrar un texto o un dibujo de 'ancho' celdas
+    static constexpr uint8_t Centrar(uint8_t ancho) { return (ancho >= G::columnas) ? 0 : (G::columnas - ancho) / 2; }
+
+    static_assert(G::campoAncho > 0 && G::campoAlto > 0, "El campo de juego no puede estar vacío");
+    static_assert(G::campoAncho + (G::hudSeparador ? 1 : 0) <= G::hudColumna, "El HUD se encima con el campo");
+    static_assert(G::hudColumna + G::hudAncho <= G::columnas, "El HUD no cabe en la pantalla");
+    static_assert(G::hudFilaTiempo + (G::hudEtiquetas ? 1 : 0) < G::filas &&
+                      G::hudFilaPuntaje + (G::hudEtiquetas ? 1 : 0) < G::filas,
+                  "El HUD no cabe en las filas de la pantalla");
+};
+
+#if defined(PANTALLA_40X4)
+typedef Geometria<40, 4> GeometriaJuego;
+#elif defined(PANTALLA_20X4)
+typedef Geometria<20, 4> GeometriaJuego;
+#else
+typedef Geometria<16, 2> GeometriaJuego;
+#endif
+typedef Disposicion<GeometriaJuego> DisposicionJuego;
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef Glifos_h
+#define Glifos_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Compilador de glifos en tiempo de compilación.
+ * Los caracteres personalizados se escriben como arte ASCII ('#' encendido, '.' o
+ * ' ' apagado), una cadena por fila concatenada en una sola literal. CompilarGlifo
+ * convierte un carácter de 5x8 y CompilarSprite un dibujo de varias celdas, que se
+ * parte en mosaicos de 5x8 en orden de lectura (fila por fila, de izquierda a
+ * derecha). Las medidas se verifican con static_assert y un carácter desconocido
+ * detiene la compilación. Declarados constexpr a nivel global, los bytes quedan en
+ * la flash (.rodata) y nunca se arman en tiempo de ejecución.
+ */
+
+#define GLIFO_ANCHO 5   // Pixeles por celda del HD44780
+#define GLIFO_ALTO 8
+#define GLIFOS_CGRAM 8  // Caracteres personalizados que caben en la CGRAM
+
+struct Glifo
+{
+    uint8_t filas[GLIFO_ALTO]; // Bit 4 = columna izquierda
+};
+
+template <size_t ANCHO, size_t ALTO>
+struct Sprite
+{
+    static constexpr size_t ancho = ANCHO; // En celdas
+    static constexpr size_t alto = ALTO;
+    static constexpr size_t celdas = ANCHO * ALTO;
+    Glifo mosaicos[ANCHO * ALTO];
+};
+
+// Sin definición a propósito: si la evaluación constexpr llega aquí la compilación falla
+void ArteConPixelInvalido(void);
+
+constexpr bool PixelEncendido(char c)
+{
+    if (c == '#')
+        return true;
+    if (c != '.' && c != ' ')
+        ArteConPixelInvalido(); // Sólo se admiten '#', '.' y ' '
+    return false;
+}
+
+template <size_t ANCHO, size_t ALTO, size_t N>
+constexpr Sprite<ANCHO, ALTO> CompilarSprite(const char (&arte)[N])
+{
+    static_assert(ANCHO > 0 && ALTO > 0, "El sprite necesita al menos una celda");
+    static_assert(ANCHO * ALTO <= GLIFOS_CGRAM, "El sprite no cabe en la CGRAM");
+    static_assert(N - 1 == ANCHO * GLIFO_ANCHO * ALTO * GLIFO_ALTO, "El arte debe medir ANCHO*5 x ALTO*8 pixeles");
+
+    Sprite<ANCHO, ALTO> sprite{};
+    for (size_t y = 0; y < ALTO * GLIFO_ALTO; y++)
+    {
+        for (size_t x = 0; x < ANCHO * GLIFO_ANCHO; x++)
+        {
+            if (PixelEncendido(arte[y * ANCHO * GLIFO_ANCHO + x]))
+            {
+                Glifo &mosaico = sprite.mosaicos[(y / GLIFO_ALTO) * ANCHO + x / GLIFO_ANCHO];
+                mosaico.filas[y % GLIFO_ALTO] |= 1 << (GLIFO_ANCHO - 1 - x % GLIFO_ANCHO);
+            }
+        }
+    }
+    return sprite;
+}
+
+template <size_t N>
+constexpr Glifo CompilarGlifo(const char (&arte)[N])
+{
+    return CompilarSprite<1, 1>(arte).mosaicos[0];
+}
+
+#endif
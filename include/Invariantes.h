@@ -0,0 +1,59 @@
+#ifndef Invariantes_h
+#define Invariantes_h
+
+#include <Arduino.h>
+#include "Bitacora.h"
+
+/*
+ * Verificación de invariantes del juego en tiempo de ejecución.
+ * Sólo se compila con -DVERIFICAR_INVARIANTES (entorno esp32dev-soak); sin la
+ * bandera VERIFICAR() no genera código. Las violaciones se cuentan, se reportan por
+ * la bitácora y se consultan con el comando REMOTO_INVARIANTES (tools/soak.py). No se
+ * escribe directo en Serial: VERIFICAR() corre en rutas calientes y el texto se
+ * mezclaría con las tramas de ControlRemoto en la misma UART.
+ */
+
+enum Invariante
+{
+    INV_NINGUNA,
+    INV_PUNTAJE_DECRECE,    // El puntaje bajó durante una partida
+    INV_ESTADO_PERDIDO,     // Se intentó encolar un estado con otro pendiente
+    INV_INDICE_NIVEL,       // Nivel fuera del arreglo de niveles
+    INV_POSICION_PERSONAJE, // Personaje fuera de la pantalla
+    INV_POSICION_NOMBRE     // Cursor o letra del selector de nombre fuera de rango
+};
+
+struct RegistroInvariantes
+{
+    volatile uint16_t violaciones;
+    volatile uint8_t ultima;  // Invariante
+    volatile uint16_t linea;  // Línea del código donde falló
+    volatile uint32_t tiempo; // millis() de la última violación
+};
+
+RegistroInvariantes invariantes = {0, INV_NINGUNA, 0, 0};
+
+void ReportarInvariante(Invariante id, uint16_t linea)
+{
+    invariantes.violaciones++;
+    invariantes.ultima = id;
+    invariantes.linea = linea;
+    invariantes.tiempo = millis();
+    BITACORA(MSG_INVARIANTE, id, linea);
+}
+
+#ifdef VERIFICAR_INVARIANTES
+#define VERIFICAR(condicion, id)                \
+    do                                          \
+    {                                           \
+        if (!(condicion))                       \
+            ReportarInvariante((id), __LINE__); \
+    } while (0)
+#else
+#define VERIFICAR(condicion, id) \
+    do                           \
+    {                            \
+    } while (0)
+#endif
+
+#endif
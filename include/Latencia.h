@@ -0,0 +1,283 @@
+#ifndef Latencia_h
+#define Latencia_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+/*
+ * Trazas de latencia de la entrada a la pantalla.
+ * Cada evento del joystick lleva el micros() de la primera muestra cruda que lo
+ * originó y el de su publicación (Entrada.h). Cuando la lógica consume el primer
+ * evento de un cuadro abre una traza y la etiqueta en el Renderizador, que le pone
+ * la hora en que Presentar entrega el cuadro; la tarea de render la cierra al terminar de enviar ese cuadro
+ * (o el que lo reemplazó) por I2C. Cada traza cerrada suma a un histograma por
+ * etapa y se guarda en un anillo de trazas crudas.
+ *
+ * Etapas: rebote (muestra cruda -> evento), espera (evento -> lo toma la lógica, la
+ * compuerta de 100 ms), actualización (-> Presentar), cola de render (-> empieza el
+ * envío), envío I2C y el total. Los histogramas son log-lineales: exactos hasta
+ * 16 us y con 4 divisiones por potencia de dos después (error < 25 %).
+ *
+ * Sólo se instancia con -DTRAZAR_LATENCIA (entorno esp32dev-latencia). Volcar()
+ * imprime "LAT..." por Serial; tools/latencia.py reconstruye los mismos histogramas
+ * a partir de las trazas crudas.
+ */
+
+#define LATENCIA_CUBETAS 128
+#define LATENCIA_EN_VUELO 8     // Trazas abiertas a la vez (potencia de dos)
+#define LATENCIA_REGISTRO 128   // Trazas crudas que se conservan para el volcado
+
+enum EtapaLatencia
+{
+    ETAPA_REBOTE,
+    ETAPA_ESPERA,
+    ETAPA_ACTUALIZACION,
+    ETAPA_COLA_RENDER,
+    ETAPA_ENVIO,
+    ETAPA_TOTAL,
+    NUM_ETAPAS
+};
+
+static const char *nombresEtapas[NUM_ETAPAS] = {"rebote", "espera", "actualizacion", "cola_render", "envio", "total"};
+
+// Marcas de tiempo (micros) de una traza
+struct TrazaLatencia
+{
+    uint32_t muestra;    // Primera muestra cruda del cambio
+    uint32_t publicado;  // Evento entregado a las colas
+    uint32_t consumido;  // La lógica tomó el evento
+    uint32_t presentado; // Cuadro entregado al Renderizador
+    uint32_t envio;      // La tarea de render empezó a enviarlo
+    uint32_t fin;        // Última escritura I2C del cuadro
+};
+
+class HistogramaLatencia
+{
+public:
+    HistogramaLatencia();
+
+    void Registrar(uint32_t us);
+    void Reiniciar(void);
+
+    uint32_t Cuenta(void);
+    uint32_t Minimo(void);
+    uint32_t Maximo(void);
+    uint32_t Percentil(uint8_t p); // Límite superior de la cubeta que contiene el percentil p
+    uint32_t Cubeta(uint8_t i);
+
+    static uint8_t Indice(uint32_t us);
+    static uint32_t LimiteSuperior(uint8_t indice);
+
+private:
+    uint32_t cubetas[LATENCIA_CUBETAS];
+    uint32_t cuenta, minimo, maximo;
+};
+
+class TrazadorLatencia
+{
+public:
+    TrazadorLatencia();
+
+    // Tarea de lógica: devuelve el identificador de la traza (nunca 0)
+    uint32_t Abrir(uint32_t muestraUs, uint32_t publicadoUs);
+
+    // Tarea de render: se registra con Renderizador::AlMostrar
+    static void CuadroMostrado(void *contexto, uint32_t traza, uint32_t presentadoUs, uint32_t envioUs, uint32_t finUs);
+
+    // Imprime histogramas y trazas crudas por Serial y empieza de cero
+    void Volcar(void);
+
+private:
+    TrazaLatencia enVuelo[LATENCIA_EN_VUELO];
+    uint32_t siguiente;
+    HistogramaLatencia histogramas[NUM_ETAPAS];
+    TrazaLatencia registro[LATENCIA_REGISTRO];
+    uint32_t abiertas;
+    uint32_t cerradas; // Total de trazas cerradas (el anillo guarda las últimas)
+    portMUX_TYPE candado;
+
+    // Copia que imprime Volcar, tomada bajo el candado (Cerrar corre en la tarea de render)
+    HistogramaLatencia copiaHistogramas[NUM_ETAPAS];
+    TrazaLatencia copiaRegistro[LATENCIA_REGISTRO];
+
+    void Cerrar(uint32_t traza, uint32_t presentadoUs, uint32_t envioUs, uint32_t finUs);
+};
+
+// Desarrollo de métodos
+
+HistogramaLatencia::HistogramaLatencia()
+{
+    Reiniciar();
+}
+
+void HistogramaLatencia::Reiniciar(void)
+{
+    memset(cubetas, 0, sizeof(cubetas));
+    cuenta = 0;
+    minimo = UINT32_MAX;
+    maximo = 0;
+}
+
+// 0..15 exactos; después 4 cubetas por cada potencia de dos
+uint8_t HistogramaLatencia::Indice(uint32_t us)
+{
+    if (us < 16)
+        return us;
+    uint8_t octava = 31 - __builtin_clz(us); // >= 4
+    return 16 + (octava - 4) * 4 + ((us >> (octava - 2)) & 3);
+}
+
+uint32_t HistogramaLatencia::LimiteSuperior(uint8_t indice)
+{
+    if (indice < 16)
+        return indice;
+    uint8_t octava = 4 + (indice - 16) / 4;
+    uint32_t sub = (indice - 16) % 4;
+    return (uint32_t)(((4ULL + sub + 1) << (octava - 2)) - 1);
+}
+
+void HistogramaLatencia::Registrar(uint32_t us)
+{
+    cubetas[Indice(us)]++;
+    cuenta++;
+    if (us < minimo)
+        minimo = us;
+    if (us > maximo)
+        maximo = us;
+}
+
+uint32_t HistogramaLatencia::Cuenta(void)
+{
+    return cuenta;
+}
+
+uint32_t HistogramaLatencia::Minimo(void)
+{
+    return cuenta ? minimo : 0;
+}
+
+uint32_t HistogramaLatencia::Maximo(void)
+{
+    return maximo;
+}
+
+uint32_t HistogramaLatencia::Percentil(uint8_t p)
+{
+    if (cuenta == 0)
+        return 0;
+    uint32_t objetivo = ((uint64_t)cuenta * p + 99) / 100; // Rango del percentil, 1..cuenta
+    if (objetivo == 0)
+        objetivo = 1;
+    uint32_t acumulado = 0;
+    for (uint8_t i = 0; i < LATENCIA_CUBETAS; i++)
+    {
+        acumulado += cubetas[i];
+        if (acumulado >= objetivo)
+            return (LimiteSuperior(i) < maximo) ? LimiteSuperior(i) : maximo;
+    }
+    return maximo;
+}
+
+uint32_t HistogramaLatencia::Cubeta(uint8_t i)
+{
+    return (i < LATENCIA_CUBETAS) ? cubetas[i] : 0;
+}
+
+TrazadorLatencia::TrazadorLatencia()
+{
+    memset(enVuelo, 0, sizeof(enVuelo));
+    siguiente = 1;
+    memset(registro, 0, sizeof(registro));
+    abiertas = 0;
+    cerradas = 0;
+    portMUX_INITIALIZE(&candado);
+}
+
+uint32_t TrazadorLatencia::Abrir(uint32_t muestraUs, uint32_t publicadoUs)
+{
+    uint32_t traza = siguiente++;
+    if (siguiente == 0)
+        siguiente = 1;
+    abiertas++;
+
+    TrazaLatencia &t = enVuelo[traza & (LATENCIA_EN_VUELO - 1)];
+    t.muestra = muestraUs;
+    t.publicado = publicadoUs;
+    t.consumido = micros();
+    return traza;
+}
+
+void TrazadorLatencia::CuadroMostrado(void *contexto, uint32_t traza, uint32_t presentadoUs, uint32_t envioUs, uint32_t finUs)
+{
+    ((TrazadorLatencia *)contexto)->Cerrar(traza, presentadoUs, envioUs, finUs);
+}
+
+// El Presentar que entrega el cuadro sincroniza con la tarea de render, así que las
+// marcas de la lógica ya son visibles aquí
+void TrazadorLatencia::Cerrar(uint32_t traza, uint32_t presentadoUs, uint32_t envioUs, uint32_t finUs)
+{
+    TrazaLatencia t = enVuelo[traza & (LATENCIA_EN_VUELO - 1)];
+    t.presentado = presentadoUs;
+    t.envio = envioUs;
+    t.fin = finUs;
+
+    portENTER_CRITICAL(&candado);
+    histogramas[ETAPA_REBOTE].Registrar(t.publicado - t.muestra);
+    histogramas[ETAPA_ESPERA].Registrar(t.consumido - t.publicado);
+    histogramas[ETAPA_ACTUALIZACION].Registrar(t.presentado - t.consumido);
+    histogramas[ETAPA_COLA_RENDER].Registrar(t.envio - t.presentado);
+    histogramas[ETAPA_ENVIO].Registrar(t.fin - t.envio);
+    histogramas[ETAPA_TOTAL].Registrar(t.fin - t.muestra);
+    registro[cerradas % LATENCIA_REGISTRO] = t;
+    cerradas++;
+    portEXIT_CRITICAL(&candado);
+}
+
+void TrazadorLatencia::Volcar(void)
+{
+    static const uint8_t percentiles[] = {50, 90, 99};
+
+    // Copiar y reiniciar de una vez: lo que se cierre mientras se imprime va al siguiente volcado
+    portENTER_CRITICAL(&candado);
+    uint32_t totalCerradas = cerradas;
+    uint32_t totalAbiertas = abiertas;
+    uint32_t guardadas = (cerradas < LATENCIA_REGISTRO) ? cerradas : LATENCIA_REGISTRO;
+    for (uint8_t e = 0; e < NUM_ETAPAS; e++)
+    {
+        copiaHistogramas[e] = histogramas[e];
+        histogramas[e].Reiniciar();
+    }
+    for (uint32_t i = 0; i < guardadas; i++)
+        copiaRegistro[i] = registro[(cerradas - guardadas + i) % LATENCIA_REGISTRO];
+    abiertas = 0;
+    cerradas = 0;
+    portEXIT_CRITICAL(&candado);
+
+    // Las abiertas que no se cerraron iban en un cuadro descartado junto con otra traza
+    Serial.printf("LAT_INICIO %lu %lu\n", (unsigned long)totalCerradas, (unsigned long)(totalAbiertas - totalCerradas));
+    for (uint8_t e = 0; e < NUM_ETAPAS; e++)
+    {
+        HistogramaLatencia &h = copiaHistogramas[e];
+        Serial.printf("LATH %s %lu %lu", nombresEtapas[e], (unsigned long)h.Cuenta(), (unsigned long)h.Minimo());
+        for (uint8_t p : percentiles)
+            Serial.printf(" %lu", (unsigned long)h.Percentil(p));
+        Serial.printf(" %lu\n", (unsigned long)h.Maximo());
+
+        // Cubetas no vacías, para comparar con la reconstrucción en la PC
+        Serial.printf("LATB %s", nombresEtapas[e]);
+        for (uint8_t i = 0; i < LATENCIA_CUBETAS; i++)
+            if (h.Cubeta(i))
+                Serial.printf(" %u:%lu", i, (unsigned long)h.Cubeta(i));
+        Serial.println();
+    }
+
+    for (uint32_t i = 0; i < guardadas; i++)
+    {
+        const TrazaLatencia &t = copiaRegistro[i];
+        Serial.printf("LATT %lu %lu %lu %lu %lu %lu\n", (unsigned long)t.muestra, (unsigned long)t.publicado,
+                      (unsigned long)t.consumido, (unsigned long)t.presentado, (unsigned long)t.envio, (unsigned long)t.fin);
+    }
+    Serial.println("LAT_FIN");
+}
+
+#endif
@@ -0,0 +1,453 @@
+#ifndef Marcador_h
+#define Marcador_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <ArduinoJson.h>
+#include <SD.h>
+#include "Bitacora.h"
+
+/*
+ * Marcador ordenado en la SD.
+ * Guarda todos los puntajes (miles) en un archivo de bloques de 512 bytes, un
+ * sector de la SD cada uno. Cada bloque tiene hasta MARCADOR_POR_BLOQUE entradas
+ * ordenadas de mayor a menor puntaje; la cabecera guarda el orden lógico de los
+ * bloques. En RAM se mantiene un directorio con la cuenta, el puntaje mínimo y el
+ * rango inicial de cada bloque, así que buscar la posición de un puntaje, insertarlo
+ * o leer una página cuesta una búsqueda binaria en el directorio más la lectura de
+ * uno o dos bloques. Un bloque lleno se divide en dos.
+ */
+
+#define MARCADOR_ARCHIVO "/marcador.idx"
+#define MARCADOR_JSON "/GameData.json" // Formato anterior; se migra la primera vez
+#define MARCADOR_MAGIA 0x4B52414DUL    // "MARK"
+#define MARCADOR_VERSION 1
+#define MARCADOR_TAM_SECTOR 512
+#define MARCADOR_POR_BLOQUE 42
+#define MARCADOR_MAX_BLOQUES 248 // Lo que cabe en el sector de cabecera (~5000 a 10000 entradas)
+
+// Entrada tal como se guarda (little-endian)
+struct __attribute__((packed)) EntradaMarcador
+{
+    uint32_t puntaje;
+    uint32_t orden;   // Orden de llegada: a igual puntaje queda primero el más antiguo
+    char nombre[4];   // Tres letras y terminador
+};
+
+struct __attribute__((packed)) CabeceraMarcador
+{
+    uint32_t magia;
+    uint8_t version;
+    uint8_t reservado;
+    uint16_t bloques;
+    uint32_t total;
+    uint32_t siguienteOrden;
+    uint16_t fisico[MARCADOR_MAX_BLOQUES]; // Bloque físico de cada bloque lógico
+};
+
+struct __attribute__((packed)) BloqueMarcador
+{
+    uint16_t cuenta;
+    uint8_t reservado[6];
+    EntradaMarcador entradas[MARCADOR_POR_BLOQUE];
+};
+
+static_assert(sizeof(CabeceraMarcador) == MARCADOR_TAM_SECTOR, "La cabecera del marcador debe medir un sector");
+static_assert(sizeof(BloqueMarcador) == MARCADOR_TAM_SECTOR, "Un bloque del marcador debe medir un sector");
+
+class Marcador
+{
+public:
+    Marcador(const char *ruta = MARCADOR_ARCHIVO);
+
+    // Abre el archivo y arma el directorio en RAM; si no existe lo crea y, si se pide, migra desde
+    // GameData.json. Uno existente pero inválido no se toca: devuelve false y el marcador queda vacío
+    bool Iniciar(SemaphoreHandle_t mutexSD, bool migrarJson = true);
+
+    // Inserta el puntaje en su lugar; 'lugar' recibe la posición (1 = primero)
+    bool Insertar(uint32_t puntaje, const char *nombre, uint32_t *lugar);
+
+    // Lugar que ocuparía un puntaje nuevo (1 + cuántos son mayores o iguales)
+    uint32_t Lugar(uint32_t puntaje);
+
+    // Copia hasta 'n' entradas a partir del lugar 'desde' (0 = primero)
+    uint8_t LeerPagina(uint32_t desde, EntradaMarcador *destino, uint8_t n);
+
+    uint32_t Total(void);
+    uint32_t Mejor(void); // 0 si está vacío
+
+    // Borra el archivo (para los benchmarks)
+    void Eliminar(void);
+
+private:
+    const char *ruta;
+    SemaphoreHandle_t mutexSD;
+    CabeceraMarcador cabecera;
+    BloqueMarcador bloque; // Búfer de trabajo (un sector)
+    uint32_t mejor;
+
+    // Directorio en RAM por bloque lógico
+    uint8_t cuenta[MARCADOR_MAX_BLOQUES];
+    uint32_t minimo[MARCADOR_MAX_BLOQUES];     // Puntaje de la última entrada
+    uint32_t primerLugar[MARCADOR_MAX_BLOQUES]; // Entradas en los bloques anteriores
+
+    bool Crear(File &archivo);
+    bool LeerDirectorio(File &archivo);
+    void Migrar(void);
+    bool InsertarSinCandado(File &archivo, uint32_t puntaje, const char *nombre, uint32_t *lugar);
+    uint16_t BuscarBloque(uint32_t puntaje);
+    uint16_t BuscarPosicion(uint32_t puntaje);
+    uint16_t BloqueDeLugar(uint32_t lugar);
+    void RecalcularLugares(uint16_t desde);
+    bool LeerBloque(File &archivo, uint16_t logico);
+    bool EscribirBloque(File &archivo, uint16_t fisico);
+    bool EscribirCabecera(File &archivo);
+};
+
+// Desarrollo de métodos
+
+Marcador::Marcador(const char *ruta)
+{
+    this->ruta = ruta;
+    mutexSD = NULL;
+    memset(&cabecera, 0, sizeof(cabecera));
+    mejor = 0;
+}
+
+bool Marcador::Iniciar(SemaphoreHandle_t mutexSD, bool migrarJson)
+{
+    this->mutexSD = mutexSD;
+    bool migrar = false;
+    File archivo;
+
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    if (!SD.exists(ruta))
+    {
+        // Sólo se crea cuando no existe: uno dañado se conserva para recuperarlo a mano
+        archivo = SD.open(ruta, "w+");
+        if (!archivo || !Crear(archivo))
+        {
+            if (archivo)
+                archivo.close();
+            memset(&cabecera, 0, sizeof(cabecera));
+            xSemaphoreGive(mutexSD);
+            BITACORA(MSG_MARCADOR_ERROR);
+            return false;
+        }
+        migrar = migrarJson;
+    }
+    else
+    {
+        archivo = SD.open(ruta, "r+");
+        if (!archivo || !LeerDirectorio(archivo))
+        {
+            if (archivo)
+                archivo.close();
+            memset(&cabecera, 0, sizeof(cabecera));
+            xSemaphoreGive(mutexSD);
+            BITACORA(MSG_MARCADOR_INVALIDO, ruta);
+            return false;
+        }
+    }
+    RecalcularLugares(0);
+    if (cabecera.total > 0)
+    {
+        LeerBloque(archivo, 0);
+        mejor = bloque.entradas[0].puntaje;
+    }
+    archivo.close();
+    xSemaphoreGive(mutexSD);
+
+    if (migrar)
+        Migrar();
+    return true;
+}
+
+bool Marcador::Insertar(uint32_t puntaje, const char *nombre, uint32_t *lugar)
+{
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    File archivo = SD.open(ruta, "r+");
+    bool insertado = archivo && cabecera.bloques > 0 && InsertarSinCandado(archivo, puntaje, nombre, lugar);
+    if (archivo)
+        archivo.close();
+    xSemaphoreGive(mutexSD);
+    return insertado;
+}
+
+uint32_t Marcador::Lugar(uint32_t puntaje)
+{
+    uint32_t lugar = cabecera.total + 1;
+
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    File archivo = SD.open(ruta, FILE_READ);
+    if (archivo && cabecera.bloques > 0)
+    {
+        uint16_t l = BuscarBloque(puntaje);
+        if (LeerBloque(archivo, l))
+            lugar = primerLugar[l] + BuscarPosicion(puntaje) + 1;
+    }
+    if (archivo)
+        archivo.close();
+    xSemaphoreGive(mutexSD);
+    return lugar;
+}
+
+uint8_t Marcador::LeerPagina(uint32_t desde, EntradaMarcador *destino, uint8_t n)
+{
+    uint8_t leidas = 0;
+
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    File archivo = SD.open(ruta, FILE_READ);
+    if (archivo && desde < cabecera.total)
+    {
+        // Sólo se leen los bloques que contienen la página
+        uint16_t l = BloqueDeLugar(desde);
+        uint16_t i = desde - primerLugar[l];
+        while (leidas < n && l < cabecera.bloques && LeerBloque(archivo, l))
+        {
+            while (leidas < n && i < bloque.cuenta)
+                destino[leidas++] = bloque.entradas[i++];
+            l++;
+            i = 0;
+        }
+    }
+    if (archivo)
+        archivo.close();
+    xSemaphoreGive(mutexSD);
+    return leidas;
+}
+
+uint32_t Marcador::Total(void)
+{
+    return cabecera.total;
+}
+
+uint32_t Marcador::Mejor(void)
+{
+    return mejor;
+}
+
+void Marcador::Eliminar(void)
+{
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    SD.remove(ruta);
+    xSemaphoreGive(mutexSD);
+    memset(&cabecera, 0, sizeof(cabecera));
+    mejor = 0;
+}
+
+bool Marcador::Crear(File &archivo)
+{
+    memset(&cabecera, 0, sizeof(cabecera));
+    cabecera.magia = MARCADOR_MAGIA;
+    cabecera.version = MARCADOR_VERSION;
+    cabecera.bloques = 1;
+    cabecera.fisico[0] = 0;
+    cuenta[0] = 0;
+    minimo[0] = 0;
+
+    memset(&bloque, 0, sizeof(bloque));
+    return EscribirBloque(archivo, 0) && EscribirCabecera(archivo);
+}
+
+// Valida la cabecera y arma el directorio leyendo la cuenta y la última entrada de cada bloque
+bool Marcador::LeerDirectorio(File &archivo)
+{
+    if (archivo.read((uint8_t *)&cabecera, sizeof(cabecera)) != sizeof(cabecera) ||
+        cabecera.magia != MARCADOR_MAGIA || cabecera.version != MARCADOR_VERSION ||
+        cabecera.bloques == 0 || cabecera.bloques > MARCADOR_MAX_BLOQUES)
+        return false;
+
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < cabecera.bloques; i++)
+    {
+        if (cabecera.fisico[i] >= cabecera.bloques || !LeerBloque(archivo, i))
+            return false;
+        cuenta[i] = bloque.cuenta;
+        minimo[i] = bloque.cuenta ? bloque.entradas[bloque.cuenta - 1].puntaje : 0;
+        total += bloque.cuenta;
+    }
+    return total == cabecera.total;
+}
+
+// Importa los puntajes del GameData.json anterior
+void Marcador::Migrar(void)
+{
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    File json = SD.open(MARCADOR_JSON);
+    if (!json)
+    {
+        xSemaphoreGive(mutexSD);
+        return;
+    }
+    JsonDocument doc;
+    deserializeJson(doc, json);
+    json.close();
+
+    File archivo = SD.open(ruta, "r+");
+    uint32_t lugar;
+    int migradas = 0;
+    JsonArray bestScores = doc["bestScores"].as<JsonArray>();
+    for (size_t i = 0; i < bestScores.size(); i++)
+    {
+        JsonObject score = bestScores[i];
+        const char *nombre = score["name"];
+        if (archivo && nombre && strlen(nombre) > 0 && InsertarSinCandado(archivo, score["score"].as<uint32_t>(), nombre, &lugar))
+            migradas++;
+    }
+    if (archivo)
+        archivo.close();
+    xSemaphoreGive(mutexSD);
+    BITACORA(MSG_MARCADOR_MIGRADO, migradas, MARCADOR_JSON);
+}
+
+bool Marcador::InsertarSinCandado(File &archivo, uint32_t puntaje, const char *nombre, uint32_t *lugar)
+{
+    uint16_t l = BuscarBloque(puntaje);
+    if (!LeerBloque(archivo, l))
+        return false;
+    uint16_t posicion = BuscarPosicion(puntaje);
+
+    if (bloque.cuenta == MARCADOR_POR_BLOQUE)
+    {
+        if (cabecera.bloques == MARCADOR_MAX_BLOQUES)
+            return false;
+
+        // Dividir: la mitad superior pasa a un bloque físico nuevo al final del archivo
+        const uint16_t mitad = MARCADOR_POR_BLOQUE / 2;
+        uint16_t nuevo = cabecera.bloques;
+        BloqueMarcador superior = bloque;
+        superior.cuenta = MARCADOR_POR_BLOQUE - mitad;
+        memmove(superior.entradas, bloque.entradas + mitad, superior.cuenta * sizeof(EntradaMarcador));
+        bloque.cuenta = mitad;
+
+        // Abrir un hueco en el directorio para el nuevo bloque lógico l + 1
+        uint16_t mover = cabecera.bloques - (l + 1);
+        memmove(&cabecera.fisico[l + 2], &cabecera.fisico[l + 1], mover * sizeof(uint16_t));
+        memmove(&cuenta[l + 2], &cuenta[l + 1], mover * sizeof(cuenta[0]));
+        memmove(&minimo[l + 2], &minimo[l + 1], mover * sizeof(minimo[0]));
+        cabecera.fisico[l + 1] = nuevo;
+        cabecera.bloques++;
+        cuenta[l] = bloque.cuenta;
+        minimo[l] = bloque.entradas[bloque.cuenta - 1].puntaje;
+        cuenta[l + 1] = superior.cuenta;
+        minimo[l + 1] = superior.entradas[superior.cuenta - 1].puntaje;
+
+        if (posicion > mitad)
+        {
+            // La entrada va en la mitad superior: guardar la inferior y seguir con la otra
+            if (!EscribirBloque(archivo, cabecera.fisico[l]))
+                return false;
+            bloque = superior;
+            posicion -= mitad;
+            l++;
+        }
+        else
+        {
+            BloqueMarcador inferior = bloque;
+            bloque = superior;
+            if (!EscribirBloque(archivo, nuevo))
+                return false;
+            bloque = inferior;
+        }
+    }
+
+    EntradaMarcador &e = bloque.entradas[posicion];
+    memmove(&bloque.entradas[posicion + 1], &bloque.entradas[posicion], (bloque.cuenta - posicion) * sizeof(EntradaMarcador));
+    e.puntaje = puntaje;
+    e.orden = cabecera.siguienteOrden++;
+    memset(e.nombre, 0, sizeof(e.nombre));
+    strncpy(e.nombre, nombre, sizeof(e.nombre) - 1);
+    bloque.cuenta++;
+
+    cuenta[l] = bloque.cuenta;
+    minimo[l] = bloque.entradas[bloque.cuenta - 1].puntaje;
+    cabecera.total++;
+    RecalcularLugares(l);
+    if (puntaje > mejor || cabecera.total == 1)
+        mejor = puntaje;
+
+    *lugar = primerLugar[l] + posicion + 1;
+    return EscribirBloque(archivo, cabecera.fisico[l]) && EscribirCabecera(archivo);
+}
+
+// Bloque lógico donde va un puntaje nuevo: el primero cuyo mínimo sea menor
+// (los iguales quedan antes por ser más antiguos). Búsqueda binaria en el directorio.
+uint16_t Marcador::BuscarBloque(uint32_t puntaje)
+{
+    uint16_t inicio = 0, fin = cabecera.bloques - 1;
+    while (inicio < fin)
+    {
+        uint16_t medio = (inicio + fin) / 2;
+        if (minimo[medio] < puntaje)
+            fin = medio;
+        else
+            inicio = medio + 1;
+    }
+    return inicio;
+}
+
+// Posición dentro del bloque cargado: la primera entrada con puntaje menor
+uint16_t Marcador::BuscarPosicion(uint32_t puntaje)
+{
+    uint16_t inicio = 0, fin = bloque.cuenta;
+    while (inicio < fin)
+    {
+        uint16_t medio = (inicio + fin) / 2;
+        if (bloque.entradas[medio].puntaje < puntaje)
+            fin = medio;
+        else
+            inicio = medio + 1;
+    }
+    return inicio;
+}
+
+// Bloque lógico que contiene el lugar (0 = primero)
+uint16_t Marcador::BloqueDeLugar(uint32_t lugar)
+{
+    uint16_t inicio = 0, fin = cabecera.bloques - 1;
+    while (inicio < fin)
+    {
+        uint16_t medio = (inicio + fin + 1) / 2;
+        if (primerLugar[medio] <= lugar)
+            inicio = medio;
+        else
+            fin = medio - 1;
+    }
+    return inicio;
+}
+
+// Sumas acumuladas del directorio (sólo RAM; a lo más MARCADOR_MAX_BLOQUES sumas)
+void Marcador::RecalcularLugares(uint16_t desde)
+{
+    uint32_t acumulado = desde ? primerLugar[desde - 1] + cuenta[desde - 1] : 0;
+    for (uint16_t i = desde; i < cabecera.bloques; i++)
+    {
+        primerLugar[i] = acumulado;
+        acumulado += cuenta[i];
+    }
+}
+
+bool Marcador::LeerBloque(File &archivo, uint16_t logico)
+{
+    if (logico >= cabecera.bloques)
+        return false;
+    uint32_t posicion = (uint32_t)(1 + cabecera.fisico[logico]) * MARCADOR_TAM_SECTOR;
+    // Una cuenta fuera de rango en la SD desbordaría las copias de entradas
+    return archivo.seek(posicion) && archivo.read((uint8_t *)&bloque, sizeof(bloque)) == sizeof(bloque) &&
+           bloque.cuenta <= MARCADOR_POR_BLOQUE;
+}
+
+bool Marcador::EscribirBloque(File &archivo, uint16_t fisico)
+{
+    uint32_t posicion = (uint32_t)(1 + fisico) * MARCADOR_TAM_SECTOR;
+    return archivo.seek(posicion) && archivo.write((const uint8_t *)&bloque, sizeof(bloque)) == sizeof(bloque);
+}
+
+bool Marcador::EscribirCabecera(File &archivo)
+{
+    return archivo.seek(0) && archivo.write((const uint8_t *)&cabecera, sizeof(cabecera)) == sizeof(cabecera);
+}
+
+#endif
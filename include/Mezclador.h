@@ -0,0 +1,285 @@
+#ifndef Mezclador_h
+#define Mezclador_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Mezclador de audio en punto fijo.
+ * Combina la música (una fuente que entrega muestras por bloques) con varias voces
+ * de efectos: tonos cuadrados sintetizados o muestras PCM en memoria. Todo es Q15:
+ * cada voz tiene volumen y paneo que se convierten en ganancias izquierda/derecha,
+ * las voces se suman en acumuladores de 32 bits y la suma se satura a 16 bits al
+ * aplicar el volumen maestro. Se procesa por bloques de MEZCLADOR_BLOQUE cuadros
+ * estéreo, el tamaño de un búfer DMA del I2S.
+ * No depende de Arduino ni de FreeRTOS: la tarea que lo usa (SalidaAudio) se
+ * encarga de serializar los cambios, y en la PC se puede probar tal cual.
+ */
+
+#define MEZCLADOR_FRECUENCIA 22050 // Muestras por segundo
+#define MEZCLADOR_BLOQUE 256       // Cuadros estéreo por bloque (= dma_buf_len del I2S)
+#define MEZCLADOR_VOCES 6
+#define MEZCLADOR_VOZ_MUSICA 0     // Reservada para la fuente de música; el resto son efectos
+#define Q15_UNO 32767
+#define MEZCLADOR_AMPLITUD_TONO 12000 // Amplitud de la onda cuadrada antes del volumen
+
+// Llena 'destino' con hasta 'muestras' muestras mono; devolver menos indica el final
+typedef size_t (*FuenteAudio)(void *contexto, int16_t *destino, size_t muestras);
+
+enum TipoVoz
+{
+    VOZ_LIBRE,
+    VOZ_TONO,
+    VOZ_MUESTRA,
+    VOZ_FUENTE
+};
+
+struct VozMezclador
+{
+    TipoVoz tipo;
+    int16_t gananciaIzq, gananciaDer; // Q15
+    // VOZ_TONO: acumulador de fase de 32 bits y cuadros restantes
+    uint32_t fase, incremento, restantes;
+    // VOZ_MUESTRA
+    const int16_t *datos;
+    uint32_t longitud, posicion;
+    bool repetir;
+    // VOZ_FUENTE
+    FuenteAudio fuente;
+    void *contexto;
+};
+
+class Mezclador
+{
+public:
+    Mezclador(uint32_t frecuencia = MEZCLADOR_FRECUENCIA);
+
+    // Las voces de efectos devuelven su índice, o -1 si todas están ocupadas.
+    // volumen: 0..Q15_UNO; pan: -32768 (izquierda) .. 32767 (derecha)
+    int8_t ReproducirTono(uint16_t frecuencia, uint32_t ms, uint16_t volumen, int16_t pan);
+    int8_t ReproducirMuestra(const int16_t *datos, uint32_t longitud, uint16_t volumen, int16_t pan, bool repetir = false);
+    void ReproducirFuente(int8_t voz, FuenteAudio fuente, void *contexto, uint16_t volumen, int16_t pan);
+    void Detener(int8_t voz);
+    void Volumen(int8_t voz, uint16_t volumen, int16_t pan);
+    void VolumenMaestro(uint16_t volumen);
+
+    // Mezcla 'cuadros' (<= MEZCLADOR_BLOQUE) cuadros estéreo intercalados (I, D, I, D...)
+    void Mezclar(int16_t *salida, size_t cuadros);
+
+    uint8_t VocesActivas(void);
+    uint32_t Saturaciones(void); // Muestras recortadas desde el arranque
+    uint32_t Descartados(void);  // Efectos sin voz libre
+
+private:
+    uint32_t frecuencia;
+    uint16_t maestro;
+    VozMezclador voces[MEZCLADOR_VOCES];
+    int32_t acumulador[MEZCLADOR_BLOQUE * 2];
+    int16_t temporal[MEZCLADOR_BLOQUE];
+    uint32_t saturaciones, descartados;
+
+    int8_t VozLibre(void);
+    size_t Generar(VozMezclador &voz, int16_t *destino, size_t cuadros);
+    static void Ganancias(VozMezclador &voz, uint16_t volumen, int16_t pan);
+    static int16_t Saturar(int32_t valor, uint32_t &saturaciones);
+};
+
+// Desarrollo de métodos
+
+Mezclador::Mezclador(uint32_t frecuencia)
+{
+    this->frecuencia = frecuencia;
+    maestro = Q15_UNO;
+    memset(voces, 0, sizeof(voces));
+    saturaciones = 0;
+    descartados = 0;
+}
+
+int8_t Mezclador::ReproducirTono(uint16_t frecuencia, uint32_t ms, uint16_t volumen, int16_t pan)
+{
+    int8_t i = VozLibre();
+    if (i < 0)
+        return -1;
+
+    VozMezclador &voz = voces[i];
+    voz.fase = 0;
+    voz.incremento = (uint32_t)(((uint64_t)frecuencia << 32) / this->frecuencia);
+    voz.restantes = (uint32_t)((uint64_t)ms * this->frecuencia / 1000);
+    Ganancias(voz, volumen, pan);
+    voz.tipo = VOZ_TONO;
+    return i;
+}
+
+int8_t Mezclador::ReproducirMuestra(const int16_t *datos, uint32_t longitud, uint16_t volumen, int16_t pan, bool repetir)
+{
+    int8_t i = VozLibre();
+    if (i < 0 || longitud == 0)
+        return -1;
+
+    VozMezclador &voz = voces[i];
+    voz.datos = datos;
+    voz.longitud = longitud;
+    voz.posicion = 0;
+    voz.repetir = repetir;
+    Ganancias(voz, volumen, pan);
+    voz.tipo = VOZ_MUESTRA;
+    return i;
+}
+
+void Mezclador::ReproducirFuente(int8_t voz, FuenteAudio fuente, void *contexto, uint16_t volumen, int16_t pan)
+{
+    if (voz < 0 || voz >= MEZCLADOR_VOCES)
+        return;
+    voces[voz].fuente = fuente;
+    voces[voz].contexto = contexto;
+    Ganancias(voces[voz], volumen, pan);
+    voces[voz].tipo = VOZ_FUENTE;
+}
+
+void Mezclador::Detener(int8_t voz)
+{
+    if (voz >= 0 && voz < MEZCLADOR_VOCES)
+        voces[voz].tipo = VOZ_LIBRE;
+}
+
+void Mezclador::Volumen(int8_t voz, uint16_t volumen, int16_t pan)
+{
+    if (voz >= 0 && voz < MEZCLADOR_VOCES)
+        Ganancias(voces[voz], volumen, pan);
+}
+
+void Mezclador::VolumenMaestro(uint16_t volumen)
+{
+    maestro = (volumen > Q15_UNO) ? Q15_UNO : volumen;
+}
+
+void Mezclador::Mezclar(int16_t *salida, size_t cuadros)
+{
+    if (cuadros > MEZCLADOR_BLOQUE)
+        cuadros = MEZCLADOR_BLOQUE;
+    memset(acumulador, 0, cuadros * 2 * sizeof(int32_t));
+
+    for (uint8_t v = 0; v < MEZCLADOR_VOCES; v++)
+    {
+        VozMezclador &voz = voces[v];
+        if (voz.tipo == VOZ_LIBRE)
+            continue;
+
+        size_t n = Generar(voz, temporal, cuadros);
+        int32_t izq = voz.gananciaIzq, der = voz.gananciaDer;
+        for (size_t i = 0; i < n; i++)
+        {
+            acumulador[2 * i] += (temporal[i] * izq) >> 15;
+            acumulador[2 * i + 1] += (temporal[i] * der) >> 15;
+        }
+    }
+
+    // Con MEZCLADOR_VOCES voces de 16 bits el acumulador no se desborda; sólo se satura al
+    // final. El producto por el maestro sí puede pasar de 32 bits.
+    for (size_t i = 0; i < cuadros * 2; i++)
+        salida[i] = Saturar((int32_t)(((int64_t)acumulador[i] * maestro) >> 15), saturaciones);
+}
+
+uint8_t Mezclador::VocesActivas(void)
+{
+    uint8_t activas = 0;
+    for (uint8_t v = 0; v < MEZCLADOR_VOCES; v++)
+        activas += (voces[v].tipo != VOZ_LIBRE);
+    return activas;
+}
+
+uint32_t Mezclador::Saturaciones(void)
+{
+    return saturaciones;
+}
+
+uint32_t Mezclador::Descartados(void)
+{
+    return descartados;
+}
+
+int8_t Mezclador::VozLibre(void)
+{
+    for (int8_t v = 0; v < MEZCLADOR_VOCES; v++)
+    {
+        if (v != MEZCLADOR_VOZ_MUSICA && voces[v].tipo == VOZ_LIBRE)
+            return v;
+    }
+    descartados++;
+    return -1;
+}
+
+// Escribe las muestras mono de la voz; una voz que termina antes del bloque queda libre
+size_t Mezclador::Generar(VozMezclador &voz, int16_t *destino, size_t cuadros)
+{
+    size_t n = 0;
+
+    switch (voz.tipo)
+    {
+    case VOZ_TONO:
+        n = (voz.restantes < cuadros) ? voz.restantes : cuadros;
+        for (size_t i = 0; i < n; i++)
+        {
+            destino[i] = (voz.fase & 0x80000000UL) ? -MEZCLADOR_AMPLITUD_TONO : MEZCLADOR_AMPLITUD_TONO;
+            voz.fase += voz.incremento;
+        }
+        voz.restantes -= n;
+        if (voz.restantes == 0)
+            voz.tipo = VOZ_LIBRE;
+        break;
+    case VOZ_MUESTRA:
+        while (n < cuadros)
+        {
+            uint32_t disponibles = voz.longitud - voz.posicion;
+            uint32_t copia = (disponibles < cuadros - n) ? disponibles : cuadros - n;
+            memcpy(destino + n, voz.datos + voz.posicion, copia * sizeof(int16_t));
+            n += copia;
+            voz.posicion += copia;
+            if (voz.posicion < voz.longitud)
+                break;
+            if (!voz.repetir)
+            {
+                voz.tipo = VOZ_LIBRE;
+                break;
+            }
+            voz.posicion = 0;
+        }
+        break;
+    case VOZ_FUENTE:
+        n = voz.fuente(voz.contexto, destino, cuadros);
+        if (n < cuadros)
+            voz.tipo = VOZ_LIBRE;
+        break;
+    default:
+        break;
+    }
+    return n;
+}
+
+// Paneo lineal: el volumen se reparte entre los dos canales
+void Mezclador::Ganancias(VozMezclador &voz, uint16_t volumen, int16_t pan)
+{
+    if (volumen > Q15_UNO)
+        volumen = Q15_UNO;
+    uint32_t derecha = (uint32_t)((int32_t)pan + 32768); // 0..65535
+    voz.gananciaIzq = (int16_t)(((uint32_t)volumen * (65535 - derecha)) >> 16);
+    voz.gananciaDer = (int16_t)(((uint32_t)volumen * derecha) >> 16);
+}
+
+int16_t Mezclador::Saturar(int32_t valor, uint32_t &saturaciones)
+{
+    if (valor > 32767)
+    {
+        saturaciones++;
+        return 32767;
+    }
+    if (valor < -32768)
+    {
+        saturaciones++;
+        return -32768;
+    }
+    return (int16_t)valor;
+}
+
+#endif
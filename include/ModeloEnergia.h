@@ -0,0 +1,222 @@
+#ifndef ModeloEnergia_h
+#define ModeloEnergia_h
+
+#include <stdint.h>
+
+/*
+ * Modelo de energía del gobernador (ver Energia.h).
+ * Decide el nivel de energía a partir del estado del juego y del tiempo sin
+ * entrada, y lleva la cuenta del tiempo pasado en cada nivel y de la carga
+ * consumida. No depende de Arduino ni de FreeRTOS: los tiempos se le pasan en
+ * milisegundos, así que se puede compilar y probar en la PC.
+ */
+
+// Tiempo sin entrada (ms) antes de bajar de nivel en un estado no interactivo
+#define ENERGIA_ESPERA_AHORRO 3000
+#define ENERGIA_ESPERA_SUENO 20000
+
+// Corriente estimada por nivel (uA); valores de la hoja de datos del ESP32 sin WiFi,
+// sin contar la luz de fondo de la LCD. Ajustar con mediciones del tablero.
+#define ENERGIA_CONSUMO_ACTIVO 50000
+#define ENERGIA_CONSUMO_AHORRO 25000
+#define ENERGIA_CONSUMO_SUENO 3000
+
+#define ENERGIA_SIN_CAMBIO UINT32_MAX
+
+enum NivelEnergia
+{
+    ENERGIA_ACTIVO, // 240 MHz, entrada a 5 ms
+    ENERGIA_AHORRO, // 80 MHz
+    ENERGIA_SUENO,  // 80 MHz con sueño ligero automático y muestreo lento
+    NUM_NIVELES_ENERGIA
+};
+
+class ModeloEnergia
+{
+public:
+    ModeloEnergia(uint32_t esperaAhorro = ENERGIA_ESPERA_AHORRO, uint32_t esperaSueno = ENERGIA_ESPERA_SUENO);
+
+    void Reiniciar(uint32_t ahora);
+
+    // Política: nivel que corresponde sin modificar el modelo
+    NivelEnergia Decidir(bool interactivo, uint32_t ahora) const;
+
+    // Registra una entrada del jugador; devuelve true si el nivel cambió
+    bool Actividad(bool interactivo, uint32_t ahora);
+
+    // Reevalúa el nivel; devuelve true si cambió
+    bool Actualizar(bool interactivo, uint32_t ahora);
+
+    // Milisegundos hasta el siguiente cambio de nivel si no hay entrada
+    uint32_t ProximoCambio(bool interactivo, uint32_t ahora) const;
+
+    NivelEnergia Nivel(void) const;
+    NivelEnergia NivelAnterior(void) const;
+    uint32_t DuracionAnterior(void) const; // ms que duró el nivel anterior
+    uint32_t TiempoEn(NivelEnergia nivel, uint32_t ahora) const;
+    uint32_t Transiciones(void) const;
+    uint32_t Despertares(void) const; // Salidas de ENERGIA_SUENO por entrada
+
+    // Carga estimada desde Reiniciar() en uA·h y corriente promedio en uA
+    uint32_t CargaMicroAmperHora(uint32_t ahora) const;
+    uint32_t ConsumoPromedio(uint32_t ahora) const;
+
+    static uint32_t Consumo(NivelEnergia nivel);
+
+private:
+    uint32_t esperaAhorro, esperaSueno;
+    NivelEnergia nivel;
+    NivelEnergia anterior;
+    uint32_t duracionAnterior;
+    uint32_t inicioNivel;
+    uint32_t inicio;
+    uint32_t ultimaActividad;
+    uint32_t tiempos[NUM_NIVELES_ENERGIA];
+    uint32_t transiciones;
+    uint32_t despertares;
+
+    void Cambiar(NivelEnergia nuevo, uint32_t ahora);
+};
+
+// Desarrollo de métodos
+
+ModeloEnergia::ModeloEnergia(uint32_t esperaAhorro, uint32_t esperaSueno)
+{
+    this->esperaAhorro = esperaAhorro;
+    this->esperaSueno = esperaSueno;
+    Reiniciar(0);
+}
+
+void ModeloEnergia::Reiniciar(uint32_t ahora)
+{
+    nivel = ENERGIA_ACTIVO;
+    anterior = ENERGIA_ACTIVO;
+    duracionAnterior = 0;
+    inicioNivel = ahora;
+    inicio = ahora;
+    ultimaActividad = ahora;
+    for (uint8_t i = 0; i < NUM_NIVELES_ENERGIA; i++)
+        tiempos[i] = 0;
+    transiciones = 0;
+    despertares = 0;
+}
+
+NivelEnergia ModeloEnergia::Decidir(bool interactivo, uint32_t ahora) const
+{
+    if (interactivo)
+        return ENERGIA_ACTIVO;
+
+    // Resta sin signo: funciona aunque millis() se desborde
+    uint32_t inactivo = ahora - ultimaActividad;
+    if (inactivo >= esperaSueno)
+        return ENERGIA_SUENO;
+    if (inactivo >= esperaAhorro)
+        return ENERGIA_AHORRO;
+    return ENERGIA_ACTIVO;
+}
+
+bool ModeloEnergia::Actividad(bool interactivo, uint32_t ahora)
+{
+    if (nivel == ENERGIA_SUENO)
+        despertares++;
+    ultimaActividad = ahora;
+    return Actualizar(interactivo, ahora);
+}
+
+bool ModeloEnergia::Actualizar(bool interactivo, uint32_t ahora)
+{
+    NivelEnergia nuevo = Decidir(interactivo, ahora);
+    if (nuevo == nivel)
+        return false;
+    Cambiar(nuevo, ahora);
+    return true;
+}
+
+uint32_t ModeloEnergia::ProximoCambio(bool interactivo, uint32_t ahora) const
+{
+    if (interactivo)
+        return ENERGIA_SIN_CAMBIO;
+
+    uint32_t inactivo = ahora - ultimaActividad;
+    if (inactivo < esperaAhorro)
+        return esperaAhorro - inactivo;
+    if (inactivo < esperaSueno)
+        return esperaSueno - inactivo;
+    return ENERGIA_SIN_CAMBIO;
+}
+
+NivelEnergia ModeloEnergia::Nivel(void) const
+{
+    return nivel;
+}
+
+NivelEnergia ModeloEnergia::NivelAnterior(void) const
+{
+    return anterior;
+}
+
+uint32_t ModeloEnergia::DuracionAnterior(void) const
+{
+    return duracionAnterior;
+}
+
+// Incluye el tramo en curso del nivel actual
+uint32_t ModeloEnergia::TiempoEn(NivelEnergia nivel, uint32_t ahora) const
+{
+    uint32_t tiempo = tiempos[nivel];
+    if (nivel == this->nivel)
+        tiempo += ahora - inicioNivel;
+    return tiempo;
+}
+
+uint32_t ModeloEnergia::Transiciones(void) const
+{
+    return transiciones;
+}
+
+uint32_t ModeloEnergia::Despertares(void) const
+{
+    return despertares;
+}
+
+uint32_t ModeloEnergia::CargaMicroAmperHora(uint32_t ahora) const
+{
+    uint64_t carga = 0; // uA·ms
+    for (uint8_t i = 0; i < NUM_NIVELES_ENERGIA; i++)
+        carga += (uint64_t)Consumo((NivelEnergia)i) * TiempoEn((NivelEnergia)i, ahora);
+    return carga / 3600000ULL;
+}
+
+uint32_t ModeloEnergia::ConsumoPromedio(uint32_t ahora) const
+{
+    uint64_t carga = 0;
+    for (uint8_t i = 0; i < NUM_NIVELES_ENERGIA; i++)
+        carga += (uint64_t)Consumo((NivelEnergia)i) * TiempoEn((NivelEnergia)i, ahora);
+    uint32_t total = ahora - inicio;
+    return total ? carga / total : Consumo(nivel);
+}
+
+uint32_t ModeloEnergia::Consumo(NivelEnergia nivel)
+{
+    switch (nivel)
+    {
+    case ENERGIA_AHORRO:
+        return ENERGIA_CONSUMO_AHORRO;
+    case ENERGIA_SUENO:
+        return ENERGIA_CONSUMO_SUENO;
+    default:
+        return ENERGIA_CONSUMO_ACTIVO;
+    }
+}
+
+void ModeloEnergia::Cambiar(NivelEnergia nuevo, uint32_t ahora)
+{
+    duracionAnterior = ahora - inicioNivel;
+    tiempos[nivel] += duracionAnterior;
+    anterior = nivel;
+    nivel = nuevo;
+    inicioNivel = ahora;
+    transiciones++;
+}
+
+#endif
@@ -2,6 +2,26 @@
 #define Objetos_h
 
 #include <Arduino.h>
+#include "Geometria.h"
+
+// Generador aleatorio xorshift32 para el juego. Su estado es una sola palabra, así
+// que se guarda en el snapshot de la partida y al reanudar los diamantes siguen la
+// misma secuencia.
+uint32_t estadoAleatorio = 2463534242UL;
+
+void SembrarAleatorio(uint32_t semilla)
+{
+    // Cero es el único estado del que xorshift no sale
+    estadoAleatorio = semilla ? semilla : 2463534242UL;
+}
+
+uint32_t Aleatorio(uint32_t limite)
+{
+    estadoAleatorio ^= estadoAleatorio << 13;
+    estadoAleatorio ^= estadoAleatorio >> 17;
+    estadoAleatorio ^= estadoAleatorio << 5;
+    return estadoAleatorio % limite;
+}
 
 // Clase Global
 class Objeto
@@ -38,13 +58,15 @@ class Personaje : public Objeto
 {
 public:
     int puntaje;
-    char *nombre;
+    char nombre[4]; // Copia propia del nick; vacío si no se ha elegido
 
     // Constructor
-    Personaje(int x, int y, int puntaje = 0, char *nombre = nullptr) : Objeto(x, y)
+    Personaje(int x, int y, int puntaje = 0, const char *nombre = nullptr) : Objeto(x, y)
     {
         this->puntaje = puntaje;
-        this->nombre = nombre;
+        this->nombre[0] = '\0';
+        if (nombre != nullptr)
+            AsignarNombre(nombre);
     }
 
     // Métodos
@@ -55,7 +77,7 @@ public:
     void IncrementarPuntaje(void);
     int ImprimirPuntaje(void);
     void ReiniciarValores(void);
-    void AsignarNombre(char *nombre);
+    void AsignarNombre(const char *nombre);
     char *ImprimirNombre(void);
 };
 
@@ -75,8 +97,8 @@ int Objeto::GetY(void)
 // Métodos Diamante
 void Diamante::RehubicarObjeto(void)
 {
-    x = random(13); // Suponiendo que estás usando una pantalla de 16 columnas
-    y = random(2);  // Suponiendo que hay 2 filas
+    x = Aleatorio(GeometriaJuego::campoAncho);
+    y = Aleatorio(GeometriaJuego::campoAlto);
 }
 
 bool Diamante::Colision(int x1, int y1, int x2, int y2)
@@ -95,20 +117,26 @@ void Personaje::Left(void)
 
 void Personaje::Right(void)
 {
-    if (x < 13)
-    { // Suponiendo que el límite es 13
+    if (x < DisposicionJuego::maxX)
+    {
         x += 1;
     }
 }
 
 void Personaje::Up(void)
 {
-    y = 0;
+    if (y > 0)
+    {
+        y -= 1;
+    }
 }
 
 void Personaje::Down(void)
 {
-    y = 1;
+    if (y < DisposicionJuego::maxY)
+    {
+        y += 1;
+    }
 }
 
 void Personaje::IncrementarPuntaje(void)
@@ -124,14 +152,15 @@ int Personaje::ImprimirPuntaje(void)
 void Personaje::ReiniciarValores(void)
 {
     puntaje = 0;
-    nombre = nullptr;
+    nombre[0] = '\0';
     x = 0;
     y = 0;
 }
 
-void Personaje::AsignarNombre(char *nombre)
+void Personaje::AsignarNombre(const char *nombre)
 {
-    nombre = nombre;
+    strncpy(this->nombre, nombre, sizeof(this->nombre) - 1);
+    this->nombre[sizeof(this->nombre) - 1] = '\0';
 }
 char *Personaje::ImprimirNombre(void)
 {
@@ -0,0 +1,179 @@
+#ifndef Pantalla_h
+#define Pantalla_h
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+#include "Glifos.h"
+
+/*
+ * LCD con copia en RAM.
+ * Hereda de LiquidCrystal_I2C y refleja en un búfer cada carácter que se envía,
+ * para poder volcar el contenido de la pantalla (el HD44780 no se puede leer por I2C).
+ * El desplazamiento con scrollDisplayLeft/Right no se refleja: mueve la ventana
+ * visible, no el contenido de la memoria.
+ */
+
+#define PANTALLA_MAX_COLUMNAS 40
+#define PANTALLA_MAX_FILAS 4
+#define PANTALLA_CURSOR_INVALIDO 0xFF // Posición desconocida (después de createChar)
+
+// LiquidCrystal_I2C envía cada byte como dos nibbles y cada nibble con tres
+// escrituras al expansor PCF8574 (dato, pulso de enable alto y bajo).
+#define PANTALLA_TRANSACCIONES_POR_BYTE 6
+#define PANTALLA_BYTES_POR_TRANSACCION 2 // Dirección + byte del expansor
+
+// Tráfico enviado a la LCD desde el último reinicio de los contadores
+struct TraficoLCD
+{
+    uint32_t comandos; // clear, home y setCursor
+    uint32_t datos;    // Caracteres escritos
+    uint32_t Transacciones(void) const { return (comandos + datos) * PANTALLA_TRANSACCIONES_POR_BYTE; }
+    uint32_t BytesI2C(void) const { return Transacciones() * PANTALLA_BYTES_POR_TRANSACCION; }
+};
+
+class PantallaLCD : public LiquidCrystal_I2C
+{
+public:
+    PantallaLCD(uint8_t direccion, uint8_t columnas, uint8_t filas);
+
+    // Se ocultan los métodos de la clase base para seguir el cursor
+    void clear(void);
+    void home(void);
+    void setCursor(uint8_t columna, uint8_t fila);
+    void createChar(uint8_t posicion, uint8_t mapa[]);
+    void createChar(uint8_t posicion, const Glifo &glifo);
+    virtual size_t write(uint8_t caracter);
+    using Print::write;
+
+    uint8_t Columnas(void);
+    uint8_t Filas(void);
+    uint8_t CursorX(void);
+    uint8_t CursorY(void);
+    // Carácter que muestra la celda según el espejo
+    uint8_t Celda(uint8_t columna, uint8_t fila);
+    // Copia el contenido (fila por fila) a destino; devuelve los bytes copiados
+    size_t Volcar(uint8_t *destino, size_t capacidad);
+
+    TraficoLCD Trafico(void);
+    void ReiniciarTrafico(void);
+
+private:
+    uint8_t columnas, filas;
+    uint8_t cursorX, cursorY;
+    bool escribiendoCGRAM; // La clase base usa write() para cargar los glifos
+    uint8_t espejo[PANTALLA_MAX_FILAS][PANTALLA_MAX_COLUMNAS];
+    TraficoLCD trafico;
+};
+
+// Desarrollo de métodos
+
+PantallaLCD::PantallaLCD(uint8_t direccion, uint8_t columnas, uint8_t filas) : LiquidCrystal_I2C(direccion, columnas, filas)
+{
+    this->columnas = (columnas <= PANTALLA_MAX_COLUMNAS) ? columnas : PANTALLA_MAX_COLUMNAS;
+    this->filas = (filas <= PANTALLA_MAX_FILAS) ? filas : PANTALLA_MAX_FILAS;
+    cursorX = 0;
+    cursorY = 0;
+    escribiendoCGRAM = false;
+    memset(espejo, ' ', sizeof(espejo));
+    ReiniciarTrafico();
+}
+
+void PantallaLCD::clear(void)
+{
+    LiquidCrystal_I2C::clear();
+    trafico.comandos++;
+    memset(espejo, ' ', sizeof(espejo));
+    cursorX = 0;
+    cursorY = 0;
+}
+
+void PantallaLCD::home(void)
+{
+    LiquidCrystal_I2C::home();
+    trafico.comandos++;
+    cursorX = 0;
+    cursorY = 0;
+}
+
+void PantallaLCD::setCursor(uint8_t columna, uint8_t fila)
+{
+    LiquidCrystal_I2C::setCursor(columna, fila);
+    trafico.comandos++;
+    cursorX = columna;
+    cursorY = fila;
+}
+
+void PantallaLCD::createChar(uint8_t posicion, uint8_t mapa[])
+{
+    escribiendoCGRAM = true;
+    LiquidCrystal_I2C::createChar(posicion, mapa);
+    escribiendoCGRAM = false;
+    // La dirección quedó en la CGRAM: el siguiente carácter necesita un setCursor
+    cursorX = PANTALLA_CURSOR_INVALIDO;
+    cursorY = PANTALLA_CURSOR_INVALIDO;
+}
+
+// La clase base no modifica el mapa aunque lo reciba sin const
+void PantallaLCD::createChar(uint8_t posicion, const Glifo &glifo)
+{
+    createChar(posicion, const_cast<uint8_t *>(glifo.filas));
+}
+
+size_t PantallaLCD::write(uint8_t caracter)
+{
+    if (escribiendoCGRAM)
+        return LiquidCrystal_I2C::write(caracter);
+
+    if (cursorX < columnas && cursorY < filas)
+        espejo[cursorY][cursorX] = caracter;
+    cursorX++;
+    trafico.datos++;
+    return LiquidCrystal_I2C::write(caracter);
+}
+
+uint8_t PantallaLCD::Columnas(void)
+{
+    return columnas;
+}
+
+uint8_t PantallaLCD::Filas(void)
+{
+    return filas;
+}
+
+uint8_t PantallaLCD::CursorX(void)
+{
+    return cursorX;
+}
+
+uint8_t PantallaLCD::CursorY(void)
+{
+    return cursorY;
+}
+
+uint8_t PantallaLCD::Celda(uint8_t columna, uint8_t fila)
+{
+    return (columna < columnas && fila < filas) ? espejo[fila][columna] : ' ';
+}
+
+size_t PantallaLCD::Volcar(uint8_t *destino, size_t capacidad)
+{
+    size_t n = 0;
+    for (uint8_t f = 0; f < filas; f++)
+        for (uint8_t c = 0; c < columnas && n < capacidad; c++)
+            destino[n++] = espejo[f][c];
+    return n;
+}
+
+TraficoLCD PantallaLCD::Trafico(void)
+{
+    return trafico;
+}
+
+void PantallaLCD::ReiniciarTrafico(void)
+{
+    trafico.comandos = 0;
+    trafico.datos = 0;
+}
+
+#endif
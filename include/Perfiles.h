@@ -0,0 +1,307 @@
+#ifndef Perfiles_h
+#define Perfiles_h
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <SD.h>
+#include "Bitacora.h"
+
+/*
+ * Perfiles de jugador en la SD, con el nick de tres letras como llave.
+ * El archivo es una tabla hash de PERFILES_CUBETAS cubetas fijas de un sector
+ * cada una; si una cubeta se llena se prueba la siguiente. Buscar o actualizar un
+ * perfil lee una cubeta y escribe sólo el registro que cambió: el archivo se crea
+ * una vez con todas las cubetas vacías y nunca se reescribe completo. Los perfiles
+ * usados recientemente se guardan en una caché LRU en RAM.
+ * Caben PERFILES_CUBETAS * PERFILES_POR_CUBETA perfiles (3200 en 64 KB).
+ */
+
+#define PERFILES_ARCHIVO "/perfiles.idx"
+#define PERFILES_MAGIA 0x46524550UL // "PERF"
+#define PERFILES_CUBETAS 128
+#define PERFILES_POR_CUBETA 25
+#define PERFILES_TAM_SECTOR 512
+#define PERFILES_CACHE 8
+
+// Registro tal como se guarda (little-endian)
+struct __attribute__((packed)) Perfil
+{
+    char nick[4];          // Tres letras y terminador; vacío = ranura libre
+    uint32_t partidas;
+    uint32_t mejorPuntaje;
+    uint32_t diamantes;    // Total de diamantes atrapados
+    uint8_t nivelMaximo;   // Niveles superados en la mejor partida
+    uint8_t reservado[3];
+};
+
+struct __attribute__((packed)) CubetaPerfiles
+{
+    uint32_t magia;
+    uint16_t cuenta;
+    uint8_t reservado[6];
+    Perfil perfiles[PERFILES_POR_CUBETA];
+};
+
+static_assert(sizeof(Perfil) == 20, "El perfil debe medir 20 bytes");
+static_assert(sizeof(CubetaPerfiles) <= PERFILES_TAM_SECTOR, "Una cubeta debe caber en un sector");
+
+class AlmacenPerfiles
+{
+public:
+    AlmacenPerfiles(const char *ruta = PERFILES_ARCHIVO);
+
+    // Abre el archivo o, si no existe, lo crea con todas las cubetas vacías. Uno
+    // existente que no parece válido no se toca: devuelve false
+    bool Iniciar(SemaphoreHandle_t mutexSD);
+
+    // false si el nick no tiene perfil
+    bool Buscar(const char *nick, Perfil *perfil);
+
+    // Suma una partida al perfil (lo crea si no existe) y devuelve el resultado; si no
+    // se pudo escribir devuelve false y la caché no cambia
+    bool RegistrarPartida(const char *nick, uint32_t puntaje, uint8_t niveles, uint32_t diamantes, Perfil *perfil);
+
+    // Aciertos y fallos de la caché desde el arranque
+    uint32_t Aciertos(void);
+    uint32_t Fallos(void);
+
+    // Cubeta donde empieza la búsqueda del nick
+    static uint16_t Hash(const char *nick);
+
+private:
+    struct EntradaCache
+    {
+        Perfil perfil;
+        uint16_t cubeta;
+        uint8_t ranura;
+        uint32_t uso; // Marca de tiempo lógica para la política LRU
+        bool valida;
+    };
+
+    const char *ruta;
+    SemaphoreHandle_t mutexSD;
+    CubetaPerfiles cubeta; // Búfer de trabajo (un sector)
+    EntradaCache cache[PERFILES_CACHE];
+    uint32_t reloj;
+    uint32_t aciertos, fallos;
+
+    EntradaCache *BuscarEnCache(const char *nick);
+    EntradaCache *Cargar(File &archivo, const char *nick, bool crear);
+    bool EscribirPerfil(File &archivo, uint16_t cubeta, uint8_t ranura, const Perfil &perfil);
+    static uint32_t Posicion(uint16_t cubeta);
+};
+
+// Desarrollo de métodos
+
+AlmacenPerfiles::AlmacenPerfiles(const char *ruta)
+{
+    this->ruta = ruta;
+    mutexSD = NULL;
+    memset(cache, 0, sizeof(cache));
+    reloj = 0;
+    aciertos = 0;
+    fallos = 0;
+}
+
+bool AlmacenPerfiles::Iniciar(SemaphoreHandle_t mutexSD)
+{
+    this->mutexSD = mutexSD;
+    bool listo = true;
+
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    if (!SD.exists(ruta))
+    {
+        // Crear la tabla completa una sola vez; después sólo se escriben registros
+        File archivo = SD.open(ruta, FILE_WRITE);
+        uint8_t sector[PERFILES_TAM_SECTOR];
+        memset(sector, 0, sizeof(sector));
+        uint32_t magia = PERFILES_MAGIA;
+        memcpy(sector, &magia, sizeof(magia));
+        for (uint16_t i = 0; archivo && listo && i < PERFILES_CUBETAS; i++)
+            listo = archivo.write(sector, sizeof(sector)) == sizeof(sector);
+        listo = listo && archivo;
+        if (archivo)
+            archivo.close();
+    }
+    else
+    {
+        // Un error de lectura o un archivo ajeno no borra los perfiles que haya
+        File archivo = SD.open(ruta, FILE_READ);
+        listo = archivo && archivo.size() == (size_t)PERFILES_CUBETAS * PERFILES_TAM_SECTOR &&
+                archivo.read((uint8_t *)&cubeta, sizeof(cubeta)) == sizeof(cubeta) && cubeta.magia == PERFILES_MAGIA;
+        if (archivo)
+            archivo.close();
+    }
+    xSemaphoreGive(mutexSD);
+
+    if (!listo)
+        BITACORA(MSG_PERFILES_ERROR);
+    return listo;
+}
+
+bool AlmacenPerfiles::Buscar(const char *nick, Perfil *perfil)
+{
+    EntradaCache *entrada = BuscarEnCache(nick);
+
+    if (entrada == NULL)
+    {
+        xSemaphoreTake(mutexSD, portMAX_DELAY);
+        File archivo = SD.open(ruta, FILE_READ);
+        if (archivo)
+        {
+            entrada = Cargar(archivo, nick, false);
+            archivo.close();
+        }
+        xSemaphoreGive(mutexSD);
+    }
+    if (entrada == NULL)
+        return false;
+
+    *perfil = entrada->perfil;
+    return true;
+}
+
+bool AlmacenPerfiles::RegistrarPartida(const char *nick, uint32_t puntaje, uint8_t niveles, uint32_t diamantes, Perfil *perfil)
+{
+    bool guardado = false;
+
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    File archivo = SD.open(ruta, "r+");
+    if (archivo)
+    {
+        EntradaCache *entrada = BuscarEnCache(nick);
+        if (entrada == NULL)
+            entrada = Cargar(archivo, nick, true);
+        if (entrada != NULL)
+        {
+            // Se modifica una copia: la caché sólo cambia si la SD ya tiene el resultado
+            Perfil p = entrada->perfil;
+            p.partidas++;
+            p.diamantes += diamantes;
+            if (puntaje > p.mejorPuntaje)
+                p.mejorPuntaje = puntaje;
+            if (niveles > p.nivelMaximo)
+                p.nivelMaximo = niveles;
+            guardado = EscribirPerfil(archivo, entrada->cubeta, entrada->ranura, p);
+            if (guardado)
+            {
+                entrada->perfil = p;
+                *perfil = p;
+            }
+            else
+                entrada->valida = false; // Una escritura a medias: volver a leer de la SD
+        }
+        archivo.close();
+    }
+    xSemaphoreGive(mutexSD);
+    return guardado;
+}
+
+uint32_t AlmacenPerfiles::Aciertos(void)
+{
+    return aciertos;
+}
+
+uint32_t AlmacenPerfiles::Fallos(void)
+{
+    return fallos;
+}
+
+AlmacenPerfiles::EntradaCache *AlmacenPerfiles::BuscarEnCache(const char *nick)
+{
+    for (uint8_t i = 0; i < PERFILES_CACHE; i++)
+    {
+        if (cache[i].valida && strncmp(cache[i].perfil.nick, nick, 3) == 0)
+        {
+            cache[i].uso = ++reloj;
+            aciertos++;
+            return &cache[i];
+        }
+    }
+    fallos++;
+    return NULL;
+}
+
+// Busca el nick en su cubeta (y las siguientes si estaban llenas) y lo deja en la
+// caché, reemplazando la entrada usada hace más tiempo. Con 'crear' ocupa una ranura
+// libre: escribe el perfil vacío y después la cuenta de la cubeta, así la cuenta
+// nunca incluye una ranura sin nick.
+AlmacenPerfiles::EntradaCache *AlmacenPerfiles::Cargar(File &archivo, const char *nick, bool crear)
+{
+    uint16_t inicial = Hash(nick);
+
+    for (uint16_t intento = 0; intento < PERFILES_CUBETAS; intento++)
+    {
+        uint16_t c = (inicial + intento) % PERFILES_CUBETAS;
+        if (!archivo.seek(Posicion(c)) || archivo.read((uint8_t *)&cubeta, sizeof(cubeta)) != sizeof(cubeta))
+            return NULL;
+
+        int ranura = -1;
+        for (uint8_t i = 0; i < cubeta.cuenta; i++)
+        {
+            if (strncmp(cubeta.perfiles[i].nick, nick, 3) == 0)
+            {
+                ranura = i;
+                break;
+            }
+        }
+
+        if (ranura < 0 && cubeta.cuenta < PERFILES_POR_CUBETA)
+        {
+            // Sin borrados, una cubeta con espacio termina la búsqueda
+            if (!crear)
+                return NULL;
+            ranura = cubeta.cuenta++;
+            Perfil &nuevo = cubeta.perfiles[ranura];
+            memset(&nuevo, 0, sizeof(nuevo));
+            strncpy(nuevo.nick, nick, 3);
+            if (!EscribirPerfil(archivo, c, ranura, nuevo) ||
+                !archivo.seek(Posicion(c) + offsetof(CubetaPerfiles, cuenta)) ||
+                archivo.write((const uint8_t *)&cubeta.cuenta, sizeof(cubeta.cuenta)) != sizeof(cubeta.cuenta))
+                return NULL;
+        }
+
+        if (ranura >= 0)
+        {
+            EntradaCache *victima = &cache[0];
+            for (uint8_t i = 1; i < PERFILES_CACHE; i++)
+            {
+                if (!victima->valida)
+                    break;
+                if (!cache[i].valida || cache[i].uso < victima->uso)
+                    victima = &cache[i];
+            }
+            victima->perfil = cubeta.perfiles[ranura];
+            victima->cubeta = c;
+            victima->ranura = ranura;
+            victima->uso = ++reloj;
+            victima->valida = true;
+            return victima;
+        }
+    }
+    return NULL; // Tabla llena
+}
+
+bool AlmacenPerfiles::EscribirPerfil(File &archivo, uint16_t cubeta, uint8_t ranura, const Perfil &perfil)
+{
+    uint32_t posicion = Posicion(cubeta) + offsetof(CubetaPerfiles, perfiles) + ranura * sizeof(Perfil);
+    return archivo.seek(posicion) && archivo.write((const uint8_t *)&perfil, sizeof(Perfil)) == sizeof(Perfil);
+}
+
+// Las tres letras forman un número de 0 a 26^3 - 1 que se dispersa de forma multiplicativa
+uint16_t AlmacenPerfiles::Hash(const char *nick)
+{
+    uint32_t llave = 0;
+    for (uint8_t i = 0; i < 3; i++)
+        llave = llave * 26 + (uint8_t)(nick[i] - 'A') % 26;
+    return ((uint32_t)(llave * 2654435761UL) >> 16) % PERFILES_CUBETAS;
+}
+
+uint32_t AlmacenPerfiles::Posicion(uint16_t cubeta)
+{
+    return (uint32_t)cubeta * PERFILES_TAM_SECTOR;
+}
+
+#endif
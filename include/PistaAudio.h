@@ -0,0 +1,355 @@
+#ifndef PistaAudio_h
+#define PistaAudio_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <SD.h>
+#include <atomic>
+#include "Mezclador.h"
+
+/*
+ * Pistas de música precodificadas para el mezclador.
+ * tools/transcodificar.py convierte cada pista (WAV) a un archivo .adp: un sector de
+ * cabecera, una tabla de búsqueda y los datos en bloques de 512 bytes, un sector de
+ * la SD cada uno. Los bloques son IMA-ADPCM (4 bits por muestra, cada uno empieza con
+ * su propio predictor e índice, así que se decodifica sin contexto) o PCM de 16 bits.
+ * La tabla de búsqueda da el desplazamiento de uno de cada 'intervaloBusqueda'
+ * bloques; con ella se salta al inicio del bucle sin recorrer el archivo.
+ *
+ * La MusicTask lee bloques de la SD a un anillo en RAM (Rellenar) y la tarea de audio
+ * los decodifica según los pide el mezclador (Fuente). Productor y consumidor no se
+ * bloquean: si el anillo se vacía, el mezclador recibe silencio y se cuenta un
+ * faltante. Decodificar un bloque ADPCM cuesta unas pocas decenas de miles de
+ * ciclos por 46 ms de audio (ver adpcm_bloque_ciclos en el benchmark).
+ */
+
+#define PISTA_MAGIA 0x50444150UL // "PADP"
+#define PISTA_VERSION 1
+#define PISTA_TAM_SECTOR 512
+#define PISTA_TAM_BLOQUE 512
+#define PISTA_MAX_MUESTRAS ((PISTA_TAM_BLOQUE - 4) * 2 + 1) // Muestras de un bloque ADPCM
+#define PISTA_RANURAS 8 // Bloques en el anillo (~370 ms de audio en ADPCM)
+#define PISTA_SIN_BUCLE 0xFFFFFFFFUL
+
+enum CodecPista
+{
+    CODEC_PCM16 = 0,
+    CODEC_IMA_ADPCM = 1
+};
+
+// Cabecera tal como se guarda (little-endian), ocupa el primer sector
+struct __attribute__((packed)) CabeceraPista
+{
+    uint32_t magia;
+    uint8_t version;
+    uint8_t codec;
+    uint16_t bytesPorBloque;
+    uint32_t frecuencia;
+    uint32_t muestrasPorBloque;
+    uint32_t totalMuestras;
+    uint32_t bloques;
+    uint32_t inicioBucle; // Muestra a la que se vuelve, o PISTA_SIN_BUCLE
+    uint32_t finBucle;    // Muestra (exclusiva) donde se vuelve al inicio
+    uint32_t intervaloBusqueda; // Bloques entre entradas de la tabla
+    uint32_t entradasBusqueda;
+    uint32_t desplazamientoBusqueda; // Tabla: uint32 con el desplazamiento de cada bloque i*intervalo
+    uint32_t desplazamientoDatos;
+    uint8_t reservado[PISTA_TAM_SECTOR - 48];
+};
+
+static_assert(sizeof(CabeceraPista) == PISTA_TAM_SECTOR, "La cabecera de la pista debe medir un sector");
+
+// Un bloque en el anillo con el rango de muestras que se debe reproducir
+struct RanuraPista
+{
+    uint16_t desde, hasta;
+    uint16_t bytes;
+    uint8_t codec; // Viaja con el bloque: el anillo puede tener bloques de dos pistas
+    uint8_t datos[PISTA_TAM_BLOQUE];
+};
+
+static const int16_t tablaPasosIMA[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767};
+
+static const int8_t tablaIndicesIMA[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+// Decodifica un bloque IMA-ADPCM mono (cabecera de 4 bytes, nibble bajo primero).
+// Devuelve las muestras escritas: (bytes - 4) * 2 + 1
+size_t DecodificarBloqueIMA(const uint8_t *bloque, size_t bytes, int16_t *destino)
+{
+    if (bytes < 4)
+        return 0;
+
+    int32_t predictor = (int16_t)(bloque[0] | (bloque[1] << 8));
+    int32_t indice = bloque[2];
+    if (indice > 88)
+        indice = 88;
+
+    size_t n = 0;
+    destino[n++] = (int16_t)predictor;
+    for (size_t i = 4; i < bytes; i++)
+    {
+        for (uint8_t mitad = 0; mitad < 2; mitad++)
+        {
+            uint8_t nibble = mitad ? (bloque[i] >> 4) : (bloque[i] & 0x0F);
+            int32_t paso = tablaPasosIMA[indice];
+            int32_t diferencia = paso >> 3;
+            if (nibble & 4)
+                diferencia += paso;
+            if (nibble & 2)
+                diferencia += paso >> 1;
+            if (nibble & 1)
+                diferencia += paso >> 2;
+            predictor += (nibble & 8) ? -diferencia : diferencia;
+            if (predictor > 32767)
+                predictor = 32767;
+            else if (predictor < -32768)
+                predictor = -32768;
+
+            indice += tablaIndicesIMA[nibble];
+            if (indice < 0)
+                indice = 0;
+            else if (indice > 88)
+                indice = 88;
+
+            destino[n++] = (int16_t)predictor;
+        }
+    }
+    return n;
+}
+
+class ReproductorPista
+{
+public:
+    ReproductorPista();
+
+    void Iniciar(SemaphoreHandle_t mutexSD);
+
+    // Productor (MusicTask). Abrir descarta lo que quede de la pista anterior en el anillo
+    bool Abrir(const char *ruta);
+    void Cerrar(void);
+    void Rellenar(void); // Lee de la SD los bloques que quepan en el anillo
+    bool Activa(void);   // Hay una pista abierta que aún no llega a su final
+
+    // Consumidor (tarea de audio): se entrega al mezclador como FuenteAudio con 'this'
+    static size_t Fuente(void *contexto, int16_t *destino, size_t muestras);
+
+    uint32_t Faltantes(void); // Bloques del mezclador rellenados con silencio por anillo vacío
+
+private:
+    SemaphoreHandle_t mutexSD;
+    File archivo;
+    CabeceraPista cabecera;
+    uint32_t bloque;  // Siguiente bloque que se leerá del archivo
+    bool saltoBucle;  // El siguiente bloque es el de reentrada al bucle
+
+    RanuraPista ranuras[PISTA_RANURAS];
+    std::atomic<uint32_t> escritos, leidos;
+    std::atomic<bool> vaciar;    // El consumidor debe descartar el anillo antes de seguir
+    std::atomic<bool> terminada; // El productor ya entregó el último bloque
+
+    // Estado del consumidor
+    int16_t decodificado[PISTA_MAX_MUESTRAS];
+    uint16_t posicion, limite;
+    std::atomic<uint32_t> faltantes;
+
+    bool CabeceraValida(void);
+    bool Buscar(uint32_t muestra);
+    void Decodificar(const RanuraPista &ranura);
+};
+
+// Desarrollo de métodos
+
+ReproductorPista::ReproductorPista()
+    : escritos(0), leidos(0), vaciar(false), terminada(true), faltantes(0)
+{
+    mutexSD = NULL;
+    memset(&cabecera, 0, sizeof(cabecera));
+    bloque = 0;
+    saltoBucle = false;
+    posicion = 0;
+    limite = 0;
+}
+
+void ReproductorPista::Iniciar(SemaphoreHandle_t mutexSD)
+{
+    this->mutexSD = mutexSD;
+}
+
+bool ReproductorPista::Abrir(const char *ruta)
+{
+    Cerrar();
+
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    archivo = SD.open(ruta, FILE_READ);
+    bool valida = archivo && archivo.read((uint8_t *)&cabecera, sizeof(cabecera)) == sizeof(cabecera) &&
+                  CabeceraValida() && archivo.seek(cabecera.desplazamientoDatos);
+    if (!valida && archivo)
+        archivo.close();
+    xSemaphoreGive(mutexSD);
+    if (!valida)
+        return false;
+
+    bloque = 0;
+    saltoBucle = false;
+    // Rellenar no escribe en el anillo hasta que el consumidor atienda 'vaciar'
+    terminada = false;
+    vaciar = true;
+    return true;
+}
+
+void ReproductorPista::Cerrar(void)
+{
+    if (archivo)
+    {
+        xSemaphoreTake(mutexSD, portMAX_DELAY);
+        archivo.close();
+        xSemaphoreGive(mutexSD);
+    }
+    terminada = true;
+    vaciar = true;
+}
+
+bool ReproductorPista::Activa(void)
+{
+    return archivo && !terminada;
+}
+
+void ReproductorPista::Rellenar(void)
+{
+    if (!archivo || terminada || vaciar)
+        return;
+    uint32_t libres = PISTA_RANURAS - (escritos - leidos);
+    if (libres == 0)
+        return;
+
+    uint32_t fin = (cabecera.inicioBucle != PISTA_SIN_BUCLE) ? cabecera.finBucle : cabecera.totalMuestras;
+
+    xSemaphoreTake(mutexSD, portMAX_DELAY);
+    for (; libres > 0; libres--)
+    {
+        RanuraPista &ranura = ranuras[escritos % PISTA_RANURAS];
+        if (archivo.read(ranura.datos, cabecera.bytesPorBloque) != cabecera.bytesPorBloque)
+        {
+            terminada = true; // Archivo truncado: se reproduce lo que ya está en el anillo
+            break;
+        }
+
+        uint32_t inicio = bloque * cabecera.muestrasPorBloque;
+        ranura.bytes = cabecera.bytesPorBloque;
+        ranura.codec = cabecera.codec;
+        ranura.desde = saltoBucle ? cabecera.inicioBucle - inicio : 0;
+        ranura.hasta = (fin - inicio < cabecera.muestrasPorBloque) ? fin - inicio : cabecera.muestrasPorBloque;
+        saltoBucle = false;
+        escritos++; // Publica la ranura ya escrita
+        bloque++;
+
+        if (bloque * cabecera.muestrasPorBloque >= fin)
+        {
+            if (cabecera.inicioBucle == PISTA_SIN_BUCLE || !Buscar(cabecera.inicioBucle))
+            {
+                terminada = true;
+                break;
+            }
+            saltoBucle = true;
+        }
+    }
+    xSemaphoreGive(mutexSD);
+}
+
+uint32_t ReproductorPista::Faltantes(void)
+{
+    return faltantes;
+}
+
+bool ReproductorPista::CabeceraValida(void)
+{
+    const CabeceraPista &c = cabecera;
+    if (c.magia != PISTA_MAGIA || c.version != PISTA_VERSION || c.frecuencia != MEZCLADOR_FRECUENCIA)
+        return false;
+    if (c.bytesPorBloque < 4 || c.bytesPorBloque > PISTA_TAM_BLOQUE || c.totalMuestras == 0 || c.intervaloBusqueda == 0)
+        return false;
+
+    uint32_t muestras = (c.codec == CODEC_IMA_ADPCM) ? (c.bytesPorBloque - 4) * 2 + 1 : c.bytesPorBloque / 2;
+    if ((c.codec != CODEC_IMA_ADPCM && c.codec != CODEC_PCM16) || c.muestrasPorBloque != muestras)
+        return false;
+
+    return c.inicioBucle == PISTA_SIN_BUCLE || (c.inicioBucle < c.finBucle && c.finBucle <= c.totalMuestras);
+}
+
+// Coloca el archivo en el bloque que contiene 'muestra' (con el mutex de la SD tomado)
+bool ReproductorPista::Buscar(uint32_t muestra)
+{
+    uint32_t destino = muestra / cabecera.muestrasPorBloque;
+    uint32_t entrada = destino / cabecera.intervaloBusqueda;
+    uint32_t desplazamiento;
+    if (entrada >= cabecera.entradasBusqueda ||
+        !archivo.seek(cabecera.desplazamientoBusqueda + entrada * sizeof(uint32_t)) ||
+        archivo.read((uint8_t *)&desplazamiento, sizeof(desplazamiento)) != sizeof(desplazamiento))
+        return false;
+
+    desplazamiento += (destino % cabecera.intervaloBusqueda) * cabecera.bytesPorBloque;
+    if (!archivo.seek(desplazamiento))
+        return false;
+    bloque = destino;
+    return true;
+}
+
+void ReproductorPista::Decodificar(const RanuraPista &ranura)
+{
+    if (ranura.codec == CODEC_IMA_ADPCM)
+        DecodificarBloqueIMA(ranura.datos, ranura.bytes, decodificado);
+    else
+        memcpy(decodificado, ranura.datos, ranura.bytes);
+    posicion = ranura.desde;
+    limite = ranura.hasta;
+}
+
+size_t ReproductorPista::Fuente(void *contexto, int16_t *destino, size_t muestras)
+{
+    ReproductorPista *p = (ReproductorPista *)contexto;
+
+    if (p->vaciar)
+    {
+        p->leidos.store(p->escritos.load());
+        p->posicion = 0;
+        p->limite = 0;
+        p->vaciar = false;
+    }
+
+    size_t n = 0;
+    while (n < muestras)
+    {
+        if (p->posicion >= p->limite)
+        {
+            if (p->leidos == p->escritos)
+            {
+                if (p->terminada)
+                    return n; // Fin de la pista: el mezclador libera la voz
+                memset(destino + n, 0, (muestras - n) * sizeof(int16_t));
+                p->faltantes++;
+                return muestras;
+            }
+            p->Decodificar(p->ranuras[p->leidos % PISTA_RANURAS]);
+            p->leidos++; // La ranura ya se copió a 'decodificado'
+            continue;
+        }
+
+        size_t copia = p->limite - p->posicion;
+        if (copia > muestras - n)
+            copia = muestras - n;
+        memcpy(destino + n, p->decodificado + p->posicion, copia * sizeof(int16_t));
+        p->posicion += copia;
+        n += copia;
+    }
+    return n;
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef Reloj_h
+#define Reloj_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+/*
+ * Reloj del juego.
+ * Tiempo monótono de 64 bits que se detiene con Pausar(), conserva lo transcurrido
+ * al reanudar y avanza a una escala configurable: 0 lo congela, RELOJ_ESCALA_UNIDAD
+ * es tiempo real y RELOJ_ESCALA_MAXIMA (1000x) sirve para simulaciones aceleradas.
+ * Los temporizadores con nombre miden plazos en tiempo de juego. La entrada
+ * (antirrebote y repetición) sigue en tiempo real porque la maneja una persona.
+ */
+
+#define RELOJ_ESCALA_UNIDAD 1000     // Escala en milésimas: 1000 = tiempo real
+#define RELOJ_ESCALA_MAXIMA 1000000  // 1000x
+#define RELOJ_MAX_TEMPORIZADORES 8
+#define RELOJ_ESPERA_MAXIMA 50       // ms reales máximos por bloqueo, para notar pausas y cambios de escala
+
+typedef int8_t TemporizadorJuego;
+
+class RelojJuego
+{
+public:
+    RelojJuego();
+
+    // Milisegundos de juego desde el arranque
+    uint64_t Ahora(void);
+
+    void Pausar(void);
+    void Reanudar(void);
+    bool Pausado(void);
+
+    void ConfigurarEscala(uint32_t milesimas);
+    uint32_t Escala(void);
+
+    // Temporizadores con nombre; devuelve el existente si el nombre ya se registró
+    TemporizadorJuego Temporizador(const char *nombre);
+    // 'transcurrido' permite reprogramar un plazo que ya había avanzado (al restaurar)
+    void Programar(TemporizadorJuego t, uint32_t duracion, uint32_t transcurrido = 0);
+    bool Vencido(TemporizadorJuego t);
+    uint32_t Restante(TemporizadorJuego t);
+    uint32_t Transcurrido(TemporizadorJuego t); // Desde el último Programar()
+
+    // Ticks reales que faltan para que venza el temporizador (a lo más RELOJ_ESPERA_MAXIMA ms)
+    TickType_t TicksHasta(TemporizadorJuego t);
+
+    // Bloquea la tarea durante 'duracion' ms de juego
+    void Esperar(uint32_t duracion);
+
+private:
+    struct DatosTemporizador
+    {
+        const char *nombre;
+        uint64_t inicio; // us de juego
+        uint64_t limite;
+    };
+
+    // Ancla: el tiempo de juego era 'anclaJuego' cuando el real era 'anclaReal'
+    int64_t anclaReal;
+    uint64_t anclaJuego;
+    uint32_t escala;
+    bool pausado;
+    portMUX_TYPE candado;
+    DatosTemporizador temporizadores[RELOJ_MAX_TEMPORIZADORES];
+    uint8_t numTemporizadores;
+
+    uint64_t AhoraUs(void);
+    uint64_t AhoraUsSinCandado(void);
+    void Reanclar(void);
+    TickType_t TicksHastaUs(uint64_t limite);
+};
+
+// Desarrollo de métodos
+
+RelojJuego::RelojJuego()
+{
+    anclaReal = 0;
+    anclaJuego = 0;
+    escala = RELOJ_ESCALA_UNIDAD;
+    pausado = false;
+    portMUX_INITIALIZE(&candado);
+    numTemporizadores = 0;
+}
+
+uint64_t RelojJuego::Ahora(void)
+{
+    return AhoraUs() / 1000;
+}
+
+void RelojJuego::Pausar(void)
+{
+    portENTER_CRITICAL(&candado);
+    Reanclar();
+    pausado = true;
+    portEXIT_CRITICAL(&candado);
+}
+
+void RelojJuego::Reanudar(void)
+{
+    portENTER_CRITICAL(&candado);
+    Reanclar();
+    pausado = false;
+    portEXIT_CRITICAL(&candado);
+}
+
+bool RelojJuego::Pausado(void)
+{
+    return pausado;
+}
+
+void RelojJuego::ConfigurarEscala(uint32_t milesimas)
+{
+    if (milesimas > RELOJ_ESCALA_MAXIMA)
+        milesimas = RELOJ_ESCALA_MAXIMA;
+
+    portENTER_CRITICAL(&candado);
+    Reanclar();
+    escala = milesimas;
+    portEXIT_CRITICAL(&candado);
+}
+
+uint32_t RelojJuego::Escala(void)
+{
+    return escala;
+}
+
+// Los temporizadores deben registrarse desde una sola tarea (al configurar)
+TemporizadorJuego RelojJuego::Temporizador(const char *nombre)
+{
+    for (uint8_t i = 0; i < numTemporizadores; i++)
+    {
+        if (strcmp(temporizadores[i].nombre, nombre) == 0)
+            return i;
+    }
+    if (numTemporizadores >= RELOJ_MAX_TEMPORIZADORES)
+        return -1;
+
+    DatosTemporizador &t = temporizadores[numTemporizadores];
+    t.nombre = nombre;
+    t.inicio = 0;
+    t.limite = 0;
+    return numTemporizadores++;
+}
+
+void RelojJuego::Programar(TemporizadorJuego t, uint32_t duracion, uint32_t transcurrido)
+{
+    uint64_t inicio = AhoraUs() - (uint64_t)transcurrido * 1000;
+    temporizadores[t].inicio = inicio;
+    temporizadores[t].limite = inicio + (uint64_t)duracion * 1000;
+}
+
+bool RelojJuego::Vencido(TemporizadorJuego t)
+{
+    return AhoraUs() >= temporizadores[t].limite;
+}
+
+uint32_t RelojJuego::Restante(TemporizadorJuego t)
+{
+    uint64_t ahora = AhoraUs();
+    uint64_t limite = temporizadores[t].limite;
+    return (ahora >= limite) ? 0 : (limite - ahora) / 1000;
+}
+
+uint32_t RelojJuego::Transcurrido(TemporizadorJuego t)
+{
+    return (AhoraUs() - temporizadores[t].inicio) / 1000;
+}
+
+TickType_t RelojJuego::TicksHasta(TemporizadorJuego t)
+{
+    return TicksHastaUs(temporizadores[t].limite);
+}
+
+void RelojJuego::Esperar(uint32_t duracion)
+{
+    uint64_t limite = AhoraUs() + (uint64_t)duracion * 1000;
+
+    while (AhoraUs() < limite)
+    {
+        TickType_t ticks = TicksHastaUs(limite);
+        if (ticks == 0)
+            taskYIELD();
+        else
+            vTaskDelay(ticks);
+    }
+}
+
+uint64_t RelojJuego::AhoraUs(void)
+{
+    portENTER_CRITICAL(&candado);
+    uint64_t ahora = AhoraUsSinCandado();
+    portEXIT_CRITICAL(&candado);
+    return ahora;
+}
+
+uint64_t RelojJuego::AhoraUsSinCandado(void)
+{
+    if (pausado || escala == 0)
+        return anclaJuego;
+    uint64_t real = esp_timer_get_time() - anclaReal;
+    return anclaJuego + real * escala / RELOJ_ESCALA_UNIDAD;
+}
+
+// Fija el tiempo de juego acumulado antes de cambiar la pausa o la escala
+void RelojJuego::Reanclar(void)
+{
+    anclaJuego = AhoraUsSinCandado();
+    anclaReal = esp_timer_get_time();
+}
+
+// Convierte lo que falta en tiempo de juego a ticks reales. En tiempo real o más lento
+// espera al menos un tick; acelerado puede devolver 0 para sólo ceder el CPU.
+TickType_t RelojJuego::TicksHastaUs(uint64_t limite)
+{
+    const TickType_t maximo = RELOJ_ESPERA_MAXIMA / portTICK_PERIOD_MS;
+    uint64_t ahora = AhoraUs();
+    uint32_t escala = this->escala;
+
+    if (ahora >= limite)
+        return 0;
+    if (pausado || escala == 0)
+        return maximo;
+
+    uint64_t realUs = (limite - ahora) * RELOJ_ESCALA_UNIDAD / escala;
+    uint64_t ticks = realUs / (portTICK_PERIOD_MS * 1000ULL);
+    if (ticks == 0 && escala <= RELOJ_ESCALA_UNIDAD)
+        ticks = 1;
+    return (ticks > maximo) ? maximo : (TickType_t)ticks;
+}
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef Renderizador_h
+#define Renderizador_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Pantalla.h"
+
+/*
+ * Renderizado en una tarea aparte.
+ * La lógica dibuja con la misma interfaz de la LCD (clear, setCursor, print, blink,
+ * scrollDisplay...) pero sobre un cuadro en RAM, y lo entrega con Presentar(). La
+ * tarea de render toma el último cuadro entregado y envía a la LCD sólo las celdas
+ * que difieren de lo que ya muestra; si la lógica entrega otro antes de que el
+ * anterior llegue a la pantalla, el anterior se descarta. Así la lógica nunca
+ * espera al bus I2C.
+ * Los glifos de la CGRAM se cargan una sola vez al iniciar, directamente en la LCD.
+ */
+
+#define RENDER_PILA 3072
+
+// Descripción completa de lo que debe verse en la pantalla
+struct CuadroLCD
+{
+    uint8_t celdas[PANTALLA_MAX_FILAS][PANTALLA_MAX_COLUMNAS];
+    uint8_t cursorX, cursorY; // Posición del cursor parpadeante
+    bool parpadeo;
+    int8_t desplazamiento;    // Columnas desplazadas con scrollDisplayRight (negativo: izquierda)
+    uint32_t traza;           // Traza de latencia que viaja con el cuadro (0: ninguna)
+    uint32_t presentado;      // micros() del Presentar que entregó la traza
+};
+
+// Avisa que el cuadro con la traza dada terminó de enviarse a la LCD (desde la tarea de render)
+typedef void (*AvisoCuadroMostrado)(void *contexto, uint32_t traza, uint32_t presentadoUs, uint32_t envioUs, uint32_t finUs);
+
+struct EstadisticasRender
+{
+    uint32_t producidos;  // Cuadros entregados por la lógica
+    uint32_t mostrados;   // Cuadros enviados a la LCD
+    uint32_t descartados; // Reemplazados por uno más nuevo antes de mostrarse
+};
+
+class Renderizador : public Print
+{
+public:
+    Renderizador(PantallaLCD *lcd);
+
+    // La LCD ya debe estar iniciada y con sus glifos cargados
+    void Iniciar(UBaseType_t prioridad, BaseType_t nucleo);
+
+    // Composición del cuadro (sólo desde la tarea de lógica)
+    void clear(void);
+    void home(void);
+    void setCursor(uint8_t columna, uint8_t fila);
+    virtual size_t write(uint8_t caracter);
+    using Print::write;
+    void blink(void);
+    void noBlink(void);
+    void scrollDisplayLeft(void);
+    void scrollDisplayRight(void);
+
+    // Entrega el cuadro compuesto a la tarea de render; se puede seguir dibujando sobre él
+    void Presentar(void);
+
+    // Etiqueta el cuadro en composición con una traza de latencia; Presentar le pone la
+    // hora de entrega. Si el cuadro se descarta, la traza pasa al que lo reemplaza (se
+    // conserva la más antigua con su hora)
+    void Trazar(uint32_t traza);
+    void AlMostrar(AvisoCuadroMostrado aviso, void *contexto);
+
+    uint8_t Columnas(void);
+    uint8_t Filas(void);
+    // Copia el último cuadro entregado (fila por fila); devuelve los bytes copiados
+    size_t Volcar(uint8_t *destino, size_t capacidad);
+    // true mientras haya un cuadro entregado que aún no termina de llegar a la LCD
+    bool Pendiente(void);
+
+    EstadisticasRender Estadisticas(void);
+
+private:
+    PantallaLCD *lcd;
+    CuadroLCD trabajo;   // Lo compone la lógica
+    CuadroLCD entregado; // Último cuadro terminado, lo toma la tarea de render
+    bool hayEntregado;
+    bool enviando; // La tarea de render está enviando un cuadro a la LCD
+    uint8_t cursorX, cursorY;
+    portMUX_TYPE candado;
+    TaskHandle_t tarea;
+    EstadisticasRender estadisticas;
+    AvisoCuadroMostrado aviso;
+    void *contextoAviso;
+
+    // Estado de la LCD que no refleja PantallaLCD (sólo los usa la tarea de render)
+    bool parpadeoLCD;
+    int8_t desplazamientoLCD;
+
+    void Refrescar(const CuadroLCD &cuadro);
+    static void TareaRender(void *pvParameters);
+};
+
+// Desarrollo de métodos
+
+Renderizador::Renderizador(PantallaLCD *lcd)
+{
+    this->lcd = lcd;
+    memset(&trabajo, 0, sizeof(trabajo));
+    memset(trabajo.celdas, ' ', sizeof(trabajo.celdas));
+    entregado = trabajo;
+    hayEntregado = false;
+    enviando = false;
+    cursorX = 0;
+    cursorY = 0;
+    portMUX_INITIALIZE(&candado);
+    tarea = NULL;
+    memset(&estadisticas, 0, sizeof(estadisticas));
+    aviso = NULL;
+    contextoAviso = NULL;
+    parpadeoLCD = false;
+    desplazamientoLCD = 0;
+}
+
+void Renderizador::Iniciar(UBaseType_t prioridad, BaseType_t nucleo)
+{
+    xTaskCreatePinnedToCore(
+        TareaRender,
+        "Render",
+        RENDER_PILA,
+        this,
+        prioridad,
+        &tarea,
+        nucleo);
+}
+
+void Renderizador::clear(void)
+{
+    memset(trabajo.celdas, ' ', sizeof(trabajo.celdas));
+    trabajo.desplazamiento = 0; // Como en la LCD, borrar también quita el desplazamiento
+    cursorX = 0;
+    cursorY = 0;
+}
+
+void Renderizador::home(void)
+{
+    trabajo.desplazamiento = 0;
+    cursorX = 0;
+    cursorY = 0;
+}
+
+void Renderizador::setCursor(uint8_t columna, uint8_t fila)
+{
+    cursorX = columna;
+    cursorY = fila;
+}
+
+size_t Renderizador::write(uint8_t caracter)
+{
+    if (cursorX < lcd->Columnas() && cursorY < lcd->Filas())
+        trabajo.celdas[cursorY][cursorX] = caracter;
+    cursorX++;
+    return 1;
+}
+
+void Renderizador::blink(void)
+{
+    trabajo.parpadeo = true;
+}
+
+void Renderizador::noBlink(void)
+{
+    trabajo.parpadeo = false;
+}
+
+void Renderizador::scrollDisplayLeft(void)
+{
+    trabajo.desplazamiento--;
+}
+
+void Renderizador::scrollDisplayRight(void)
+{
+    trabajo.desplazamiento++;
+}
+
+void Renderizador::Presentar(void)
+{
+    trabajo.cursorX = cursorX;
+    trabajo.cursorY = cursorY;
+    if (trabajo.traza != 0)
+        trabajo.presentado = micros();
+
+    portENTER_CRITICAL(&candado);
+    if (hayEntregado)
+    {
+        estadisticas.descartados++;
+        if (entregado.traza != 0)
+        {
+            trabajo.traza = entregado.traza;
+            trabajo.presentado = entregado.presentado;
+        }
+    }
+    entregado = trabajo;
+    hayEntregado = true;
+    estadisticas.producidos++;
+    portEXIT_CRITICAL(&candado);
+    trabajo.traza = 0;
+
+    if (tarea != NULL)
+        xTaskNotifyGive(tarea);
+}
+
+void Renderizador::Trazar(uint32_t traza)
+{
+    trabajo.traza = traza;
+}
+
+void Renderizador::AlMostrar(AvisoCuadroMostrado aviso, void *contexto)
+{
+    this->contextoAviso = contexto;
+    this->aviso = aviso;
+}
+
+uint8_t Renderizador::Columnas(void)
+{
+    return lcd->Columnas();
+}
+
+uint8_t Renderizador::Filas(void)
+{
+    return lcd->Filas();
+}
+
+size_t Renderizador::Volcar(uint8_t *destino, size_t capacidad)
+{
+    size_t n = 0;
+    portENTER_CRITICAL(&candado);
+    for (uint8_t f = 0; f < lcd->Filas(); f++)
+        for (uint8_t c = 0; c < lcd->Columnas() && n < capacidad; c++)
+            destino[n++] = entregado.celdas[f][c];
+    portEXIT_CRITICAL(&candado);
+    return n;
+}
+
+bool Renderizador::Pendiente(void)
+{
+    return hayEntregado || enviando;
+}
+
+EstadisticasRender Renderizador::Estadisticas(void)
+{
+    portENTER_CRITICAL(&candado);
+    EstadisticasRender copia = estadisticas;
+    portEXIT_CRITICAL(&candado);
+    return copia;
+}
+
+// Envía sólo las diferencias entre el cuadro y el espejo de la LCD. Las celdas
+// contiguas aprovechan el autoincremento del HD44780 y no repiten setCursor.
+void Renderizador::Refrescar(const CuadroLCD &cuadro)
+{
+    for (uint8_t f = 0; f < lcd->Filas(); f++)
+    {
+        for (uint8_t c = 0; c < lcd->Columnas(); c++)
+        {
+            uint8_t caracter = cuadro.celdas[f][c];
+            if (lcd->Celda(c, f) == caracter)
+                continue;
+            if (lcd->CursorX() != c || lcd->CursorY() != f)
+                lcd->setCursor(c, f);
+            lcd->write(caracter);
+        }
+    }
+
+    for (; desplazamientoLCD < cuadro.desplazamiento; desplazamientoLCD++)
+        lcd->scrollDisplayRight();
+    for (; desplazamientoLCD > cuadro.desplazamiento; desplazamientoLCD--)
+        lcd->scrollDisplayLeft();
+
+    if (cuadro.parpadeo)
+    {
+        if (lcd->CursorX() != cuadro.cursorX || lcd->CursorY() != cuadro.cursorY)
+            lcd->setCursor(cuadro.cursorX, cuadro.cursorY);
+        if (!parpadeoLCD)
+            lcd->blink();
+    }
+    else if (parpadeoLCD)
+    {
+        lcd->noBlink();
+    }
+    parpadeoLCD = cuadro.parpadeo;
+}
+
+// Duerme hasta que se entrega un cuadro; si llegaron varios sólo muestra el último
+void Renderizador::TareaRender(void *pvParameters)
+{
+    Renderizador *r = (Renderizador *)pvParameters;
+    CuadroLCD cuadro;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        portENTER_CRITICAL(&r->candado);
+        bool hay = r->hayEntregado;
+        if (hay)
+        {
+            cuadro = r->entregado;
+            r->hayEntregado = false;
+            r->enviando = true;
+        }
+        portEXIT_CRITICAL(&r->candado);
+        if (!hay)
+            continue;
+
+        // Un cuadro entregado durante el envío queda pendiente y su notificación ya está dada
+        uint32_t envio = micros();
+        r->Refrescar(cuadro);
+        if (cuadro.traza != 0 && r->aviso != NULL)
+            r->aviso(r->contextoAviso, cuadro.traza, cuadro.presentado, envio, micros());
+
+        portENTER_CRITICAL(&r->candado);
+        r->estadisticas.mostrados++;
+        r->enviando = false;
+        portEXIT_CRITICAL(&r->candado);
+    }
+}
+
+#endif
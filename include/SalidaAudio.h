@@ -0,0 +1,260 @@
+#ifndef SalidaAudio_h
+#define SalidaAudio_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <driver/i2s.h>
+#include "Mezclador.h"
+#include "Bitacora.h"
+
+/*
+ * Salida de audio por I2S.
+ * Una tarea mezcla un bloque con el Mezclador y lo escribe en el DMA del I2S; la
+ * escritura bloquea hasta que hay un búfer libre, así que el DMA marca el ritmo. Los
+ * demás núcleos no tocan el mezclador: piden efectos y cambios de música por una
+ * cola que la tarea aplica entre bloques. Sin voces activas la tarea deja el DMA en
+ * silencio y duerme en la cola.
+ * Requiere un DAC/amplificador I2S (p. ej. MAX98357A) en los pines I2S_*; se activa
+ * con -DAUDIO_I2S. Sin esa bandera los efectos siguen sonando en el buzzer.
+ */
+
+#define AUDIO_I2S_PUERTO I2S_NUM_0
+#define AUDIO_DMA_BUFERES 4
+#define AUDIO_COLA 8
+#define AUDIO_PILA 4096
+#define AUDIO_VOLUMEN_EFECTOS 20000 // Q15
+#define AUDIO_VOLUMEN_MUSICA 16000
+
+enum TipoComandoAudio
+{
+    AUDIO_TONO,
+    AUDIO_MUESTRA,
+    AUDIO_MUSICA,
+    AUDIO_DETENER_MUSICA,
+    AUDIO_VOLUMEN_MUSICA_CMD,
+    AUDIO_MAESTRO
+};
+
+struct ComandoAudio
+{
+    TipoComandoAudio tipo;
+    uint16_t volumen;
+    int16_t pan;
+    uint16_t frecuencia;
+    uint32_t duracion; // ms del tono o muestras de la muestra
+    const int16_t *datos;
+    FuenteAudio fuente;
+    void *contexto;
+};
+
+class SalidaAudio
+{
+public:
+    SalidaAudio(uint8_t pinBCLK, uint8_t pinLRC, uint8_t pinDOUT);
+
+    void Iniciar(UBaseType_t prioridad, BaseType_t nucleo);
+
+    // No bloquean; devuelven false si la cola está llena
+    bool Tono(uint16_t frecuencia, uint32_t ms, uint16_t volumen = AUDIO_VOLUMEN_EFECTOS, int16_t pan = 0);
+    bool Muestra(const int16_t *datos, uint32_t longitud, uint16_t volumen = AUDIO_VOLUMEN_EFECTOS, int16_t pan = 0);
+    bool Musica(FuenteAudio fuente, void *contexto, uint16_t volumen = AUDIO_VOLUMEN_MUSICA);
+    bool DetenerMusica(void);
+    bool VolumenMusica(uint16_t volumen);
+    bool VolumenMaestro(uint16_t volumen);
+
+    // Ciclos de CPU del último bloque mezclado y el máximo observado
+    uint32_t CiclosBloque(void);
+    uint32_t CiclosMaximos(void);
+    uint32_t Saturaciones(void);
+
+private:
+    uint8_t pinBCLK, pinLRC, pinDOUT;
+    QueueHandle_t comandos;
+    Mezclador mezclador;
+    int16_t bloque[MEZCLADOR_BLOQUE * 2];
+    volatile uint32_t ciclosBloque, ciclosMaximos;
+
+    bool Enviar(const ComandoAudio &comando);
+    void Aplicar(const ComandoAudio &comando);
+    static void TareaAudio(void *pvParameters);
+};
+
+// Desarrollo de métodos
+
+SalidaAudio::SalidaAudio(uint8_t pinBCLK, uint8_t pinLRC, uint8_t pinDOUT)
+{
+    this->pinBCLK = pinBCLK;
+    this->pinLRC = pinLRC;
+    this->pinDOUT = pinDOUT;
+    comandos = NULL;
+    ciclosBloque = 0;
+    ciclosMaximos = 0;
+}
+
+void SalidaAudio::Iniciar(UBaseType_t prioridad, BaseType_t nucleo)
+{
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX);
+    config.sample_rate = MEZCLADOR_FRECUENCIA;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    config.dma_buf_count = AUDIO_DMA_BUFERES;
+    config.dma_buf_len = MEZCLADOR_BLOQUE; // Un bloque del mezclador llena un búfer DMA
+    config.tx_desc_auto_clear = true;      // Silencio si la tarea se atrasa
+
+    i2s_pin_config_t pines = {};
+    pines.bck_io_num = pinBCLK;
+    pines.ws_io_num = pinLRC;
+    pines.data_out_num = pinDOUT;
+    pines.data_in_num = I2S_PIN_NO_CHANGE;
+
+    if (i2s_driver_install(AUDIO_I2S_PUERTO, &config, 0, NULL) != ESP_OK || i2s_set_pin(AUDIO_I2S_PUERTO, &pines) != ESP_OK)
+    {
+        BITACORA(MSG_I2S_ERROR);
+        return;
+    }
+
+    comandos = xQueueCreate(AUDIO_COLA, sizeof(ComandoAudio));
+    xTaskCreatePinnedToCore(
+        TareaAudio,
+        "Audio",
+        AUDIO_PILA,
+        this,
+        prioridad,
+        NULL,
+        nucleo);
+}
+
+bool SalidaAudio::Tono(uint16_t frecuencia, uint32_t ms, uint16_t volumen, int16_t pan)
+{
+    ComandoAudio comando = {};
+    comando.tipo = AUDIO_TONO;
+    comando.frecuencia = frecuencia;
+    comando.duracion = ms;
+    comando.volumen = volumen;
+    comando.pan = pan;
+    return Enviar(comando);
+}
+
+bool SalidaAudio::Muestra(const int16_t *datos, uint32_t longitud, uint16_t volumen, int16_t pan)
+{
+    ComandoAudio comando = {};
+    comando.tipo = AUDIO_MUESTRA;
+    comando.datos = datos;
+    comando.duracion = longitud;
+    comando.volumen = volumen;
+    comando.pan = pan;
+    return Enviar(comando);
+}
+
+bool SalidaAudio::Musica(FuenteAudio fuente, void *contexto, uint16_t volumen)
+{
+    ComandoAudio comando = {};
+    comando.tipo = AUDIO_MUSICA;
+    comando.fuente = fuente;
+    comando.contexto = contexto;
+    comando.volumen = volumen;
+    return Enviar(comando);
+}
+
+bool SalidaAudio::DetenerMusica(void)
+{
+    ComandoAudio comando = {};
+    comando.tipo = AUDIO_DETENER_MUSICA;
+    return Enviar(comando);
+}
+
+bool SalidaAudio::VolumenMusica(uint16_t volumen)
+{
+    ComandoAudio comando = {};
+    comando.tipo = AUDIO_VOLUMEN_MUSICA_CMD;
+    comando.volumen = volumen;
+    return Enviar(comando);
+}
+
+bool SalidaAudio::VolumenMaestro(uint16_t volumen)
+{
+    ComandoAudio comando = {};
+    comando.tipo = AUDIO_MAESTRO;
+    comando.volumen = volumen;
+    return Enviar(comando);
+}
+
+uint32_t SalidaAudio::CiclosBloque(void)
+{
+    return ciclosBloque;
+}
+
+uint32_t SalidaAudio::CiclosMaximos(void)
+{
+    return ciclosMaximos;
+}
+
+uint32_t SalidaAudio::Saturaciones(void)
+{
+    return mezclador.Saturaciones();
+}
+
+bool SalidaAudio::Enviar(const ComandoAudio &comando)
+{
+    return comandos != NULL && xQueueSend(comandos, &comando, 0) == pdTRUE;
+}
+
+void SalidaAudio::Aplicar(const ComandoAudio &comando)
+{
+    switch (comando.tipo)
+    {
+    case AUDIO_TONO:
+        mezclador.ReproducirTono(comando.frecuencia, comando.duracion, comando.volumen, comando.pan);
+        break;
+    case AUDIO_MUESTRA:
+        mezclador.ReproducirMuestra(comando.datos, comando.duracion, comando.volumen, comando.pan);
+        break;
+    case AUDIO_MUSICA:
+        mezclador.ReproducirFuente(MEZCLADOR_VOZ_MUSICA, comando.fuente, comando.contexto, comando.volumen, 0);
+        break;
+    case AUDIO_DETENER_MUSICA:
+        mezclador.Detener(MEZCLADOR_VOZ_MUSICA);
+        break;
+    case AUDIO_VOLUMEN_MUSICA_CMD:
+        mezclador.Volumen(MEZCLADOR_VOZ_MUSICA, comando.volumen, 0);
+        break;
+    case AUDIO_MAESTRO:
+        mezclador.VolumenMaestro(comando.volumen);
+        break;
+    }
+}
+
+void SalidaAudio::TareaAudio(void *pvParameters)
+{
+    SalidaAudio *a = (SalidaAudio *)pvParameters;
+    ComandoAudio comando;
+    size_t escritos;
+
+    while (true)
+    {
+        // Sin nada que sonar, silenciar el DMA y dormir hasta el siguiente comando
+        if (a->mezclador.VocesActivas() == 0)
+        {
+            i2s_zero_dma_buffer(AUDIO_I2S_PUERTO);
+            if (xQueueReceive(a->comandos, &comando, portMAX_DELAY) == pdTRUE)
+                a->Aplicar(comando);
+        }
+        while (xQueueReceive(a->comandos, &comando, 0) == pdTRUE)
+            a->Aplicar(comando);
+
+        uint32_t inicio = ESP.getCycleCount();
+        a->mezclador.Mezclar(a->bloque, MEZCLADOR_BLOQUE);
+        uint32_t ciclos = ESP.getCycleCount() - inicio;
+        a->ciclosBloque = ciclos;
+        if (ciclos > a->ciclosMaximos)
+            a->ciclosMaximos = ciclos;
+
+        i2s_write(AUDIO_I2S_PUERTO, a->bloque, sizeof(a->bloque), &escritos, portMAX_DELAY);
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef Seqlock_h
+#define Seqlock_h
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+/*
+ * Seqlock de un solo escritor.
+ * El escritor incrementa la secuencia (queda impar), copia el valor y la vuelve a
+ * incrementar (queda par). Un lector copia el valor entre dos lecturas de la
+ * secuencia y lo reintenta si eran distintas o impares, así nunca ve una copia a
+ * medias y ninguno de los dos se bloquea. T debe poder copiarse con memcpy.
+ * Sólo una tarea puede publicar; los lectores pueden estar en cualquier núcleo.
+ */
+
+template <typename T>
+class Seqlock
+{
+public:
+    Seqlock();
+
+    // Sólo desde la tarea escritora
+    void Publicar(const T &valor);
+
+    // Intenta una lectura; false si coincidió con una escritura
+    bool IntentarLeer(T *destino) const;
+
+    // Reintenta hasta obtener una copia consistente
+    T Leer(void) const;
+
+    // Número de publicaciones (la mitad de la secuencia)
+    uint32_t Publicaciones(void) const;
+
+    // Lecturas que tuvieron que repetirse desde el arranque
+    uint32_t Reintentos(void) const;
+
+private:
+    std::atomic<uint32_t> secuencia;
+    mutable std::atomic<uint32_t> reintentos;
+    T valor;
+};
+
+// Desarrollo de métodos
+
+template <typename T>
+Seqlock<T>::Seqlock() : secuencia(0), reintentos(0)
+{
+    memset((void *)&valor, 0, sizeof(T));
+}
+
+template <typename T>
+void Seqlock<T>::Publicar(const T &nuevo)
+{
+    uint32_t s = secuencia.load(std::memory_order_relaxed);
+    secuencia.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // La secuencia impar antes que los datos
+    memcpy((void *)&valor, (const void *)&nuevo, sizeof(T));
+    secuencia.store(s + 2, std::memory_order_release);   // Los datos antes que la secuencia par
+}
+
+template <typename T>
+bool Seqlock<T>::IntentarLeer(T *destino) const
+{
+    uint32_t antes = secuencia.load(std::memory_order_acquire);
+    if (antes & 1)
+        return false;
+    memcpy((void *)destino, (const void *)&valor, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire); // Los datos antes que la segunda lectura
+    return secuencia.load(std::memory_order_relaxed) == antes;
+}
+
+template <typename T>
+T Seqlock<T>::Leer(void) const
+{
+    T copia;
+    while (!IntentarLeer(&copia))
+        reintentos.fetch_add(1, std::memory_order_relaxed);
+    return copia;
+}
+
+template <typename T>
+uint32_t Seqlock<T>::Publicaciones(void) const
+{
+    return secuencia.load(std::memory_order_relaxed) / 2;
+}
+
+template <typename T>
+uint32_t Seqlock<T>::Reintentos(void) const
+{
+    return reintentos.load(std::memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef Snapshot_h
+#define Snapshot_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Preferences.h>
+#endif
+
+/*
+ * Snapshot binario de la partida.
+ * Un registro compacto y versionado con todo lo necesario para reanudar una
+ * partida: nivel, tiempo transcurrido, posiciones, puntaje y estado del generador
+ * aleatorio. Se guarda en la NVS rotando entre SNAPSHOT_RANURAS claves con número
+ * de secuencia creciente; al arrancar se carga la más reciente cuyo CRC sea válido,
+ * así un corte de energía a mitad de una escritura sólo pierde ese snapshot.
+ * Fuera del ESP32 la NVS se sustituye por archivos para poder probarlo en la PC.
+ */
+
+#define SNAPSHOT_MAGIA 0x50414E53UL // "SNAP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_ESPACIO "partida" // Espacio de nombres en la NVS
+#define SNAPSHOT_RANURAS 4
+#define SNAPSHOT_PERIODO 5000 // ms de juego entre snapshots durante un nivel
+
+#define SNAPSHOT_BANDERA_PAUSA 0x01 // Se guardó al pausar (si no, fue periódico)
+
+// Registro tal como se guarda (little-endian); cambiar el formato exige subir la versión
+struct __attribute__((packed)) SnapshotJuego
+{
+    uint32_t magia;
+    uint8_t version;
+    uint8_t banderas;
+    uint8_t nivel;              // Índice del nivel en curso (0..n-1)
+    uint8_t reservado;
+    uint16_t puntaje;
+    uint16_t puntajeNivel;      // Puntaje al empezar el nivel
+    uint32_t transcurridoNivel; // ms de juego transcurridos en el nivel
+    uint8_t personajeX, personajeY;
+    uint8_t diamanteX, diamanteY;
+    uint32_t aleatorio;         // Estado del generador xorshift
+    uint32_t secuencia;         // La asigna AlmacenSnapshot::Guardar()
+    uint32_t crc;               // CRC-32 de todos los campos anteriores
+};
+
+static_assert(sizeof(SnapshotJuego) == 32, "El snapshot debe medir 32 bytes");
+
+#ifndef ARDUINO
+// Sustituto de Preferences para la PC: cada clave es un archivo <espacio>.<clave>.bin
+class Preferences
+{
+public:
+    bool begin(const char *nombre, bool soloLectura = false)
+    {
+        (void)soloLectura;
+        snprintf(espacio, sizeof(espacio), "%s", nombre);
+        return true;
+    }
+
+    void end(void) {}
+
+    size_t putBytes(const char *clave, const void *valor, size_t longitud)
+    {
+        char ruta[64];
+        Ruta(clave, ruta, sizeof(ruta));
+        FILE *archivo = fopen(ruta, "wb");
+        if (archivo == NULL)
+            return 0;
+        size_t escritos = fwrite(valor, 1, longitud, archivo);
+        fclose(archivo);
+        return escritos;
+    }
+
+    size_t getBytes(const char *clave, void *destino, size_t maximo)
+    {
+        char ruta[64];
+        Ruta(clave, ruta, sizeof(ruta));
+        FILE *archivo = fopen(ruta, "rb");
+        if (archivo == NULL)
+            return 0;
+        size_t leidos = fread(destino, 1, maximo, archivo);
+        fclose(archivo);
+        return leidos;
+    }
+
+    bool remove(const char *clave)
+    {
+        char ruta[64];
+        Ruta(clave, ruta, sizeof(ruta));
+        return ::remove(ruta) == 0;
+    }
+
+private:
+    char espacio[16];
+
+    void Ruta(const char *clave, char *ruta, size_t n)
+    {
+        snprintf(ruta, n, "%s.%s.bin", espacio, clave);
+    }
+};
+#endif
+
+class AlmacenSnapshot
+{
+public:
+    AlmacenSnapshot();
+
+    // Abre la NVS y busca la secuencia más reciente
+    bool Iniciar(void);
+
+    // Completa magia, versión, secuencia y CRC y lo escribe en la siguiente ranura
+    bool Guardar(SnapshotJuego *snapshot);
+
+    // Carga el snapshot válido más reciente; false si no hay ninguno
+    bool Cargar(SnapshotJuego *snapshot);
+
+    // Borra todas las ranuras (la partida terminó)
+    void Descartar(void);
+
+    static uint32_t CRC32(const uint8_t *datos, size_t n);
+
+private:
+    Preferences preferencias;
+    uint32_t secuencia;
+    bool abierto;
+
+    bool LeerRanura(uint8_t ranura, SnapshotJuego *snapshot);
+    static bool Valido(const SnapshotJuego *snapshot);
+    static void Clave(uint8_t ranura, char *clave);
+};
+
+// Desarrollo de métodos
+
+AlmacenSnapshot::AlmacenSnapshot()
+{
+    secuencia = 0;
+    abierto = false;
+}
+
+bool AlmacenSnapshot::Iniciar(void)
+{
+    abierto = preferencias.begin(SNAPSHOT_ESPACIO, false);
+    if (!abierto)
+        return false;
+
+    SnapshotJuego snapshot;
+    if (Cargar(&snapshot))
+        secuencia = snapshot.secuencia;
+    return true;
+}
+
+bool AlmacenSnapshot::Guardar(SnapshotJuego *snapshot)
+{
+    if (!abierto)
+        return false;
+
+    snapshot->magia = SNAPSHOT_MAGIA;
+    snapshot->version = SNAPSHOT_VERSION;
+    snapshot->reservado = 0;
+    snapshot->secuencia = ++secuencia;
+    snapshot->crc = CRC32((const uint8_t *)snapshot, offsetof(SnapshotJuego, crc));
+
+    // Rotar las ranuras reparte el desgaste y conserva la anterior si esta escritura se corta
+    char clave[8];
+    Clave(secuencia % SNAPSHOT_RANURAS, clave);
+    return preferencias.putBytes(clave, snapshot, sizeof(SnapshotJuego)) == sizeof(SnapshotJuego);
+}
+
+bool AlmacenSnapshot::Cargar(SnapshotJuego *snapshot)
+{
+    bool encontrado = false;
+    SnapshotJuego candidato;
+
+    if (!abierto)
+        return false;
+
+    for (uint8_t ranura = 0; ranura < SNAPSHOT_RANURAS; ranura++)
+    {
+        if (!LeerRanura(ranura, &candidato))
+            continue;
+        if (!encontrado || (int32_t)(candidato.secuencia - snapshot->secuencia) > 0)
+        {
+            *snapshot = candidato;
+            encontrado = true;
+        }
+    }
+    return encontrado;
+}
+
+void AlmacenSnapshot::Descartar(void)
+{
+    char clave[8];
+
+    if (!abierto)
+        return;
+
+    for (uint8_t ranura = 0; ranura < SNAPSHOT_RANURAS; ranura++)
+    {
+        Clave(ranura, clave);
+        preferencias.remove(clave);
+    }
+}
+
+// CRC-32 (IEEE 802.3, reflejado)
+uint32_t AlmacenSnapshot::CRC32(const uint8_t *datos, size_t n)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (size_t i = 0; i < n; i++)
+    {
+        crc ^= datos[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+    }
+    return ~crc;
+}
+
+bool AlmacenSnapshot::LeerRanura(uint8_t ranura, SnapshotJuego *snapshot)
+{
+    char clave[8];
+    Clave(ranura, clave);
+    if (preferencias.getBytes(clave, snapshot, sizeof(SnapshotJuego)) != sizeof(SnapshotJuego))
+        return false;
+    return Valido(snapshot);
+}
+
+bool AlmacenSnapshot::Valido(const SnapshotJuego *snapshot)
+{
+    return snapshot->magia == SNAPSHOT_MAGIA &&
+           snapshot->version == SNAPSHOT_VERSION &&
+           snapshot->crc == CRC32((const uint8_t *)snapshot, offsetof(SnapshotJuego, crc));
+}
+
+void AlmacenSnapshot::Clave(uint8_t ranura, char *clave)
+{
+    snprintf(clave, 8, "snap%u", ranura);
+}
+
+#endif
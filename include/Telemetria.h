@@ -0,0 +1,309 @@
+#ifndef Telemetria_h
+#define Telemetria_h
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <SD.h>
+#include "Bitacora.h"
+
+/*
+ * Telemetría de sesiones.
+ * El núcleo del juego sólo copia registros de 16 bytes a un búfer circular en RAM
+ * (unos pocos microsegundos por evento). Una tarea de baja prioridad los vacía en
+ * lotes al final de un archivo binario en la SD. El formato se decodifica en la PC
+ * con tools/telemetria_csv.py.
+ */
+
+#define TELEMETRIA_ARCHIVO "/telemetria.bin"
+#define TELEMETRIA_VERSION 1
+#define TELEMETRIA_CAPACIDAD 128       // Registros en RAM (potencia de 2)
+#define TELEMETRIA_LOTE 32             // Registros por escritura en la SD
+#define TELEMETRIA_PERIODO_VACIADO 2000 // ms máximos que un registro espera en RAM
+
+// Tipos de registro (no cambiar los valores: el decodificador depende de ellos)
+enum TipoTelemetria
+{
+    TELEMETRIA_ARRANQUE = 1,           // c = versión del formato
+    TELEMETRIA_SESION_INICIO = 2,      // b = puntaje inicial
+    TELEMETRIA_SESION_FIN = 3,         // nivel = niveles superados, a = pausas, b = puntaje, c = duración (ms)
+    TELEMETRIA_SESION_ABANDONADA = 4,  // Igual que SESION_FIN, al salir desde el menú de pausa
+    TELEMETRIA_NIVEL_FIN = 5,          // a = puntos obtenidos, b = puntos requeridos, c = 1 si se superó
+    TELEMETRIA_PAUSA = 6,              // a = número de pausa en la sesión, b = puntaje
+    TELEMETRIA_REANUDAR = 7,           // c = duración de la pausa (ms)
+    TELEMETRIA_CUADROS = 8,            // a = cuadros, b = promedio (us), c = máximo << 16 | mínimo (us)
+    TELEMETRIA_PERDIDOS = 9,           // c = registros descartados por búfer lleno
+    TELEMETRIA_ENERGIA = 10            // a = nivel de energía nuevo, b = anterior, c = duración del anterior (ms)
+};
+
+// Registro de tamaño fijo tal como se guarda en la SD (little-endian)
+struct __attribute__((packed)) RegistroTelemetria
+{
+    uint32_t tiempo; // millis() al registrar
+    uint8_t tipo;    // TipoTelemetria
+    uint8_t nivel;   // Nivel (1..n), 0 si no aplica
+    uint16_t sesion; // Número de sesión desde el arranque
+    uint16_t a;
+    uint16_t b;
+    uint32_t c;
+};
+
+static_assert(sizeof(RegistroTelemetria) == 16, "El registro de telemetria debe medir 16 bytes");
+
+class Telemetria
+{
+public:
+    Telemetria();
+
+    void Iniciar(SemaphoreHandle_t mutexSD, UBaseType_t prioridad, BaseType_t nucleo);
+
+    // Eventos del juego
+    void IniciarSesion(uint8_t nivel, int puntaje);
+    void TerminarSesion(uint8_t nivel, int puntaje, bool abandonada);
+    void Pausa(uint8_t nivel, int puntaje);
+    void Reanudar(uint8_t nivel);
+    void NivelTerminado(uint8_t nivel, int obtenidos, int requeridos);
+
+    // Estadísticas de tiempo por cuadro
+    void RegistrarCuadro(unsigned long duracionUs);
+    void CerrarCuadros(uint8_t nivel);
+
+    // Cambio de nivel del gobernador de energía (se llama desde su tarea)
+    void Energia(uint8_t nuevo, uint8_t anterior, uint32_t duracionMs);
+
+    uint32_t Perdidos(void);
+
+private:
+    RegistroTelemetria bufer[TELEMETRIA_CAPACIDAD];
+    uint16_t cabeza; // Siguiente posición a escribir
+    uint16_t cola;   // Siguiente posición a vaciar
+    uint32_t perdidos;
+    uint32_t perdidosReportados;
+    portMUX_TYPE candado;
+    SemaphoreHandle_t mutexSD;
+    TaskHandle_t tarea;
+
+    // Estado de la sesión (sólo lo toca el núcleo del juego)
+    uint16_t sesion;
+    uint16_t pausas;
+    unsigned long inicioSesion;
+    unsigned long inicioPausa;
+    uint32_t cuadros;
+    uint32_t sumaCuadrosUs;
+    uint32_t minCuadroUs;
+    uint32_t maxCuadroUs;
+
+    void Registrar(uint8_t tipo, uint8_t nivel, uint16_t a, uint16_t b, uint32_t c);
+    uint16_t Extraer(RegistroTelemetria *destino, uint16_t maximo);
+    static uint16_t Saturar16(uint32_t valor);
+    static void TareaVaciado(void *pvParameters);
+};
+
+// Desarrollo de métodos
+
+Telemetria::Telemetria()
+{
+    cabeza = 0;
+    cola = 0;
+    perdidos = 0;
+    perdidosReportados = 0;
+    portMUX_INITIALIZE(&candado);
+    mutexSD = NULL;
+    tarea = NULL;
+    sesion = 0;
+    pausas = 0;
+    inicioSesion = 0;
+    inicioPausa = 0;
+    cuadros = 0;
+    sumaCuadrosUs = 0;
+    minCuadroUs = UINT32_MAX;
+    maxCuadroUs = 0;
+}
+
+void Telemetria::Iniciar(SemaphoreHandle_t mutexSD, UBaseType_t prioridad, BaseType_t nucleo)
+{
+    this->mutexSD = mutexSD;
+    Registrar(TELEMETRIA_ARRANQUE, 0, 0, 0, TELEMETRIA_VERSION);
+
+    xTaskCreatePinnedToCore(
+        TareaVaciado,
+        "Telemetria",
+        4096,
+        this,
+        prioridad,
+        &tarea,
+        nucleo);
+}
+
+void Telemetria::IniciarSesion(uint8_t nivel, int puntaje)
+{
+    sesion++;
+    pausas = 0;
+    inicioSesion = millis();
+    Registrar(TELEMETRIA_SESION_INICIO, nivel, 0, Saturar16(puntaje), 0);
+}
+
+void Telemetria::TerminarSesion(uint8_t nivel, int puntaje, bool abandonada)
+{
+    Registrar(abandonada ? TELEMETRIA_SESION_ABANDONADA : TELEMETRIA_SESION_FIN,
+              nivel, pausas, Saturar16(puntaje), millis() - inicioSesion);
+}
+
+void Telemetria::Pausa(uint8_t nivel, int puntaje)
+{
+    pausas++;
+    inicioPausa = millis();
+    Registrar(TELEMETRIA_PAUSA, nivel, pausas, Saturar16(puntaje), 0);
+}
+
+void Telemetria::Reanudar(uint8_t nivel)
+{
+    Registrar(TELEMETRIA_REANUDAR, nivel, pausas, 0, millis() - inicioPausa);
+}
+
+void Telemetria::NivelTerminado(uint8_t nivel, int obtenidos, int requeridos)
+{
+    Registrar(TELEMETRIA_NIVEL_FIN, nivel, Saturar16(obtenidos), Saturar16(requeridos), obtenidos >= requeridos);
+}
+
+// Acumula un cuadro; no genera registro hasta CerrarCuadros()
+void Telemetria::RegistrarCuadro(unsigned long duracionUs)
+{
+    cuadros++;
+    sumaCuadrosUs += duracionUs;
+    if (duracionUs < minCuadroUs)
+        minCuadroUs = duracionUs;
+    if (duracionUs > maxCuadroUs)
+        maxCuadroUs = duracionUs;
+}
+
+void Telemetria::CerrarCuadros(uint8_t nivel)
+{
+    if (cuadros > 0)
+    {
+        uint32_t minimo = Saturar16(minCuadroUs);
+        uint32_t maximo = Saturar16(maxCuadroUs);
+        Registrar(TELEMETRIA_CUADROS, nivel, Saturar16(cuadros), Saturar16(sumaCuadrosUs / cuadros), (maximo << 16) | minimo);
+    }
+    cuadros = 0;
+    sumaCuadrosUs = 0;
+    minCuadroUs = UINT32_MAX;
+    maxCuadroUs = 0;
+}
+
+void Telemetria::Energia(uint8_t nuevo, uint8_t anterior, uint32_t duracionMs)
+{
+    Registrar(TELEMETRIA_ENERGIA, 0, nuevo, anterior, duracionMs);
+}
+
+uint32_t Telemetria::Perdidos(void)
+{
+    return perdidos;
+}
+
+// Copia el registro al búfer circular; si está lleno se descarta y se cuenta
+void Telemetria::Registrar(uint8_t tipo, uint8_t nivel, uint16_t a, uint16_t b, uint32_t c)
+{
+    uint16_t pendientes;
+    bool guardado = false;
+
+    portENTER_CRITICAL(&candado);
+    pendientes = cabeza - cola;
+    if (pendientes < TELEMETRIA_CAPACIDAD)
+    {
+        RegistroTelemetria &r = bufer[cabeza % TELEMETRIA_CAPACIDAD];
+        r.tiempo = millis();
+        r.tipo = tipo;
+        r.nivel = nivel;
+        r.sesion = sesion;
+        r.a = a;
+        r.b = b;
+        r.c = c;
+        cabeza++;
+        pendientes++;
+        guardado = true;
+    }
+    else
+    {
+        perdidos++;
+    }
+    portEXIT_CRITICAL(&candado);
+
+    // Despertar a la tarea cuando ya hay un lote completo
+    if (guardado && pendientes == TELEMETRIA_LOTE && tarea != NULL)
+        xTaskNotifyGive(tarea);
+}
+
+uint16_t Telemetria::Extraer(RegistroTelemetria *destino, uint16_t maximo)
+{
+    uint16_t n = 0;
+
+    portENTER_CRITICAL(&candado);
+    while (n < maximo && cola != cabeza)
+    {
+        destino[n++] = bufer[cola % TELEMETRIA_CAPACIDAD];
+        cola++;
+    }
+    portEXIT_CRITICAL(&candado);
+    return n;
+}
+
+uint16_t Telemetria::Saturar16(uint32_t valor)
+{
+    return (valor > 0xFFFF) ? 0xFFFF : valor;
+}
+
+// Tarea que vacía el búfer en la SD por lotes
+void Telemetria::TareaVaciado(void *pvParameters)
+{
+    Telemetria *t = (Telemetria *)pvParameters;
+    RegistroTelemetria lote[TELEMETRIA_LOTE];
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, TELEMETRIA_PERIODO_VACIADO / portTICK_PERIOD_MS);
+
+        // Reportar registros perdidos desde el último vaciado
+        if (t->perdidos != t->perdidosReportados)
+        {
+            uint32_t perdidos = t->perdidos;
+            t->Registrar(TELEMETRIA_PERDIDOS, 0, 0, 0, perdidos - t->perdidosReportados);
+            t->perdidosReportados = perdidos;
+        }
+
+        uint16_t n = t->Extraer(lote, TELEMETRIA_LOTE);
+        while (n > 0)
+        {
+            bool abierto = false;
+            size_t escritos = 0;
+            xSemaphoreTake(t->mutexSD, portMAX_DELAY);
+            File archivo = SD.open(TELEMETRIA_ARCHIVO, FILE_APPEND);
+            if (archivo)
+            {
+                escritos = archivo.write((const uint8_t *)lote, n * sizeof(RegistroTelemetria));
+                archivo.close();
+                abierto = true;
+            }
+            xSemaphoreGive(t->mutexSD);
+
+            if (escritos != n * sizeof(RegistroTelemetria))
+            {
+                // El lote ya salió del búfer: los registros que no llegaron completos a la
+                // SD cuentan como perdidos y se reportan en el siguiente vaciado
+                uint32_t faltantes = n - escritos / sizeof(RegistroTelemetria);
+                portENTER_CRITICAL(&t->candado);
+                t->perdidos += faltantes;
+                portEXIT_CRITICAL(&t->candado);
+                if (abierto)
+                    BITACORA(MSG_TELEMETRIA_INCOMPLETA, faltantes);
+                else
+                    BITACORA(MSG_TELEMETRIA_ERROR);
+                break;
+            }
+            n = t->Extraer(lote, TELEMETRIA_LOTE);
+        }
+    }
+}
+
+#endif
@@ -1,4 +1,7 @@
 #include "DualCore.h"
+#ifdef MODO_BENCHMARK
+#include "Benchmark.h"
+#endif
 
 // Creación de objeto para habilitar tareas en DualCore
 DualCoreESP32 DCESP32;
@@ -10,8 +13,19 @@ void setup(void)
   // --- INICIALIZACIÓN DEL DUALCORE ---
   DCESP32.ConfigCores();
   Serial.println(F("Se han configurado correctamente los dos nucleos"));
-  // Pasamos la primera bandera al Intro del juego
-  ChangeGameState(STATE_MENU);
+
+#ifdef MODO_BENCHMARK
+  // Medir las rutas críticas en lugar de arrancar el juego
+  EjecutarBenchmarks();
+  return;
+#endif
+
+  // Una partida interrumpida por un corte de energía se reanuda desde el menú de pausa;
+  // si no hay ninguna, pasamos la primera bandera al Intro del juego
+  if (RestaurarPartida())
+    ChangeGameState(STATE_PAUSE);
+  else
+    ChangeGameState(STATE_MENU);
 }
 
 void loop(void)
@@ -0,0 +1,41 @@
+/*
+ * Microbenchmarks de include/Benchmark.h en la PC.
+ * Es el mismo setup() del entorno esp32dev-bench sobre los sustitutos de
+ * tests/stubs, con el reloj simulado en modo de tiempo real: micros() mide el
+ * trabajo de la PC y las esperas de las tareas no cuentan. Los "ciclos" son
+ * nanosegundos convertidos a 240 MHz. La salida tiene el formato que espera
+ * tools/benchmark.py:
+ *
+ *     make -C tests bench          # compara con tools/benchmark_host.json
+ */
+
+#include "../src/main.cpp"
+
+#include <unistd.h>
+
+static void TareaArduino(void *parametro)
+{
+    (void)parametro;
+    setup();
+}
+
+int main(void)
+{
+    // La SD es una carpeta temporal: el benchmark del marcador escribe en ella
+    char carpeta[] = "/tmp/banco-XXXXXX";
+    if (mkdtemp(carpeta) == NULL)
+    {
+        perror("mkdtemp");
+        return 2;
+    }
+    sim::RaizSD(carpeta);
+    sim::TiempoReal(true);
+
+    ResultadoSimulacion resultado = sim::Ejecutar(TareaArduino, NULL);
+
+    char comando[64];
+    snprintf(comando, sizeof(comando), "rm -rf %s", carpeta);
+    if (system(comando) != 0)
+        perror(comando);
+    return resultado == SIM_TERMINADA ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#ifndef prueba_h
+#define prueba_h
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * Aserciones mínimas para las pruebas de la PC (tests/test_*.cpp).
+ * Cada caso se declara con PRUEBA(nombre) { ... } y se registra solo; este
+ * archivo define main(), que los corre en orden y termina con 1 si alguna
+ * comprobación falló. Una comprobación fallida no detiene el caso.
+ */
+
+#define PRUEBA_MAX_CASOS 64
+
+typedef void (*CasoPrueba)(void);
+
+struct RegistroPruebas
+{
+    const char *nombres[PRUEBA_MAX_CASOS];
+    CasoPrueba casos[PRUEBA_MAX_CASOS];
+    int total;
+    int comprobaciones;
+    int fallos;
+};
+
+static RegistroPruebas registroPruebas;
+
+struct AltaPrueba
+{
+    AltaPrueba(const char *nombre, CasoPrueba caso)
+    {
+        if (registroPruebas.total < PRUEBA_MAX_CASOS)
+        {
+            registroPruebas.nombres[registroPruebas.total] = nombre;
+            registroPruebas.casos[registroPruebas.total++] = caso;
+        }
+    }
+};
+
+#define PRUEBA(nombre)                                  \
+    static void nombre(void);                           \
+    static AltaPrueba alta_##nombre(#nombre, nombre);   \
+    static void nombre(void)
+
+#define COMPROBAR(condicion)                                                     \
+    do                                                                           \
+    {                                                                            \
+        registroPruebas.comprobaciones++;                                        \
+        if (!(condicion))                                                        \
+        {                                                                        \
+            registroPruebas.fallos++;                                            \
+            printf("  %s:%d: falló %s\n", __FILE__, __LINE__, #condicion);       \
+        }                                                                        \
+    } while (0)
+
+#define COMPROBAR_IGUAL(esperado, obtenido)                                                   \
+    do                                                                                        \
+    {                                                                                         \
+        long long e_ = (long long)(esperado), o_ = (long long)(obtenido);                     \
+        registroPruebas.comprobaciones++;                                                     \
+        if (e_ != o_)                                                                         \
+        {                                                                                     \
+            registroPruebas.fallos++;                                                         \
+            printf("  %s:%d: %s es %lld, se esperaba %lld\n", __FILE__, __LINE__, #obtenido, \
+                   o_, e_);                                                                   \
+        }                                                                                     \
+    } while (0)
+
+int main(void)
+{
+    for (int i = 0; i < registroPruebas.total; i++)
+    {
+        int antes = registroPruebas.fallos;
+        registroPruebas.casos[i]();
+        printf("%s %s\n", registroPruebas.fallos == antes ? "ok   " : "FALLO", registroPruebas.nombres[i]);
+    }
+    printf("%d casos, %d comprobaciones, %d fallidas\n", registroPruebas.total,
+           registroPruebas.comprobaciones, registroPruebas.fallos);
+    return registroPruebas.fallos == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,505 @@
+/*
+ * Prueba de resistencia (soak) y fuzzing de la máquina de estados en la PC.
+ *
+ * Compila el juego completo (src/main.cpp con DualCore.h) sobre los sustitutos de
+ * tests/stubs: las mismas tareas, colas y temporizadores que en el tablero, pero
+ * en el planificador cooperativo con tiempo simulado. Cada secuencia de entradas
+ * corre en un proceso hijo nuevo (fork), así cada ejecución arranca desde el
+ * estado inicial del firmware y un fallo no contamina las siguientes.
+ *
+ * Las entradas llegan por Entrada::Inyectar(), que la tarea de muestreo convierte
+ * en eventos con ProcesarMuestra() como las lecturas de los pines; el reloj del
+ * juego corre a --escala veces la velocidad normal. Tras cada cambio de tarea se
+ * revisan las invariantes del firmware (VERIFICAR) y las de tools/soak.py sobre el
+ * estado publicado. La cobertura que guía las mutaciones combina las tuplas de
+ * estado de soak.py con las aristas del código del juego (-fsanitize-coverage).
+ * Las secuencias que fallan se minimizan (ddmin) y se guardan como script de
+ * tools/control_remoto.py, que también sirve para reproducirlas en el tablero.
+ *
+ * Ejemplos:
+ *     make -C tests soak SOAK_ARGS="--segundos 600 --semilla 7"
+ *     tests/build/soak --reproducir fallo_soak.txt --serie
+ */
+
+#include "../src/main.cpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#define SIN_COBERTURA __attribute__((no_sanitize_coverage))
+
+#define SOAK_MAPA (1 << 16)         // Celdas de cada mapa de cobertura
+#define SOAK_ESPERA_MENU 15000      // ms para que aparezca el menú tras el arranque
+#define SOAK_LIMITE_EJECUCION 20    // s reales por ejecución antes de declararla colgada
+#define SOAK_INTERVALO_REPORTE 2.0  // s entre líneas de progreso
+
+// Campo de juego (columnas, filas), como ANCHO_JUEGO y FILAS de tools/soak.py
+#define SOAK_ANCHO_JUEGO GeometriaJuego::campoAncho
+#define SOAK_FILAS GeometriaJuego::campoAlto
+
+// Valores del joystick que usa tools/control_remoto.py
+#define SOAK_CENTRO 2048
+#define SOAK_MAXIMO 4095
+
+struct Accion
+{
+    int x, y;
+    bool enter, salir;
+    uint32_t duracion; // ms reales
+};
+
+typedef std::vector<Accion> Secuencia;
+
+// Memoria compartida entre el proceso principal y cada hijo
+struct Compartido
+{
+    char motivo[256]; // Vacío si la ejecución no falló
+    uint64_t ticks;
+    uint8_t estados[SOAK_MAPA];
+    uint8_t aristas[SOAK_MAPA];
+};
+
+static const char *nombresInvariantes[] = {
+    "ninguna",
+    "puntaje decreciente",
+    "estado perdido en la cola",
+    "índice de nivel",
+    "posición del personaje",
+    "posición del selector de nombre",
+};
+
+static Compartido *compartido;
+static const Secuencia *secuenciaHijo;
+static uint32_t escala = 10;
+static bool mostrarSerie = false;
+
+// --- Cobertura de aristas (sólo en el hijo, sólo el código del juego) ---
+
+static uintptr_t pcAnterior = 0;
+
+extern "C" SIN_COBERTURA void __sanitizer_cov_trace_pc(void)
+{
+    // Los constructores globales corren antes de que exista la memoria compartida
+    if (compartido == NULL)
+        return;
+    uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+    compartido->aristas[(pc ^ pcAnterior) & (SOAK_MAPA - 1)] = 1;
+    pcAnterior = pc >> 1;
+}
+
+// --- Verificación dentro del hijo ---
+
+static bool hayAnterior = false;
+static GameSnapshot anterior;
+
+static SIN_COBERTURA void Fallar(const char *formato, ...)
+{
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vsnprintf(compartido->motivo, sizeof(compartido->motivo), formato, argumentos);
+    va_end(argumentos);
+    compartido->ticks = ticksLogica;
+    _exit(1);
+}
+
+static SIN_COBERTURA bool Igual(const GameSnapshot &a, const GameSnapshot &b)
+{
+    return a.tick == b.tick && a.estado == b.estado && a.enJuego == b.enJuego && a.pausa == b.pausa &&
+           a.nivel == b.nivel && a.puntaje == b.puntaje && a.tiempoRestante == b.tiempoRestante &&
+           a.personajeX == b.personajeX && a.personajeY == b.personajeY &&
+           a.diamanteX == b.diamanteX && a.diamanteY == b.diamanteY;
+}
+
+// Invariantes que tools/soak.py revisa desde la PC, sobre el mismo estado publicado
+static SIN_COBERTURA void Revisar(const GameSnapshot &estado)
+{
+    if (estado.estado < STATE_INTRO || estado.estado > STATE_PAUSE)
+        Fallar("estado de juego inválido: %d", (int)estado.estado);
+    if (!(estado.personajeX >= 0 && estado.personajeX < SOAK_ANCHO_JUEGO && estado.personajeY >= 0 && estado.personajeY < SOAK_FILAS))
+        Fallar("personaje fuera de la pantalla: (%d, %d)", estado.personajeX, estado.personajeY);
+
+    if (hayAnterior && anterior.enJuego && estado.enJuego)
+    {
+        // Dentro de una misma partida el puntaje nunca baja
+        if (estado.puntaje < anterior.puntaje)
+            Fallar("el puntaje bajó de %d a %d", anterior.puntaje, estado.puntaje);
+        if (estado.tick < anterior.tick)
+            Fallar("el contador de ticks retrocedió");
+    }
+
+    uint16_t clave = estado.estado | (estado.nivel << 3) | (estado.pausa << 11) | (estado.enJuego << 12);
+    compartido->estados[clave] = 1;
+    if (hayAnterior && anterior.estado != estado.estado)
+        compartido->estados[0x8000 | (anterior.estado << 3) | estado.estado] = 1;
+}
+
+// Se llama tras cada cambio de tarea del planificador
+static SIN_COBERTURA void AlCambiarTarea(void)
+{
+    if (invariantes.violaciones != 0)
+    {
+        uint8_t id = invariantes.ultima;
+        Fallar("invariante del firmware: %s (línea %u)",
+               id < sizeof(nombresInvariantes) / sizeof(nombresInvariantes[0]) ? nombresInvariantes[id] : "?",
+               invariantes.linea);
+    }
+
+    GameSnapshot estado;
+    if (estadoPublicado.Publicaciones() == 0 || !estadoPublicado.IntentarLeer(&estado))
+        return;
+    if (hayAnterior && Igual(estado, anterior))
+        return;
+    Revisar(estado);
+    anterior = estado;
+    hayAnterior = true;
+}
+
+// Tarea loopTask del hijo: el setup() del firmware y luego la secuencia de entradas
+static SIN_COBERTURA void Conductor(void *parametro)
+{
+    (void)parametro;
+    setup();
+    reloj.ConfigurarEscala(escala * 1000);
+
+    // Como tools/soak.py: empezar cada secuencia desde el menú
+    unsigned long inicio = millis();
+    while (estadoPublicado.Leer().estado != STATE_MENU)
+    {
+        if (millis() - inicio > SOAK_ESPERA_MENU)
+            Fallar("el menú no apareció en %d ms", SOAK_ESPERA_MENU);
+        vTaskDelay(10);
+    }
+
+    for (const Accion &accion : *secuenciaHijo)
+    {
+        entrada.Inyectar(accion.x, accion.y, accion.enter, accion.salir);
+        vTaskDelay(accion.duracion);
+    }
+    entrada.Inyectar(SOAK_CENTRO, SOAK_CENTRO, false, false);
+    vTaskDelay(100);
+    entrada.LiberarInyeccion();
+}
+
+// La SD simulada sólo tiene archivos en la raíz
+static SIN_COBERTURA void BorrarCarpeta(const char *carpeta)
+{
+    DIR *directorio = opendir(carpeta);
+    if (directorio != NULL)
+    {
+        struct dirent *entrada;
+        while ((entrada = readdir(directorio)) != NULL)
+            unlinkat(dirfd(directorio), entrada->d_name, 0);
+        closedir(directorio);
+    }
+    rmdir(carpeta);
+}
+
+static SIN_COBERTURA void EjecutarHijo(const Secuencia &secuencia)
+{
+    char carpeta[] = "/tmp/soak-XXXXXX";
+    if (mkdtemp(carpeta) == NULL || chdir(carpeta) != 0)
+        Fallar("no se pudo crear la SD simulada");
+    sim::RaizSD(carpeta);
+    sim::SalidaSerial(mostrarSerie ? stderr : NULL);
+
+    // La misma secuencia siempre ve los mismos números aleatorios
+    uint32_t semilla = 2166136261UL;
+    for (const Accion &a : secuencia)
+        semilla = (semilla ^ (a.x * 7 + a.y * 13 + a.enter * 3 + a.salir * 5 + a.duracion)) * 16777619UL;
+    sim::Semilla(semilla);
+
+    secuenciaHijo = &secuencia;
+    sim::AlCambiarTarea(AlCambiarTarea);
+    alarm(SOAK_LIMITE_EJECUCION);
+    ResultadoSimulacion resultado = sim::Ejecutar(Conductor, NULL);
+
+    BorrarCarpeta(carpeta);
+    if (resultado == SIM_BLOQUEO)
+        Fallar("bloqueo: todas las tareas esperan sin plazo");
+    compartido->ticks = ticksLogica;
+    _exit(0);
+}
+
+// --- Proceso principal ---
+
+struct Resultado
+{
+    bool fallo;
+    std::string motivo;
+    uint64_t ticks;
+};
+
+static Resultado Ejecutar(const Secuencia &secuencia)
+{
+    compartido->motivo[0] = '\0';
+    compartido->ticks = 0;
+    memset(compartido->estados, 0, sizeof(compartido->estados));
+    memset(compartido->aristas, 0, sizeof(compartido->aristas));
+    fflush(stdout);
+
+    pid_t hijo = fork();
+    if (hijo < 0)
+    {
+        perror("fork");
+        exit(2);
+    }
+    if (hijo == 0)
+        EjecutarHijo(secuencia);
+
+    int estado;
+    waitpid(hijo, &estado, 0);
+
+    Resultado r = {false, "", compartido->ticks};
+    if (WIFSIGNALED(estado))
+    {
+        r.fallo = true;
+        r.motivo = WTERMSIG(estado) == SIGALRM ? "colgado: la ejecución no terminó" : std::string("terminó con la señal ") + strsignal(WTERMSIG(estado));
+    }
+    else if (WEXITSTATUS(estado) != 0)
+    {
+        r.fallo = true;
+        r.motivo = compartido->motivo[0] != '\0' ? compartido->motivo : "salida con error";
+    }
+    return r;
+}
+
+static Accion AccionAleatoria(std::mt19937 &rnd)
+{
+    static const int ejes[] = {0, SOAK_CENTRO, SOAK_CENTRO, SOAK_MAXIMO};
+    static const uint32_t duraciones[] = {30, 60, 120, 250, 500, 1200};
+    std::uniform_real_distribution<double> probabilidad(0, 1);
+    Accion accion;
+    accion.x = ejes[rnd() % 4];
+    accion.y = ejes[rnd() % 4];
+    accion.enter = probabilidad(rnd) < 0.15;
+    accion.salir = probabilidad(rnd) < 0.08;
+    accion.duracion = duraciones[rnd() % 6];
+    return accion;
+}
+
+static Secuencia Mutar(std::mt19937 &rnd, Secuencia secuencia)
+{
+    int cambios = 1 + rnd() % 4;
+    for (int i = 0; i < cambios; i++)
+    {
+        size_t posicion = rnd() % (secuencia.size() + 1);
+        double operacion = std::uniform_real_distribution<double>(0, 1)(rnd);
+        if (operacion < 0.4 || secuencia.empty())
+            secuencia.insert(secuencia.begin() + posicion, AccionAleatoria(rnd));
+        else if (operacion < 0.7)
+            secuencia.erase(secuencia.begin() + std::min(posicion, secuencia.size() - 1));
+        else
+            secuencia[std::min(posicion, secuencia.size() - 1)] = AccionAleatoria(rnd);
+    }
+    return secuencia;
+}
+
+// Delta debugging (ddmin): la secuencia más corta que sigue fallando
+static Secuencia Minimizar(Secuencia secuencia)
+{
+    size_t n = 2;
+    while (secuencia.size() >= 2)
+    {
+        size_t tamano = secuencia.size() / n;
+        bool redujo = false;
+        for (size_t i = 0; i < n; i++)
+        {
+            Secuencia complemento(secuencia.begin(), secuencia.begin() + i * tamano);
+            complemento.insert(complemento.end(), secuencia.begin() + std::min((i + 1) * tamano, secuencia.size()), secuencia.end());
+            if (!complemento.empty() && Ejecutar(complemento).fallo)
+            {
+                printf("  minimizada a %zu acciones\n", complemento.size());
+                secuencia = complemento;
+                n = std::max(n - 1, (size_t)2);
+                redujo = true;
+                break;
+            }
+        }
+        if (!redujo)
+        {
+            if (n >= secuencia.size())
+                break;
+            n = std::min(n * 2, secuencia.size());
+        }
+    }
+    return secuencia;
+}
+
+// Mismo formato que guardar_script() de tools/soak.py
+static void GuardarScript(const Secuencia &secuencia, const char *ruta, const std::string &comentario)
+{
+    FILE *archivo = fopen(ruta, "w");
+    if (archivo == NULL)
+    {
+        perror(ruta);
+        return;
+    }
+    fprintf(archivo, "# %s\n", comentario.c_str());
+    fprintf(archivo, "esperar_estado MENU 15000\n");
+    for (const Accion &a : secuencia)
+        fprintf(archivo, "inyectar %d %d%s%s\nesperar %u\n", a.x, a.y, a.enter ? " enter" : "", a.salir ? " exit" : "", a.duracion);
+    fprintf(archivo, "liberar\nestado\n");
+    fclose(archivo);
+}
+
+// Lee un script de tools/control_remoto.py; sólo cuentan 'inyectar' y 'esperar'
+static bool LeerScript(const char *ruta, Secuencia *secuencia)
+{
+    FILE *archivo = fopen(ruta, "r");
+    if (archivo == NULL)
+        return false;
+    char linea[256];
+    while (fgets(linea, sizeof(linea), archivo) != NULL)
+    {
+        Accion accion = {SOAK_CENTRO, SOAK_CENTRO, false, false, 0};
+        unsigned duracion;
+        if (sscanf(linea, "inyectar %d %d", &accion.x, &accion.y) == 2)
+        {
+            accion.enter = strstr(linea, " enter") != NULL;
+            accion.salir = strstr(linea, " exit") != NULL;
+            secuencia->push_back(accion);
+        }
+        else if (sscanf(linea, "esperar %u", &duracion) == 1 && !secuencia->empty())
+            secuencia->back().duracion += duracion;
+    }
+    fclose(archivo);
+    return true;
+}
+
+static double Segundos(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void Uso(void)
+{
+    fprintf(stderr,
+            "uso: soak [--segundos S] [--semilla N] [--longitud N] [--escala N] [--salida ruta]\n"
+            "          [--reproducir script] [--serie]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    double segundos = 60;
+    uint32_t semilla = std::random_device()();
+    size_t longitud = 40;
+    const char *salida = "fallo_soak.txt";
+    const char *reproducir = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hayValor = i + 1 < argc;
+        if (strcmp(argv[i], "--segundos") == 0 && hayValor)
+            segundos = atof(argv[++i]);
+        else if (strcmp(argv[i], "--semilla") == 0 && hayValor)
+            semilla = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--longitud") == 0 && hayValor)
+            longitud = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--escala") == 0 && hayValor)
+            escala = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--salida") == 0 && hayValor)
+            salida = argv[++i];
+        else if (strcmp(argv[i], "--reproducir") == 0 && hayValor)
+            reproducir = argv[++i];
+        else if (strcmp(argv[i], "--serie") == 0)
+            mostrarSerie = true;
+        else
+            Uso();
+    }
+    if (escala == 0)
+        Uso();
+
+    compartido = (Compartido *)mmap(NULL, sizeof(Compartido), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (compartido == MAP_FAILED)
+    {
+        perror("mmap");
+        return 2;
+    }
+
+    if (reproducir != NULL)
+    {
+        Secuencia secuencia;
+        if (!LeerScript(reproducir, &secuencia))
+        {
+            perror(reproducir);
+            return 2;
+        }
+        Resultado r = Ejecutar(secuencia);
+        printf("%zu acciones, %llu ticks: %s\n", secuencia.size(), (unsigned long long)r.ticks,
+               r.fallo ? r.motivo.c_str() : "sin fallos");
+        return r.fallo ? 1 : 0;
+    }
+
+    printf("semilla: %u\n", semilla);
+    std::mt19937 rnd(semilla);
+    std::vector<Secuencia> corpus;
+    static uint8_t estados[SOAK_MAPA], aristas[SOAK_MAPA];
+    size_t cobertura = 0, coberturaAristas = 0;
+    uint64_t ejecuciones = 0, ticks = 0;
+    double inicio = Segundos(), reporte = inicio;
+
+    while (Segundos() - inicio < segundos)
+    {
+        Secuencia secuencia;
+        if (!corpus.empty() && std::uniform_real_distribution<double>(0, 1)(rnd) < 0.6)
+            secuencia = Mutar(rnd, corpus[rnd() % corpus.size()]);
+        else
+            for (size_t i = 0; i < longitud; i++)
+                secuencia.push_back(AccionAleatoria(rnd));
+
+        Resultado r = Ejecutar(secuencia);
+        ejecuciones++;
+        ticks += r.ticks;
+
+        bool nueva = false;
+        for (size_t i = 0; i < SOAK_MAPA; i++)
+        {
+            if (compartido->estados[i] && !estados[i])
+            {
+                estados[i] = 1;
+                cobertura++;
+                nueva = true;
+            }
+            if (compartido->aristas[i] && !aristas[i])
+            {
+                aristas[i] = 1;
+                coberturaAristas++;
+                nueva = true;
+            }
+        }
+        if (nueva && !r.fallo)
+            corpus.push_back(secuencia);
+
+        double ahora = Segundos();
+        if (r.fallo || ahora - reporte >= SOAK_INTERVALO_REPORTE || ahora - inicio >= segundos)
+        {
+            reporte = ahora;
+            double transcurrido = ahora - inicio;
+            printf("[%7.1fs] ejecuciones=%llu ticks=%llu (%.0f/min) cobertura=%zu aristas=%zu corpus=%zu\n",
+                   transcurrido, (unsigned long long)ejecuciones, (unsigned long long)ticks,
+                   ticks / transcurrido * 60, cobertura, coberturaAristas, corpus.size());
+        }
+
+        if (r.fallo)
+        {
+            printf("FALLO: %s\n", r.motivo.c_str());
+            Secuencia minima = Minimizar(secuencia);
+            GuardarScript(minima, salida, "semilla " + std::to_string(semilla) + ": " + r.motivo);
+            printf("secuencia mínima (%zu acciones) guardada en %s\n", minima.size(), salida);
+            return 1;
+        }
+    }
+
+    printf("sin fallos\n");
+    return 0;
+}
@@ -0,0 +1,128 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+/*
+ * Sustituto del núcleo de Arduino para compilar el juego en la PC.
+ * Sólo cubre la parte de la API que usa el proyecto. El tiempo (millis, micros)
+ * es el reloj simulado de simulacion.h, los pines analógicos y digitales son
+ * variables que fija la prueba, y Serial escribe en la salida estándar.
+ * ARDUINO no se define: los módulos con sustitutos propios (Snapshot) los usan.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <functional>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define HIGH 0x1
+#define LOW 0x0
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define F(texto) (texto)
+#define IRAM_ATTR
+#define PROGMEM
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t caracter) = 0;
+    virtual size_t write(const uint8_t *datos, size_t longitud);
+    size_t write(const char *texto) { return texto == NULL ? 0 : write((const uint8_t *)texto, strlen(texto)); }
+    size_t write(const char *datos, size_t longitud) { return write((const uint8_t *)datos, longitud); }
+
+    size_t print(const char *texto) { return write(texto); }
+    size_t print(char caracter) { return write((uint8_t)caracter); }
+    size_t print(int valor, int base = DEC) { return print((long)valor, base); }
+    size_t print(unsigned int valor, int base = DEC) { return print((unsigned long)valor, base); }
+    size_t print(long valor, int base = DEC);
+    size_t print(unsigned long valor, int base = DEC);
+    size_t print(double valor, int decimales = 2);
+
+    size_t println(void) { return write("\r\n"); }
+    template <typename T>
+    size_t println(T valor) { return print(valor) + println(); }
+    template <typename T>
+    size_t println(T valor, int formato) { return print(valor, formato) + println(); }
+
+    size_t printf(const char *formato, ...) __attribute__((format(printf, 2, 3)));
+    virtual void flush(void) {}
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available(void) { return 0; }
+    virtual int read(void) { return -1; }
+    virtual int peek(void) { return -1; }
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baudios) { (void)baudios; }
+    size_t write(uint8_t caracter) override;
+    size_t write(const uint8_t *datos, size_t longitud) override;
+    using Print::write;
+    void flush(void) override;
+    void onReceive(std::function<void(void)> funcion, bool soloAlTerminar = false)
+    {
+        (void)funcion;
+        (void)soloAlTerminar;
+    }
+};
+
+extern HardwareSerial Serial;
+
+void pinMode(uint8_t pin, uint8_t modo);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t valor);
+uint16_t analogRead(uint8_t pin);
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+
+long random(long maximo);
+long random(long minimo, long maximo);
+void randomSeed(unsigned long semilla);
+uint32_t esp_random(void);
+
+void tone(uint8_t pin, unsigned int frecuencia, unsigned long duracion = 0);
+void noTone(uint8_t pin);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz(void);
+
+class EspClass
+{
+public:
+    // Sin contador de ciclos en la PC: nanosegundos a 240 MHz (4.17 ns por ciclo)
+    uint32_t getCycleCount(void);
+    uint32_t getFreeHeap(void) { return 320 * 1024; }
+};
+
+extern EspClass ESP;
+
+template <typename T>
+T min(T a, T b) { return a < b ? a : b; }
+template <typename T>
+T max(T a, T b) { return a > b ? a : b; }
+template <typename T, typename U, typename V>
+T constrain(T valor, U minimo, V maximo) { return valor < minimo ? minimo : (valor > maximo ? maximo : valor); }
+
+#include "simulacion.h"
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef FS_h
+#define FS_h
+
+#include <Arduino.h>
+#include <memory>
+
+/*
+ * Sistema de archivos de la SD sobre el de la PC. Las rutas "/x" se resuelven
+ * dentro de sim::RaizSD(); File comparte el FILE* entre copias igual que el
+ * manejador del núcleo del ESP32.
+ */
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+struct ArchivoSim;
+
+class File : public Stream
+{
+public:
+    File() {}
+    explicit File(std::shared_ptr<ArchivoSim> archivo) : archivo(archivo) {}
+
+    operator bool() const;
+    size_t write(uint8_t caracter) override;
+    size_t write(const uint8_t *datos, size_t longitud) override;
+    using Print::write;
+    int available(void) override;
+    int read(void) override;
+    int peek(void) override;
+    size_t read(uint8_t *destino, size_t longitud);
+    bool seek(uint32_t posicion, SeekMode modo = SeekSet);
+    size_t position(void) const;
+    size_t size(void) const;
+    void flush(void) override;
+    void close(void);
+    const char *name(void) const;
+    const char *path(void) const;
+    bool isDirectory(void);
+    File openNextFile(const char *modo = FILE_READ);
+
+private:
+    std::shared_ptr<ArchivoSim> archivo;
+};
+
+namespace fs
+{
+    class FS
+    {
+    public:
+        File open(const char *ruta, const char *modo = FILE_READ, bool crear = false);
+        bool exists(const char *ruta);
+        bool remove(const char *ruta);
+        bool rename(const char *origen, const char *destino);
+        bool mkdir(const char *ruta);
+    };
+}
+
+#endif
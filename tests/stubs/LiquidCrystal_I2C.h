@@ -0,0 +1,49 @@
+#ifndef LiquidCrystal_I2C_h
+#define LiquidCrystal_I2C_h
+
+#include <Arduino.h>
+
+// LCD sin hardware: PantallaLCD lleva su propio espejo de lo que se muestra
+class LiquidCrystal_I2C : public Print
+{
+public:
+    LiquidCrystal_I2C(uint8_t direccion, uint8_t columnas, uint8_t filas)
+    {
+        (void)direccion;
+        (void)columnas;
+        (void)filas;
+    }
+
+    void init(void) {}
+    void backlight(void) {}
+    void noBacklight(void) {}
+    void clear(void) {}
+    void home(void) {}
+    void setCursor(uint8_t columna, uint8_t fila)
+    {
+        (void)columna;
+        (void)fila;
+    }
+    void createChar(uint8_t posicion, uint8_t mapa[])
+    {
+        (void)posicion;
+        (void)mapa;
+    }
+    void blink(void) {}
+    void noBlink(void) {}
+    void cursor(void) {}
+    void noCursor(void) {}
+    void display(void) {}
+    void noDisplay(void) {}
+    void scrollDisplayLeft(void) {}
+    void scrollDisplayRight(void) {}
+    void command(uint8_t valor) { (void)valor; }
+    size_t write(uint8_t caracter) override
+    {
+        (void)caracter;
+        return 1;
+    }
+    using Print::write;
+};
+
+#endif
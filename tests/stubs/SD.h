@@ -0,0 +1,19 @@
+#ifndef SD_h
+#define SD_h
+
+#include <FS.h>
+#include <SPI.h>
+
+class SDFS : public fs::FS
+{
+public:
+    bool begin(uint8_t ss = 5)
+    {
+        (void)ss;
+        return true;
+    }
+};
+
+extern SDFS SD;
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef Wire_h
+#define Wire_h
+
+#include <Arduino.h>
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef esp_timer_h
+#define esp_timer_h
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef queue_h
+#define queue_h
+
+#include "FreeRTOS.h"
+
+struct ColaSim;
+typedef ColaSim *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t longitud, UBaseType_t tamElemento);
+BaseType_t xQueueSend(QueueHandle_t cola, const void *elemento, TickType_t espera);
+BaseType_t xQueueOverwrite(QueueHandle_t cola, const void *elemento);
+BaseType_t xQueueReceive(QueueHandle_t cola, void *destino, TickType_t espera);
+BaseType_t xQueuePeek(QueueHandle_t cola, void *destino, TickType_t espera);
+BaseType_t xQueueReset(QueueHandle_t cola);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t cola);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t cola);
+
+#define xQueueSendToBack xQueueSend
+
+#endif
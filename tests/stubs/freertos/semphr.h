@@ -0,0 +1,14 @@
+#ifndef semphr_h
+#define semphr_h
+
+#include "queue.h"
+
+// Un semáforo es una cola de elementos vacíos, igual que en FreeRTOS
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaforo, TickType_t espera);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaforo);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef task_h
+#define task_h
+
+#include "FreeRTOS.h"
+
+struct TareaSim;
+typedef TareaSim *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum
+{
+    eNoAction,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite
+} eNotifyAction;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t funcion, const char *nombre, uint32_t pila, void *parametro,
+                                   UBaseType_t prioridad, TaskHandle_t *tarea, BaseType_t nucleo);
+void vTaskDelete(TaskHandle_t tarea);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *ultimoDespertar, TickType_t periodo);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xPortGetCoreID(void);
+void taskYIELD(void);
+
+BaseType_t xTaskNotify(TaskHandle_t tarea, uint32_t valor, eNotifyAction accion);
+BaseType_t xTaskNotifyGive(TaskHandle_t tarea);
+uint32_t ulTaskNotifyTake(BaseType_t limpiar, TickType_t espera);
+
+#endif
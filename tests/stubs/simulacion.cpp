@@ -0,0 +1,864 @@
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <SPI.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <ucontext.h>
+#include <vector>
+#include <string>
+
+/*
+ * Implementación de los sustitutos de Arduino, SD y FreeRTOS (ver simulacion.h).
+ * Va en su propia unidad de compilación para que la instrumentación de cobertura
+ * del soak sólo cuente el código del juego.
+ */
+
+#define SIM_SIN_PLAZO UINT64_MAX
+
+// --- Reloj ---
+
+static uint64_t ahoraUs = 0;
+static bool tiempoReal = false;
+static uint64_t origenReal = 0; // ns del sistema que corresponden a ahoraUs == 0
+
+static uint64_t RelojSistemaNs(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+uint64_t sim::AhoraUs(void)
+{
+    if (tiempoReal)
+        ahoraUs = (RelojSistemaNs() - origenReal) / 1000;
+    return ahoraUs;
+}
+
+static void AvanzarHasta(uint64_t us)
+{
+    if (us <= sim::AhoraUs())
+        return;
+    if (tiempoReal)
+        origenReal -= (us - ahoraUs) * 1000;
+    ahoraUs = us;
+}
+
+void sim::TiempoReal(bool activo)
+{
+    uint64_t actual = AhoraUs();
+    tiempoReal = activo;
+    origenReal = RelojSistemaNs() - actual * 1000;
+}
+
+// --- Tareas ---
+
+struct TareaSim
+{
+    char nombre[16];
+    TaskFunction_t funcion;
+    void *parametro;
+    UBaseType_t prioridad;
+    BaseType_t nucleo;
+    ucontext_t contexto;
+    std::vector<uint8_t> pila;
+    bool terminada;
+
+    // Bloqueo: la tarea vuelve a estar lista cuando 'condicion' se cumple o vence 'plazo'
+    std::function<bool(void)> condicion;
+    uint64_t plazo;
+
+    uint32_t notificacion;
+};
+
+static std::vector<TareaSim *> tareas;
+static TareaSim *actual = NULL;
+static TareaSim *principal = NULL;
+static ucontext_t contextoPlanificador;
+static bool detenida = false;
+static size_t turno = 0;
+static uint64_t cambios = 0;
+static void (*alCambiar)(void) = NULL;
+
+static void ArranqueTarea(void)
+{
+    TareaSim *tarea = actual;
+    tarea->funcion(tarea->parametro);
+    tarea->terminada = true;
+    if (tarea == principal)
+        detenida = true;
+    swapcontext(&tarea->contexto, &contextoPlanificador);
+}
+
+static bool Lista(TareaSim *tarea)
+{
+    if (tarea->terminada)
+        return false;
+    if (!tarea->condicion && tarea->plazo == SIM_SIN_PLAZO)
+        return true;
+    if (tarea->plazo != SIM_SIN_PLAZO && sim::AhoraUs() >= tarea->plazo)
+        return true;
+    return tarea->condicion && tarea->condicion();
+}
+
+// Regresa al planificador hasta que 'condicion' se cumpla o llegue 'plazo' (en µs)
+static bool BloquearHasta(uint64_t plazo, std::function<bool(void)> condicion)
+{
+    if (condicion && condicion())
+        return true;
+
+    TareaSim *tarea = actual;
+    if (tarea == NULL)
+    {
+        // Fuera del planificador (pruebas sin tareas) nadie más puede cumplir la condición
+        if (plazo != SIM_SIN_PLAZO)
+            AvanzarHasta(plazo);
+        return false;
+    }
+
+    tarea->condicion = condicion;
+    tarea->plazo = plazo;
+    swapcontext(&tarea->contexto, &contextoPlanificador);
+    tarea->condicion = nullptr;
+    tarea->plazo = SIM_SIN_PLAZO;
+    return condicion && condicion();
+}
+
+static bool Bloquear(TickType_t espera, std::function<bool(void)> condicion)
+{
+    if (espera == 0)
+        return condicion && condicion();
+    uint64_t plazo = (espera == portMAX_DELAY) ? SIM_SIN_PLAZO : sim::AhoraUs() + (uint64_t)espera * 1000 * portTICK_PERIOD_MS;
+    return BloquearHasta(plazo, condicion);
+}
+
+// Cede el turno a las demás tareas listas; el reloj avanza un cuanto
+static void Ceder(void)
+{
+    AvanzarHasta(sim::AhoraUs() + SIM_CUANTO_US);
+    if (actual != NULL)
+        swapcontext(&actual->contexto, &contextoPlanificador);
+}
+
+static TareaSim *Elegir(void)
+{
+    TareaSim *elegida = NULL;
+    size_t n = tareas.size();
+    for (size_t k = 1; k <= n; k++)
+    {
+        TareaSim *tarea = tareas[(turno + k) % n];
+        if ((elegida == NULL || tarea->prioridad > elegida->prioridad) && Lista(tarea))
+            elegida = tarea;
+    }
+    return elegida;
+}
+
+ResultadoSimulacion sim::Ejecutar(void (*funcion)(void *), void *parametro)
+{
+    detenida = false;
+    TaskHandle_t tarea;
+    xTaskCreatePinnedToCore(funcion, "loopTask", 8192, parametro, 1, &tarea, 1);
+    principal = tarea;
+
+    while (!detenida)
+    {
+        TareaSim *elegida = Elegir();
+        if (elegida == NULL)
+        {
+            uint64_t plazo = SIM_SIN_PLAZO;
+            for (TareaSim *t : tareas)
+                if (!t->terminada && t->plazo < plazo)
+                    plazo = t->plazo;
+            if (plazo == SIM_SIN_PLAZO)
+                return SIM_BLOQUEO;
+            AvanzarHasta(plazo);
+            continue;
+        }
+
+        for (size_t i = 0; i < tareas.size(); i++)
+            if (tareas[i] == elegida)
+                turno = i;
+        actual = elegida;
+        swapcontext(&contextoPlanificador, &elegida->contexto);
+        actual = NULL;
+        cambios++;
+        if (alCambiar != NULL)
+            alCambiar();
+    }
+    return SIM_TERMINADA;
+}
+
+void sim::Detener(void)
+{
+    detenida = true;
+    if (actual != NULL)
+        swapcontext(&actual->contexto, &contextoPlanificador);
+}
+
+void sim::AlCambiarTarea(void (*funcion)(void))
+{
+    alCambiar = funcion;
+}
+
+const char *sim::TareaActual(void)
+{
+    return actual != NULL ? actual->nombre : "planificador";
+}
+
+uint64_t sim::CambiosDeTarea(void)
+{
+    return cambios;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t funcion, const char *nombre, uint32_t pila, void *parametro,
+                                   UBaseType_t prioridad, TaskHandle_t *tarea, BaseType_t nucleo)
+{
+    if (tareas.size() >= SIM_MAX_TAREAS)
+        return pdFAIL;
+
+    TareaSim *nueva = new TareaSim();
+    snprintf(nueva->nombre, sizeof(nueva->nombre), "%s", nombre);
+    nueva->funcion = funcion;
+    nueva->parametro = parametro;
+    nueva->prioridad = prioridad;
+    nueva->nucleo = nucleo;
+    nueva->pila.resize(pila * 4 > SIM_PILA_MINIMA ? pila * 4 : SIM_PILA_MINIMA);
+    nueva->terminada = false;
+    nueva->plazo = SIM_SIN_PLAZO;
+    nueva->notificacion = 0;
+
+    getcontext(&nueva->contexto);
+    nueva->contexto.uc_stack.ss_sp = nueva->pila.data();
+    nueva->contexto.uc_stack.ss_size = nueva->pila.size();
+    nueva->contexto.uc_link = NULL;
+    makecontext(&nueva->contexto, ArranqueTarea, 0);
+
+    tareas.push_back(nueva);
+    if (tarea != NULL)
+        *tarea = nueva;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t tarea)
+{
+    if (tarea == NULL)
+        tarea = actual;
+    tarea->terminada = true;
+    if (tarea == actual)
+        swapcontext(&tarea->contexto, &contextoPlanificador);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0)
+        Ceder();
+    else
+        Bloquear(ticks, nullptr);
+}
+
+void vTaskDelayUntil(TickType_t *ultimoDespertar, TickType_t periodo)
+{
+    *ultimoDespertar += periodo;
+    uint64_t plazo = (uint64_t)*ultimoDespertar * 1000 * portTICK_PERIOD_MS;
+    if (plazo > sim::AhoraUs())
+        BloquearHasta(plazo, nullptr);
+    else
+        Ceder();
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(sim::AhoraUs() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return actual;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return actual != NULL ? actual->nucleo : 1;
+}
+
+void taskYIELD(void)
+{
+    Ceder();
+}
+
+BaseType_t xTaskNotify(TaskHandle_t tarea, uint32_t valor, eNotifyAction accion)
+{
+    switch (accion)
+    {
+    case eSetBits:
+        tarea->notificacion |= valor;
+        break;
+    case eIncrement:
+        tarea->notificacion++;
+        break;
+    case eSetValueWithOverwrite:
+        tarea->notificacion = valor;
+        break;
+    case eNoAction:
+        break;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t tarea)
+{
+    return xTaskNotify(tarea, 0, eIncrement);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t limpiar, TickType_t espera)
+{
+    TareaSim *tarea = actual;
+    Bloquear(espera, [tarea]()
+             { return tarea->notificacion != 0; });
+    uint32_t valor = tarea->notificacion;
+    if (valor != 0)
+        tarea->notificacion = limpiar ? 0 : valor - 1;
+    return valor;
+}
+
+// --- Colas y semáforos ---
+
+struct ColaSim
+{
+    size_t tamElemento;
+    size_t capacidad;
+    std::vector<uint8_t> datos;
+    size_t inicio;
+    size_t cuenta;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t longitud, UBaseType_t tamElemento)
+{
+    ColaSim *cola = new ColaSim();
+    cola->tamElemento = tamElemento;
+    cola->capacidad = longitud;
+    cola->datos.resize((size_t)longitud * (tamElemento > 0 ? tamElemento : 1));
+    cola->inicio = 0;
+    cola->cuenta = 0;
+    return cola;
+}
+
+BaseType_t xQueueSend(QueueHandle_t cola, const void *elemento, TickType_t espera)
+{
+    if (!Bloquear(espera, [cola]()
+                  { return cola->cuenta < cola->capacidad; }))
+        return errQUEUE_FULL;
+    size_t posicion = (cola->inicio + cola->cuenta) % cola->capacidad;
+    if (cola->tamElemento > 0)
+        memcpy(&cola->datos[posicion * cola->tamElemento], elemento, cola->tamElemento);
+    cola->cuenta++;
+    return pdPASS;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t cola, const void *elemento)
+{
+    if (cola->cuenta == cola->capacidad)
+    {
+        cola->inicio = (cola->inicio + 1) % cola->capacidad;
+        cola->cuenta--;
+    }
+    return xQueueSend(cola, elemento, 0);
+}
+
+static BaseType_t Tomar(QueueHandle_t cola, void *destino, TickType_t espera, bool quitar)
+{
+    if (!Bloquear(espera, [cola]()
+                  { return cola->cuenta > 0; }))
+        return pdFALSE;
+    if (cola->tamElemento > 0)
+        memcpy(destino, &cola->datos[cola->inicio * cola->tamElemento], cola->tamElemento);
+    if (quitar)
+    {
+        cola->inicio = (cola->inicio + 1) % cola->capacidad;
+        cola->cuenta--;
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t cola, void *destino, TickType_t espera)
+{
+    return Tomar(cola, destino, espera, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t cola, void *destino, TickType_t espera)
+{
+    return Tomar(cola, destino, espera, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t cola)
+{
+    cola->inicio = 0;
+    cola->cuenta = 0;
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t cola)
+{
+    return cola->cuenta;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t cola)
+{
+    return cola->capacidad - cola->cuenta;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t semaforo = xQueueCreate(1, 0);
+    xSemaphoreGive(semaforo);
+    return semaforo;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xQueueCreate(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaforo, TickType_t espera)
+{
+    return xQueueReceive(semaforo, NULL, espera);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaforo)
+{
+    return xQueueSend(semaforo, NULL, 0);
+}
+
+// --- Arduino ---
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+static FILE *salidaSerial = stdout;
+static uint16_t pinesAnalogicos[40];
+static int pinesDigitales[40];
+static bool pinesIniciados = false;
+static uint32_t aleatorio = 0x9E3779B9UL;
+static uint32_t mhz = 240;
+
+void sim::SalidaSerial(FILE *archivo)
+{
+    salidaSerial = archivo;
+}
+
+size_t Print::write(const uint8_t *datos, size_t longitud)
+{
+    size_t n = 0;
+    while (longitud--)
+        n += write(*datos++);
+    return n;
+}
+
+size_t Print::print(long valor, int base)
+{
+    if (valor < 0 && base == DEC)
+        return print('-') + print((unsigned long)-valor, base);
+    return print((unsigned long)valor, base);
+}
+
+size_t Print::print(unsigned long valor, int base)
+{
+    char texto[8 * sizeof(long) + 1];
+    char *p = &texto[sizeof(texto) - 1];
+    *p = '\0';
+    if (base < 2)
+        base = DEC;
+    do
+    {
+        unsigned long digito = valor % base;
+        *--p = digito < 10 ? '0' + digito : 'A' + digito - 10;
+        valor /= base;
+    } while (valor != 0);
+    return write(p);
+}
+
+size_t Print::print(double valor, int decimales)
+{
+    char texto[48];
+    snprintf(texto, sizeof(texto), "%.*f", decimales, valor);
+    return write(texto);
+}
+
+size_t Print::printf(const char *formato, ...)
+{
+    char texto[256];
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int n = vsnprintf(texto, sizeof(texto), formato, argumentos);
+    va_end(argumentos);
+    if (n < 0)
+        return 0;
+    return write((const uint8_t *)texto, (size_t)n < sizeof(texto) ? n : sizeof(texto) - 1);
+}
+
+size_t HardwareSerial::write(uint8_t caracter)
+{
+    return write(&caracter, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *datos, size_t longitud)
+{
+    if (salidaSerial != NULL)
+        fwrite(datos, 1, longitud, salidaSerial);
+    return longitud;
+}
+
+void HardwareSerial::flush(void)
+{
+    if (salidaSerial != NULL)
+        fflush(salidaSerial);
+}
+
+static void IniciarPines(void)
+{
+    if (pinesIniciados)
+        return;
+    pinesIniciados = true;
+    for (uint8_t i = 0; i < 40; i++)
+    {
+        pinesAnalogicos[i] = 2048;
+        pinesDigitales[i] = HIGH;
+    }
+}
+
+void sim::FijarAnalogico(uint8_t pin, uint16_t valor)
+{
+    IniciarPines();
+    pinesAnalogicos[pin % 40] = valor;
+}
+
+void sim::FijarDigital(uint8_t pin, int valor)
+{
+    IniciarPines();
+    pinesDigitales[pin % 40] = valor;
+}
+
+void pinMode(uint8_t pin, uint8_t modo)
+{
+    (void)pin;
+    (void)modo;
+    IniciarPines();
+}
+
+int digitalRead(uint8_t pin)
+{
+    IniciarPines();
+    return pinesDigitales[pin % 40];
+}
+
+void digitalWrite(uint8_t pin, uint8_t valor)
+{
+    IniciarPines();
+    pinesDigitales[pin % 40] = valor;
+}
+
+uint16_t analogRead(uint8_t pin)
+{
+    IniciarPines();
+    return pinesAnalogicos[pin % 40];
+}
+
+unsigned long millis(void)
+{
+    return (unsigned long)(uint32_t)(sim::AhoraUs() / 1000);
+}
+
+unsigned long micros(void)
+{
+    return (unsigned long)(uint32_t)sim::AhoraUs();
+}
+
+void delay(uint32_t ms)
+{
+    if (actual != NULL)
+        vTaskDelay(ms / portTICK_PERIOD_MS);
+    else
+        AvanzarHasta(sim::AhoraUs() + (uint64_t)ms * 1000);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)sim::AhoraUs();
+}
+
+uint32_t EspClass::getCycleCount(void)
+{
+    // 240 ciclos por microsegundo; en tiempo simulado no hay nada que medir
+    return (uint32_t)(RelojSistemaNs() * 240 / 1000);
+}
+
+void sim::Semilla(uint32_t semilla)
+{
+    aleatorio = semilla != 0 ? semilla : 0x9E3779B9UL;
+}
+
+uint32_t esp_random(void)
+{
+    aleatorio ^= aleatorio << 13;
+    aleatorio ^= aleatorio >> 17;
+    aleatorio ^= aleatorio << 5;
+    return aleatorio;
+}
+
+long random(long maximo)
+{
+    return maximo <= 0 ? 0 : (long)(esp_random() % (uint32_t)maximo);
+}
+
+long random(long minimo, long maximo)
+{
+    return minimo >= maximo ? minimo : minimo + random(maximo - minimo);
+}
+
+void randomSeed(unsigned long semilla)
+{
+    if (semilla != 0)
+        sim::Semilla((uint32_t)semilla);
+}
+
+void tone(uint8_t pin, unsigned int frecuencia, unsigned long duracion)
+{
+    (void)pin;
+    (void)frecuencia;
+    (void)duracion;
+}
+
+void noTone(uint8_t pin)
+{
+    (void)pin;
+}
+
+bool setCpuFrequencyMhz(uint32_t nuevos)
+{
+    mhz = nuevos;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz(void)
+{
+    return mhz;
+}
+
+// --- SD ---
+
+SDFS SD;
+static std::string raizSD = ".";
+static int32_t escriturasSD = -1; // Escrituras que faltan para fallar (-1: nunca)
+
+struct ArchivoSim
+{
+    FILE *archivo;
+    DIR *directorio;
+    std::string ruta; // Ruta dentro de la SD ("/Marcador.bin")
+    std::string nombre;
+
+    ~ArchivoSim()
+    {
+        if (archivo != NULL)
+            fclose(archivo);
+        if (directorio != NULL)
+            closedir(directorio);
+    }
+};
+
+void sim::RaizSD(const char *carpeta)
+{
+    raizSD = carpeta;
+}
+
+void sim::FallarSD(int32_t escrituras)
+{
+    escriturasSD = escrituras;
+}
+
+const char *sim::RutaSD(const char *ruta, char *destino, size_t n)
+{
+    snprintf(destino, n, "%s%s%s", raizSD.c_str(), ruta[0] == '/' ? "" : "/", ruta);
+    return destino;
+}
+
+File fs::FS::open(const char *ruta, const char *modo, bool crear)
+{
+    (void)crear;
+    char real[512];
+    sim::RutaSD(ruta, real, sizeof(real));
+
+    std::shared_ptr<ArchivoSim> nuevo(new ArchivoSim());
+    nuevo->archivo = NULL;
+    nuevo->directorio = NULL;
+    nuevo->ruta = ruta;
+    const char *barra = strrchr(ruta, '/');
+    nuevo->nombre = barra != NULL ? barra + 1 : ruta;
+
+    struct stat info;
+    if (stat(real, &info) == 0 && S_ISDIR(info.st_mode))
+        nuevo->directorio = opendir(real);
+    else
+    {
+        char modoBinario[8];
+        snprintf(modoBinario, sizeof(modoBinario), "%c%sb", modo[0], modo[1] == '+' ? "+" : "");
+        nuevo->archivo = fopen(real, modoBinario);
+    }
+
+    if (nuevo->archivo == NULL && nuevo->directorio == NULL)
+        return File();
+    return File(nuevo);
+}
+
+bool fs::FS::exists(const char *ruta)
+{
+    char real[512];
+    struct stat info;
+    return stat(sim::RutaSD(ruta, real, sizeof(real)), &info) == 0;
+}
+
+bool fs::FS::remove(const char *ruta)
+{
+    char real[512];
+    return ::remove(sim::RutaSD(ruta, real, sizeof(real))) == 0;
+}
+
+bool fs::FS::rename(const char *origen, const char *destino)
+{
+    char realOrigen[512], realDestino[512];
+    return ::rename(sim::RutaSD(origen, realOrigen, sizeof(realOrigen)),
+                    sim::RutaSD(destino, realDestino, sizeof(realDestino))) == 0;
+}
+
+bool fs::FS::mkdir(const char *ruta)
+{
+    char real[512];
+    return ::mkdir(sim::RutaSD(ruta, real, sizeof(real)), 0755) == 0;
+}
+
+File::operator bool() const
+{
+    return archivo && (archivo->archivo != NULL || archivo->directorio != NULL);
+}
+
+size_t File::write(uint8_t caracter)
+{
+    return write(&caracter, 1);
+}
+
+size_t File::write(const uint8_t *datos, size_t longitud)
+{
+    if (!archivo || archivo->archivo == NULL)
+        return 0;
+    if (escriturasSD == 0)
+        return 0;
+    if (escriturasSD > 0)
+        escriturasSD--;
+    return fwrite(datos, 1, longitud, archivo->archivo);
+}
+
+int File::available(void)
+{
+    if (!archivo || archivo->archivo == NULL)
+        return 0;
+    return (int)(size() - position());
+}
+
+int File::read(void)
+{
+    uint8_t caracter;
+    return read(&caracter, 1) == 1 ? caracter : -1;
+}
+
+int File::peek(void)
+{
+    if (!archivo || archivo->archivo == NULL)
+        return -1;
+    int caracter = fgetc(archivo->archivo);
+    if (caracter != EOF)
+        ungetc(caracter, archivo->archivo);
+    return caracter == EOF ? -1 : caracter;
+}
+
+size_t File::read(uint8_t *destino, size_t longitud)
+{
+    if (!archivo || archivo->archivo == NULL)
+        return 0;
+    return fread(destino, 1, longitud, archivo->archivo);
+}
+
+bool File::seek(uint32_t posicion, SeekMode modo)
+{
+    if (!archivo || archivo->archivo == NULL)
+        return false;
+    int origen = modo == SeekSet ? SEEK_SET : (modo == SeekCur ? SEEK_CUR : SEEK_END);
+    return fseek(archivo->archivo, posicion, origen) == 0;
+}
+
+size_t File::position(void) const
+{
+    if (!archivo || archivo->archivo == NULL)
+        return 0;
+    return (size_t)ftell(archivo->archivo);
+}
+
+size_t File::size(void) const
+{
+    if (!archivo || archivo->archivo == NULL)
+        return 0;
+    fflush(archivo->archivo);
+    struct stat info;
+    return fstat(fileno(archivo->archivo), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+void File::flush(void)
+{
+    if (archivo && archivo->archivo != NULL)
+        fflush(archivo->archivo);
+}
+
+void File::close(void)
+{
+    archivo.reset();
+}
+
+const char *File::name(void) const
+{
+    return archivo ? archivo->nombre.c_str() : "";
+}
+
+const char *File::path(void) const
+{
+    return archivo ? archivo->ruta.c_str() : "";
+}
+
+bool File::isDirectory(void)
+{
+    return archivo && archivo->directorio != NULL;
+}
+
+File File::openNextFile(const char *modo)
+{
+    if (!archivo || archivo->directorio == NULL)
+        return File();
+
+    struct dirent *entrada;
+    while ((entrada = readdir(archivo->directorio)) != NULL)
+    {
+        if (strcmp(entrada->d_name, ".") == 0 || strcmp(entrada->d_name, "..") == 0)
+            continue;
+        std::string ruta = archivo->ruta;
+        if (ruta.empty() || ruta.back() != '/')
+            ruta += "/";
+        ruta += entrada->d_name;
+        return SD.open(ruta.c_str(), modo);
+    }
+    return File();
+}
@@ -0,0 +1,63 @@
+#ifndef simulacion_h
+#define simulacion_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Planificador cooperativo que sustituye a FreeRTOS en la PC.
+ * Cada tarea corre en su propia pila (ucontext) y sólo cede el procesador cuando se
+ * bloquea: vTaskDelay, una cola vacía, un semáforo ocupado o ulTaskNotifyTake. Entre
+ * las tareas listas gana la de mayor prioridad y, a igual prioridad, se turnan. Los
+ * dos núcleos del ESP32 se ejecutan intercalados en un solo hilo, así que cada
+ * corrida es determinista: la misma semilla y las mismas entradas dan los mismos
+ * cuadros.
+ *
+ * El tiempo es simulado. Cuando todas las tareas esperan, el reloj salta al plazo
+ * más próximo; taskYIELD y vTaskDelay(0) lo avanzan SIM_CUANTO_US para que un ciclo
+ * de espera activa no congele la simulación. En el modo de tiempo real (benchmarks)
+ * el reloj sigue al del sistema y sólo salta las esperas, así micros() mide el
+ * trabajo real sin esperar los periodos de las tareas.
+ */
+
+#define SIM_CUANTO_US 100
+#define SIM_PILA_MINIMA (256 * 1024)
+#define SIM_MAX_TAREAS 24
+
+enum ResultadoSimulacion
+{
+    SIM_TERMINADA, // La tarea principal regresó o alguien llamó a sim::Detener()
+    SIM_BLOQUEO    // Todas las tareas esperan algo que nadie va a entregar
+};
+
+namespace sim
+{
+    // Corre 'principal' como la tarea loopTask de Arduino (prioridad 1, núcleo 1)
+    // junto con las que cree; regresa cuando 'principal' termina.
+    ResultadoSimulacion Ejecutar(void (*principal)(void *), void *parametro);
+    void Detener(void);
+
+    uint64_t AhoraUs(void);
+    void TiempoReal(bool activo);
+    void Semilla(uint32_t semilla); // esp_random() y random()
+
+    // Se llama en el contexto del planificador tras cada cambio de tarea
+    void AlCambiarTarea(void (*funcion)(void));
+    const char *TareaActual(void);
+    uint64_t CambiosDeTarea(void);
+
+    // Pines simulados; los botones empiezan en HIGH (pull-up sin presionar)
+    void FijarAnalogico(uint8_t pin, uint16_t valor);
+    void FijarDigital(uint8_t pin, int valor);
+
+    // Destino de Serial (NULL la silencia) y carpeta que hace de raíz de la SD
+    void SalidaSerial(FILE *archivo);
+    void RaizSD(const char *carpeta);
+    const char *RutaSD(const char *ruta, char *destino, size_t n);
+
+    // Tras 'escrituras' llamadas a File::write las siguientes fallan (0 bytes);
+    // -1 quita el límite. Para probar el manejo de errores de la SD
+    void FallarSD(int32_t escrituras);
+}
+
+#endif
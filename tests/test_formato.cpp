@@ -0,0 +1,132 @@
+// Pruebas de los campos de ancho fijo (include/Formato.h) y de la geometría del HUD
+
+#include "prueba.h"
+#include "Formato.h"
+#include "Geometria.h"
+
+#include <string>
+
+static std::string Entero(uint8_t ancho, int32_t valor)
+{
+    char texto[FORMATO_MAX_ANCHO];
+    FormatearEntero(texto, ancho, valor);
+    return std::string(texto, ancho);
+}
+
+static std::string Texto(uint8_t ancho, const char *valor)
+{
+    char celdas[FORMATO_MAX_ANCHO];
+    FormatearTexto(celdas, ancho, valor);
+    return std::string(celdas, ancho);
+}
+
+// Pantalla mínima: guarda una fila y cuenta lo que se escribe
+struct PantallaPrueba
+{
+    char fila[2][17];
+    uint8_t x, y;
+    int escritos;
+
+    PantallaPrueba() : x(0), y(0), escritos(0)
+    {
+        memset(fila, '.', sizeof(fila));
+        fila[0][16] = fila[1][16] = '\0';
+    }
+    void setCursor(uint8_t columna, uint8_t f)
+    {
+        x = columna;
+        y = f;
+    }
+    size_t write(const uint8_t *datos, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+            fila[y][x++] = datos[i];
+        escritos += n;
+        return n;
+    }
+};
+
+PRUEBA(relleno_a_la_derecha)
+{
+    COMPROBAR(Entero(3, 7) == "  7");
+    COMPROBAR(Entero(3, 42) == " 42");
+    COMPROBAR(Entero(3, 999) == "999");
+    COMPROBAR(Entero(1, 0) == "0");
+    COMPROBAR(Entero(6, 0) == "     0");
+
+    // Al perder un dígito el campo borra la celda que ya no usa
+    COMPROBAR(Entero(2, 10) == "10");
+    COMPROBAR(Entero(2, 9) == " 9");
+}
+
+PRUEBA(signo)
+{
+    COMPROBAR(Entero(3, -5) == " -5");
+    COMPROBAR(Entero(3, -42) == "-42");
+    COMPROBAR(Entero(2, -1) == "-1");
+    COMPROBAR(Entero(4, -100) == "-100");
+}
+
+PRUEBA(saturacion)
+{
+    COMPROBAR(Entero(2, 100) == "99");
+    COMPROBAR(Entero(3, 1000) == "999");
+    COMPROBAR(Entero(3, 12345) == "999");
+    COMPROBAR(Entero(3, -100) == "-99");
+    COMPROBAR(Entero(2, -10) == "-9");
+    COMPROBAR(Entero(1, -1) == "-"); // Sin lugar para dígitos tras el signo
+    COMPROBAR(Entero(4, 10416) == "9999");
+    COMPROBAR(Entero(5, 10416) == "10416");
+}
+
+PRUEBA(extremos_de_int32)
+{
+    COMPROBAR(Entero(FORMATO_MAX_ANCHO, INT32_MIN) == "-2147483648");
+    COMPROBAR(Entero(FORMATO_MAX_ANCHO, INT32_MAX) == " 2147483647");
+    COMPROBAR(Entero(10, INT32_MAX) == "2147483647");
+    COMPROBAR(Entero(10, INT32_MIN) == "-999999999");
+    COMPROBAR(Entero(3, INT32_MIN) == "-99");
+}
+
+PRUEBA(texto_recortado_y_rellenado)
+{
+    COMPROBAR(Texto(3, "ABC") == "ABC");
+    COMPROBAR(Texto(3, "AB") == "AB ");
+    COMPROBAR(Texto(3, "") == "   ");
+    COMPROBAR(Texto(3, "ABCDE") == "ABC");
+}
+
+PRUEBA(campo_escribe_su_ancho_completo)
+{
+    PantallaPrueba pantalla;
+    CampoLCD<13, 3>::Entero(pantalla, 1, 100);
+    COMPROBAR(std::string(pantalla.fila[1]) == ".............100");
+    CampoLCD<13, 3>::Entero(pantalla, 1, 9);
+    COMPROBAR(std::string(pantalla.fila[1]) == ".............  9");
+    COMPROBAR_IGUAL(6, pantalla.escritos);
+
+    // Fila del marcador: lugar, nombre y puntaje en 16 columnas
+    CampoLCD<0, 5>::Entero(pantalla, 0, 10416);
+    CampoLCD<5, 1>::Texto(pantalla, 0, "");
+    CampoLCD<6, 3>::Texto(pantalla, 0, "ABC");
+    CampoLCD<9, 1>::Texto(pantalla, 0, "");
+    CampoLCD<10, 6>::Entero(pantalla, 0, 1234);
+    COMPROBAR(std::string(pantalla.fila[0]) == "10416 ABC   1234");
+}
+
+PRUEBA(hud_muestra_tres_digitos_en_todas_las_pantallas)
+{
+    typedef Geometria<16, 2> G16x2;
+    typedef Geometria<20, 4> G20x4;
+    typedef Geometria<40, 4> G40x4;
+    COMPROBAR(G16x2::hudAncho >= 3);
+    COMPROBAR(G20x4::hudAncho >= 3);
+    COMPROBAR(G40x4::hudAncho >= 3);
+    COMPROBAR_IGUAL(16, G16x2::hudColumna + G16x2::hudAncho);
+    COMPROBAR_IGUAL(12, Disposicion<G16x2>::maxX);
+
+    // 100 puntos ya no se muestran como "99" en la LCD original
+    PantallaPrueba pantalla;
+    CampoLCD<G16x2::hudColumna, G16x2::hudAncho>::Entero(pantalla, G16x2::hudFilaPuntaje, 100);
+    COMPROBAR(std::string(pantalla.fila[1]).substr(13) == "100");
+}
@@ -0,0 +1,180 @@
+// Pruebas del marcador ordenado en la SD (include/Marcador.h) sobre una carpeta temporal
+
+#include "prueba.h"
+#include "Marcador.h"
+
+#include <stdlib.h>
+#include <vector>
+
+static SemaphoreHandle_t mutexSD;
+
+static void SDNueva(void)
+{
+    char carpeta[] = "/tmp/marcador-XXXXXX";
+    if (mkdtemp(carpeta) == NULL)
+    {
+        perror("carpeta temporal");
+        exit(2);
+    }
+    sim::RaizSD(carpeta);
+    if (mutexSD == NULL)
+        mutexSD = xSemaphoreCreateMutex();
+}
+
+static std::vector<uint8_t> LeerArchivo(void)
+{
+    char ruta[512];
+    std::vector<uint8_t> datos;
+    FILE *f = fopen(sim::RutaSD(MARCADOR_ARCHIVO, ruta, sizeof(ruta)), "rb");
+    if (f)
+    {
+        int c;
+        while ((c = fgetc(f)) != EOF)
+            datos.push_back(c);
+        fclose(f);
+    }
+    return datos;
+}
+
+static void EscribirArchivo(const std::vector<uint8_t> &datos)
+{
+    char ruta[512];
+    FILE *f = fopen(sim::RutaSD(MARCADOR_ARCHIVO, ruta, sizeof(ruta)), "wb");
+    fwrite(datos.data(), 1, datos.size(), f);
+    fclose(f);
+}
+
+// Marcador con 'n' puntajes ya guardado en la SD
+static std::vector<uint8_t> ArchivoValido(uint32_t n)
+{
+    SDNueva();
+    Marcador marcador;
+    uint32_t lugar;
+    marcador.Iniciar(mutexSD, false);
+    for (uint32_t i = 0; i < n; i++)
+        marcador.Insertar((i * 7919) % 1000, "ABC", &lugar);
+    return LeerArchivo();
+}
+
+// Un archivo existente pero inválido no se recrea: Iniciar falla, avisa y deja el marcador vacío
+static void ComprobarRechazo(const std::vector<uint8_t> &datos)
+{
+    EscribirArchivo(datos);
+    uint32_t escritos = bitacora.Escritos();
+    Marcador marcador;
+    uint32_t lugar;
+    EntradaMarcador pagina[4];
+
+    COMPROBAR(!marcador.Iniciar(mutexSD));
+    COMPROBAR_IGUAL(escritos + 1, bitacora.Escritos());
+    COMPROBAR_IGUAL(0, marcador.Total());
+    COMPROBAR_IGUAL(0, marcador.Mejor());
+    COMPROBAR(!marcador.Insertar(500, "XYZ", &lugar));
+    COMPROBAR_IGUAL(1, marcador.Lugar(500));
+    COMPROBAR_IGUAL(0, marcador.LeerPagina(0, pagina, 4));
+    COMPROBAR(LeerArchivo() == datos);
+    bitacora.Vaciar();
+}
+
+PRUEBA(crea_inserta_y_reabre)
+{
+    SDNueva();
+    Marcador marcador;
+    uint32_t lugar;
+    COMPROBAR(marcador.Iniciar(mutexSD));
+    COMPROBAR_IGUAL(MARCADOR_TAM_SECTOR * 2, LeerArchivo().size());
+
+    // Suficientes para dividir varios bloques
+    for (uint32_t i = 0; i < 200; i++)
+        COMPROBAR(marcador.Insertar((i * 7919) % 1000, "ABC", &lugar));
+    COMPROBAR(marcador.Insertar(5000, "TOP", &lugar));
+    COMPROBAR_IGUAL(1, lugar);
+    COMPROBAR_IGUAL(201, marcador.Total());
+
+    Marcador reabierto;
+    COMPROBAR(reabierto.Iniciar(mutexSD));
+    COMPROBAR_IGUAL(201, reabierto.Total());
+    COMPROBAR_IGUAL(5000, reabierto.Mejor());
+    COMPROBAR_IGUAL(marcador.Lugar(500), reabierto.Lugar(500));
+
+    EntradaMarcador pagina[201];
+    COMPROBAR_IGUAL(201, reabierto.LeerPagina(0, pagina, 201));
+    bool ordenado = true;
+    for (int i = 1; i < 201; i++)
+        ordenado = ordenado && pagina[i - 1].puntaje >= pagina[i].puntaje;
+    COMPROBAR(ordenado);
+}
+
+PRUEBA(cabecera_invalida_no_recrea)
+{
+    const std::vector<uint8_t> valido = ArchivoValido(100);
+    CabeceraMarcador cabecera;
+    memcpy(&cabecera, valido.data(), sizeof(cabecera));
+    COMPROBAR(cabecera.bloques > 1);
+
+    // Lectura corta de la cabecera
+    ComprobarRechazo(std::vector<uint8_t>(valido.begin(), valido.begin() + 100));
+    ComprobarRechazo(std::vector<uint8_t>());
+
+    std::vector<uint8_t> datos = valido;
+    ((CabeceraMarcador *)datos.data())->magia ^= 1;
+    ComprobarRechazo(datos);
+
+    datos = valido;
+    ((CabeceraMarcador *)datos.data())->version = MARCADOR_VERSION + 1;
+    ComprobarRechazo(datos);
+
+    datos = valido;
+    ((CabeceraMarcador *)datos.data())->bloques = 0;
+    ComprobarRechazo(datos);
+
+    datos = valido;
+    ((CabeceraMarcador *)datos.data())->bloques = MARCADOR_MAX_BLOQUES + 1;
+    ComprobarRechazo(datos);
+
+    datos = valido;
+    ((CabeceraMarcador *)datos.data())->fisico[1] = cabecera.bloques;
+    ComprobarRechazo(datos);
+
+    datos = valido;
+    ((CabeceraMarcador *)datos.data())->total = cabecera.total + 1;
+    ComprobarRechazo(datos);
+
+    // Falta el último bloque
+    ComprobarRechazo(std::vector<uint8_t>(valido.begin(), valido.end() - MARCADOR_TAM_SECTOR));
+}
+
+PRUEBA(cuenta_de_bloque_fuera_de_rango)
+{
+    const std::vector<uint8_t> valido = ArchivoValido(100);
+    std::vector<uint8_t> datos = valido;
+    ((BloqueMarcador *)(datos.data() + MARCADOR_TAM_SECTOR))->cuenta = MARCADOR_POR_BLOQUE + 1;
+    ComprobarRechazo(datos);
+
+    // Con el directorio ya armado, LeerBloque también rechaza el bloque dañado
+    EscribirArchivo(valido);
+    Marcador marcador;
+    uint32_t lugar;
+    EntradaMarcador pagina[100];
+    COMPROBAR(marcador.Iniciar(mutexSD));
+    COMPROBAR_IGUAL(100, marcador.Total());
+    COMPROBAR(marcador.Lugar(2000) == 1);
+    EscribirArchivo(datos);
+    COMPROBAR_IGUAL(0, marcador.LeerPagina(0, pagina, 100));
+    COMPROBAR(!marcador.Insertar(2000, "XYZ", &lugar));
+    COMPROBAR(LeerArchivo() == datos);
+}
+
+PRUEBA(sin_archivo_se_recrea)
+{
+    ArchivoValido(10);
+    Marcador marcador;
+    marcador.Iniciar(mutexSD);
+    marcador.Eliminar();
+    COMPROBAR(LeerArchivo().empty());
+
+    Marcador nuevo;
+    COMPROBAR(nuevo.Iniciar(mutexSD));
+    COMPROBAR_IGUAL(0, nuevo.Total());
+    COMPROBAR_IGUAL(MARCADOR_TAM_SECTOR * 2, LeerArchivo().size());
+}
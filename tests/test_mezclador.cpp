@@ -0,0 +1,293 @@
+// Pruebas del mezclador de audio (include/Mezclador.h); deja la mezcla en build/mezclador.wav
+
+#include "prueba.h"
+#include "Mezclador.h"
+
+#include <chrono>
+#include <math.h>
+#include <vector>
+
+#define MEZCLA_WAV "build/mezclador.wav"
+
+// Música de prueba: un seno de 'frecuencia' Hz que termina tras 'total' muestras
+struct Musica
+{
+    double frecuencia;
+    int16_t amplitud;
+    size_t total, posicion;
+};
+
+static size_t FuenteMusica(void *contexto, int16_t *destino, size_t muestras)
+{
+    Musica *musica = (Musica *)contexto;
+    size_t n = 0;
+    while (n < muestras && musica->posicion < musica->total)
+    {
+        double t = (double)musica->posicion++ / MEZCLADOR_FRECUENCIA;
+        destino[n++] = (int16_t)(musica->amplitud * sin(2 * M_PI * musica->frecuencia * t));
+    }
+    return n;
+}
+
+// Fuente constante que nunca termina
+static size_t FuenteLlena(void *contexto, int16_t *destino, size_t muestras)
+{
+    for (size_t i = 0; i < muestras; i++)
+        destino[i] = *(int16_t *)contexto;
+    return muestras;
+}
+
+static void Escribir32(FILE *f, uint32_t valor)
+{
+    uint8_t b[4] = {(uint8_t)valor, (uint8_t)(valor >> 8), (uint8_t)(valor >> 16), (uint8_t)(valor >> 24)};
+    fwrite(b, 1, 4, f);
+}
+
+static void Escribir16(FILE *f, uint16_t valor)
+{
+    uint8_t b[2] = {(uint8_t)valor, (uint8_t)(valor >> 8)};
+    fwrite(b, 1, 2, f);
+}
+
+// WAV PCM de 16 bits estéreo
+static bool GuardarWav(const char *ruta, const std::vector<int16_t> &muestras)
+{
+    FILE *f = fopen(ruta, "wb");
+    if (!f)
+        return false;
+    uint32_t datos = muestras.size() * sizeof(int16_t);
+    fwrite("RIFF", 1, 4, f);
+    Escribir32(f, 36 + datos);
+    fwrite("WAVEfmt ", 1, 8, f);
+    Escribir32(f, 16);
+    Escribir16(f, 1); // PCM
+    Escribir16(f, 2);
+    Escribir32(f, MEZCLADOR_FRECUENCIA);
+    Escribir32(f, MEZCLADOR_FRECUENCIA * 4);
+    Escribir16(f, 4);
+    Escribir16(f, 16);
+    fwrite("data", 1, 4, f);
+    Escribir32(f, datos);
+    for (int16_t m : muestras)
+        Escribir16(f, (uint16_t)m);
+    return fclose(f) == 0;
+}
+
+PRUEBA(paneo_a_los_extremos)
+{
+    Mezclador mezclador;
+    int16_t muestra[MEZCLADOR_BLOQUE];
+    for (int i = 0; i < MEZCLADOR_BLOQUE; i++)
+        muestra[i] = 10000;
+    int16_t salida[MEZCLADOR_BLOQUE * 2];
+
+    // Totalmente a la izquierda: el canal derecho queda en silencio
+    int8_t voz = mezclador.ReproducirMuestra(muestra, MEZCLADOR_BLOQUE, Q15_UNO, -32768);
+    COMPROBAR(voz > 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(0, salida[1]);
+    COMPROBAR_IGUAL(0, salida[2 * MEZCLADOR_BLOQUE - 1]);
+    COMPROBAR(salida[0] >= 9997 && salida[0] <= 10000);
+
+    // Totalmente a la derecha
+    voz = mezclador.ReproducirMuestra(muestra, MEZCLADOR_BLOQUE, Q15_UNO, 32767);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(0, salida[0]);
+    COMPROBAR(salida[1] >= 9997 && salida[1] <= 10000);
+
+    // Al centro cada canal lleva la mitad
+    voz = mezclador.ReproducirMuestra(muestra, MEZCLADOR_BLOQUE, Q15_UNO, 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR(salida[0] >= 4997 && salida[0] <= 5000);
+    COMPROBAR(salida[1] >= 4997 && salida[1] <= 5000);
+
+    // Volumen cero silencia los dos canales
+    voz = mezclador.ReproducirMuestra(muestra, MEZCLADOR_BLOQUE, 0, 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(0, salida[0]);
+    COMPROBAR_IGUAL(0, salida[1]);
+    COMPROBAR_IGUAL(0, mezclador.Saturaciones());
+}
+
+PRUEBA(saturacion_con_seis_voces_llenas)
+{
+    Mezclador mezclador;
+    int16_t lleno = 32767;
+    int16_t muestra[MEZCLADOR_BLOQUE];
+    for (int i = 0; i < MEZCLADOR_BLOQUE; i++)
+        muestra[i] = lleno;
+    int16_t salida[MEZCLADOR_BLOQUE * 2];
+
+    mezclador.ReproducirFuente(MEZCLADOR_VOZ_MUSICA, FuenteLlena, &lleno, Q15_UNO, 0);
+    for (int v = 1; v < MEZCLADOR_VOCES; v++)
+        COMPROBAR(mezclador.ReproducirMuestra(muestra, MEZCLADOR_BLOQUE, Q15_UNO, 0, true) > 0);
+    COMPROBAR_IGUAL(MEZCLADOR_VOCES, mezclador.VocesActivas());
+
+    // Ya no hay voz libre para otro efecto
+    COMPROBAR_IGUAL(-1, mezclador.ReproducirTono(440, 100, Q15_UNO, 0));
+    COMPROBAR_IGUAL(1, mezclador.Descartados());
+
+    // Seis voces a media ganancia suman ~3x la escala completa: todas las muestras se recortan
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(MEZCLADOR_BLOQUE * 2, mezclador.Saturaciones());
+    COMPROBAR_IGUAL(32767, salida[0]);
+    COMPROBAR_IGUAL(32767, salida[1]);
+
+    lleno = -32768;
+    for (int v = 1; v < MEZCLADOR_VOCES; v++)
+        mezclador.Detener(v);
+    for (int v = 1; v < MEZCLADOR_VOCES; v++)
+        mezclador.ReproducirFuente(v, FuenteLlena, &lleno, Q15_UNO, 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(MEZCLADOR_BLOQUE * 4, mezclador.Saturaciones());
+    COMPROBAR_IGUAL(-32768, salida[0]);
+
+    // Con el maestro a un sexto la misma suma ya cabe
+    mezclador.VolumenMaestro(Q15_UNO / 6);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(MEZCLADOR_BLOQUE * 4, mezclador.Saturaciones());
+}
+
+PRUEBA(las_voces_se_liberan_al_terminar)
+{
+    Mezclador mezclador;
+    int16_t salida[MEZCLADOR_BLOQUE * 2];
+
+    // 10 ms de tono son 220 cuadros: terminan dentro del primer bloque
+    int8_t tono = mezclador.ReproducirTono(1000, 10, Q15_UNO, -32768);
+    COMPROBAR(tono > 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(0, mezclador.VocesActivas());
+    COMPROBAR(salida[2 * 219] != 0);
+    COMPROBAR_IGUAL(0, salida[2 * 220]);
+    COMPROBAR_IGUAL(0, salida[2 * MEZCLADOR_BLOQUE - 2]);
+
+    // Un tono más largo que el bloque sigue activo y continúa la fase
+    tono = mezclador.ReproducirTono(1000, 20, Q15_UNO, 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(1, mezclador.VocesActivas());
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(0, mezclador.VocesActivas());
+
+    // Una muestra sin repetir se libera al acabarse y el resto del bloque queda en silencio
+    int16_t muestra[100];
+    for (int i = 0; i < 100; i++)
+        muestra[i] = 1000 + i;
+    int8_t voz = mezclador.ReproducirMuestra(muestra, 100, Q15_UNO, -32768);
+    COMPROBAR(voz > 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(0, mezclador.VocesActivas());
+    COMPROBAR(salida[2 * 99] >= 1097);
+    COMPROBAR_IGUAL(0, salida[2 * 100]);
+
+    // La voz liberada se vuelve a usar
+    COMPROBAR_IGUAL(voz, mezclador.ReproducirMuestra(muestra, 100, Q15_UNO, 0));
+
+    // Una fuente que entrega menos de lo pedido también libera su voz
+    Musica musica = {440, 8000, 300, 0};
+    mezclador.ReproducirFuente(MEZCLADOR_VOZ_MUSICA, FuenteMusica, &musica, Q15_UNO, 0);
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(1, mezclador.VocesActivas());
+    mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR_IGUAL(0, mezclador.VocesActivas());
+}
+
+PRUEBA(repeticion_da_la_vuelta_dentro_del_bloque)
+{
+    Mezclador mezclador;
+    int16_t muestra[100];
+    for (int i = 0; i < 100; i++)
+        muestra[i] = 100 * i;
+    int16_t salida[MEZCLADOR_BLOQUE * 2];
+
+    // 100 muestras en bloques de 256: dos vueltas completas y parte de la tercera.
+    // La ganancia y el maestro truncan en Q15, así que se admiten unos LSB de diferencia
+    mezclador.ReproducirMuestra(muestra, 100, Q15_UNO, -32768, true);
+    bool igual = true;
+    for (int bloque = 0; bloque < 3; bloque++)
+    {
+        mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+        for (int i = 0; i < MEZCLADOR_BLOQUE; i++)
+        {
+            int esperado = muestra[(bloque * MEZCLADOR_BLOQUE + i) % 100];
+            igual = igual && abs(salida[2 * i] - esperado) <= 3;
+        }
+    }
+    COMPROBAR(igual);
+    COMPROBAR_IGUAL(1, mezclador.VocesActivas());
+
+    // Muestra de un solo cuadro: da la vuelta en cada cuadro sin atorarse
+    int16_t uno = 5000;
+    Mezclador corto;
+    corto.ReproducirMuestra(&uno, 1, Q15_UNO, 32767, true);
+    corto.Mezclar(salida, MEZCLADOR_BLOQUE);
+    COMPROBAR(salida[1] >= 4997 && salida[2 * MEZCLADOR_BLOQUE - 1] >= 4997);
+}
+
+PRUEBA(mezcla_completa_a_wav)
+{
+    Mezclador mezclador;
+    std::vector<int16_t> mezcla;
+    int16_t salida[MEZCLADOR_BLOQUE * 2];
+
+    // Dos segundos de música al centro, con efectos a los lados
+    Musica musica = {220, 9000, 2 * MEZCLADOR_FRECUENCIA, 0};
+    mezclador.ReproducirFuente(MEZCLADOR_VOZ_MUSICA, FuenteMusica, &musica, Q15_UNO, 0);
+    std::vector<int16_t> golpe(MEZCLADOR_FRECUENCIA / 8);
+    for (size_t i = 0; i < golpe.size(); i++)
+        golpe[i] = (int16_t)(20000 * exp(-(double)i / 600) * sin(i * 0.3));
+
+    int bloques = 0;
+    while (mezclador.VocesActivas() > 0 && bloques < 4 * MEZCLADOR_FRECUENCIA / MEZCLADOR_BLOQUE)
+    {
+        if (bloques == 20)
+            mezclador.ReproducirTono(880, 300, Q15_UNO / 2, -32768);
+        if (bloques == 60)
+            mezclador.ReproducirTono(660, 300, Q15_UNO / 2, 32767);
+        if (bloques % 40 == 10 && bloques < 150)
+            mezclador.ReproducirMuestra(golpe.data(), golpe.size(), Q15_UNO, (bloques % 80 == 10) ? -16000 : 16000);
+        mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+        mezcla.insert(mezcla.end(), salida, salida + MEZCLADOR_BLOQUE * 2);
+        bloques++;
+    }
+
+    // La música se acaba a los dos segundos y con ella la mezcla
+    COMPROBAR_IGUAL(0, mezclador.VocesActivas());
+    COMPROBAR_IGUAL((2 * MEZCLADOR_FRECUENCIA + MEZCLADOR_BLOQUE - 1) / MEZCLADOR_BLOQUE, bloques);
+    COMPROBAR_IGUAL(0, mezclador.Saturaciones());
+    COMPROBAR(GuardarWav(MEZCLA_WAV, mezcla));
+    printf("  %s: %.2f s\n", MEZCLA_WAV, (double)mezcla.size() / 2 / MEZCLADOR_FRECUENCIA);
+}
+
+PRUEBA(tiempo_por_bloque)
+{
+    Mezclador mezclador;
+    int16_t lleno = 1000;
+    int16_t muestra[MEZCLADOR_BLOQUE / 3];
+    for (size_t i = 0; i < sizeof(muestra) / sizeof(muestra[0]); i++)
+        muestra[i] = (int16_t)(i * 50);
+    int16_t salida[MEZCLADOR_BLOQUE * 2];
+
+    // Peor caso: las seis voces ocupadas, con música, tonos y muestras que dan la vuelta
+    mezclador.ReproducirFuente(MEZCLADOR_VOZ_MUSICA, FuenteLlena, &lleno, Q15_UNO, 0);
+    for (int v = 1; v < MEZCLADOR_VOCES; v++)
+    {
+        if (v % 2)
+            mezclador.ReproducirTono(300 * v, 3600000, Q15_UNO / 4, -20000);
+        else
+            mezclador.ReproducirMuestra(muestra, sizeof(muestra) / sizeof(muestra[0]), Q15_UNO / 4, 20000, true);
+    }
+
+    const int repeticiones = 20000;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeticiones; i++)
+        mezclador.Mezclar(salida, MEZCLADOR_BLOQUE);
+    auto fin = std::chrono::steady_clock::now();
+    COMPROBAR_IGUAL(MEZCLADOR_VOCES, mezclador.VocesActivas());
+
+    double ns = std::chrono::duration<double, std::nano>(fin - inicio).count() / repeticiones;
+    double presupuesto = 1e9 * MEZCLADOR_BLOQUE / MEZCLADOR_FRECUENCIA;
+    printf("  Mezclar(%d cuadros, %d voces): %.0f ns/bloque, %.3f%% del tiempo real\n", MEZCLADOR_BLOQUE,
+           MEZCLADOR_VOCES, ns, 100 * ns / presupuesto);
+    COMPROBAR(ns < presupuesto);
+}
@@ -0,0 +1,137 @@
+// Pruebas del modelo del gobernador de energía (include/ModeloEnergia.h)
+
+#include "prueba.h"
+#include "ModeloEnergia.h"
+
+PRUEBA(umbrales_de_decision)
+{
+    ModeloEnergia modelo;
+    modelo.Reiniciar(0);
+
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Decidir(false, 0));
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Decidir(false, ENERGIA_ESPERA_AHORRO - 1));
+    COMPROBAR_IGUAL(ENERGIA_AHORRO, modelo.Decidir(false, 3000));
+    COMPROBAR_IGUAL(ENERGIA_AHORRO, modelo.Decidir(false, ENERGIA_ESPERA_SUENO - 1));
+    COMPROBAR_IGUAL(ENERGIA_SUENO, modelo.Decidir(false, 20000));
+    COMPROBAR_IGUAL(ENERGIA_SUENO, modelo.Decidir(false, 3600000));
+
+    // Un estado interactivo siempre pide el nivel activo, sin importar la inactividad
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Decidir(true, 3000));
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Decidir(true, 20000));
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Decidir(true, 3600000));
+
+    // Decidir no modifica el modelo
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Nivel());
+    COMPROBAR_IGUAL(0, modelo.Transiciones());
+}
+
+PRUEBA(esperas_configurables)
+{
+    ModeloEnergia modelo(100, 500);
+    modelo.Reiniciar(1000);
+
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Decidir(false, 1099));
+    COMPROBAR_IGUAL(ENERGIA_AHORRO, modelo.Decidir(false, 1100));
+    COMPROBAR_IGUAL(ENERGIA_SUENO, modelo.Decidir(false, 1500));
+}
+
+PRUEBA(cualquier_entrada_regresa_a_activo)
+{
+    ModeloEnergia modelo;
+    modelo.Reiniciar(0);
+
+    COMPROBAR(!modelo.Actualizar(false, 2999));
+    COMPROBAR(modelo.Actualizar(false, 3000));
+    COMPROBAR_IGUAL(ENERGIA_AHORRO, modelo.Nivel());
+    COMPROBAR(!modelo.Actualizar(false, 10000));
+    COMPROBAR(modelo.Actualizar(false, 20000));
+    COMPROBAR_IGUAL(ENERGIA_SUENO, modelo.Nivel());
+    COMPROBAR_IGUAL(ENERGIA_AHORRO, modelo.NivelAnterior());
+    COMPROBAR_IGUAL(17000, modelo.DuracionAnterior());
+
+    // Una entrada en sueño despierta y se cuenta
+    COMPROBAR(modelo.Actividad(false, 21000));
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Nivel());
+    COMPROBAR_IGUAL(ENERGIA_SUENO, modelo.NivelAnterior());
+    COMPROBAR_IGUAL(1000, modelo.DuracionAnterior());
+    COMPROBAR_IGUAL(1, modelo.Despertares());
+    COMPROBAR_IGUAL(3, modelo.Transiciones());
+
+    // La entrada en ahorro también regresa a activo, pero no es un despertar
+    COMPROBAR(modelo.Actualizar(false, 24000));
+    COMPROBAR(modelo.Actividad(false, 24500));
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Nivel());
+    COMPROBAR_IGUAL(1, modelo.Despertares());
+
+    // Entrar a un estado interactivo sube el nivel sin que haya entrada
+    COMPROBAR(modelo.Actualizar(false, 27500));
+    COMPROBAR(modelo.Actualizar(true, 27600));
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Nivel());
+    COMPROBAR(!modelo.Actividad(true, 27700));
+}
+
+PRUEBA(proximo_cambio)
+{
+    ModeloEnergia modelo;
+    modelo.Reiniciar(0);
+
+    COMPROBAR_IGUAL(3000, modelo.ProximoCambio(false, 0));
+    COMPROBAR_IGUAL(2000, modelo.ProximoCambio(false, 1000));
+    COMPROBAR_IGUAL(17000, modelo.ProximoCambio(false, 3000));
+    COMPROBAR_IGUAL(1, modelo.ProximoCambio(false, 19999));
+    COMPROBAR_IGUAL(ENERGIA_SIN_CAMBIO, modelo.ProximoCambio(false, 20000));
+    COMPROBAR_IGUAL(ENERGIA_SIN_CAMBIO, modelo.ProximoCambio(true, 1000));
+
+    // La actividad reinicia la cuenta
+    modelo.Actividad(false, 25000);
+    COMPROBAR_IGUAL(2500, modelo.ProximoCambio(false, 25500));
+}
+
+PRUEBA(tiempo_en_cada_nivel_y_consumo)
+{
+    ModeloEnergia modelo;
+    modelo.Reiniciar(0);
+
+    // Sin tiempo transcurrido el promedio es el consumo del nivel actual
+    COMPROBAR_IGUAL(ENERGIA_CONSUMO_ACTIVO, modelo.ConsumoPromedio(0));
+    COMPROBAR_IGUAL(0, modelo.CargaMicroAmperHora(0));
+
+    modelo.Actualizar(false, 3000);
+    modelo.Actualizar(false, 20000);
+
+    // El nivel en curso incluye su tramo abierto
+    COMPROBAR_IGUAL(3000, modelo.TiempoEn(ENERGIA_ACTIVO, 36000));
+    COMPROBAR_IGUAL(17000, modelo.TiempoEn(ENERGIA_AHORRO, 36000));
+    COMPROBAR_IGUAL(16000, modelo.TiempoEn(ENERGIA_SUENO, 36000));
+
+    // (50000 * 3000 + 25000 * 17000 + 3000 * 16000) uA·ms en 36000 ms
+    COMPROBAR_IGUAL(623000000ULL / 36000, modelo.ConsumoPromedio(36000));
+    COMPROBAR_IGUAL(623000000ULL / 3600000, modelo.CargaMicroAmperHora(36000));
+
+    // Una hora entera en sueño suma ENERGIA_CONSUMO_SUENO uA·h
+    COMPROBAR_IGUAL((575000000ULL + 3000ULL * 3600000) / 3600000, modelo.CargaMicroAmperHora(20000 + 3600000));
+}
+
+PRUEBA(desborde_de_millis)
+{
+    // millis() se desborda a los ~49.7 días; el modelo sólo usa restas sin signo
+    const uint32_t inicio = UINT32_MAX - 1000;
+    ModeloEnergia modelo;
+    modelo.Reiniciar(inicio);
+
+    COMPROBAR_IGUAL(ENERGIA_ACTIVO, modelo.Decidir(false, inicio + 2999));
+    COMPROBAR_IGUAL(ENERGIA_AHORRO, modelo.Decidir(false, inicio + 3000));
+    COMPROBAR(inicio + 3000 < inicio); // Ya dio la vuelta
+    COMPROBAR_IGUAL(1000, modelo.ProximoCambio(false, inicio + 2000));
+
+    COMPROBAR(modelo.Actualizar(false, inicio + 3000));
+    COMPROBAR_IGUAL(3000, modelo.DuracionAnterior());
+    COMPROBAR_IGUAL(3000, modelo.TiempoEn(ENERGIA_ACTIVO, inicio + 5000));
+    COMPROBAR_IGUAL(2000, modelo.TiempoEn(ENERGIA_AHORRO, inicio + 5000));
+    COMPROBAR_IGUAL((50000 * 3000 + 25000 * 2000) / 5000, modelo.ConsumoPromedio(inicio + 5000));
+
+    COMPROBAR(modelo.Actualizar(false, inicio + 20000));
+    COMPROBAR_IGUAL(ENERGIA_SUENO, modelo.Nivel());
+    COMPROBAR(modelo.Actividad(false, inicio + 20500));
+    COMPROBAR_IGUAL(500, modelo.DuracionAnterior());
+}
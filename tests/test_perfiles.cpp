@@ -0,0 +1,230 @@
+// Pruebas de los perfiles de jugador en la SD (include/Perfiles.h) sobre una carpeta temporal
+
+#include "prueba.h"
+#include "Perfiles.h"
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+static SemaphoreHandle_t mutexSD;
+
+static void SDNueva(void)
+{
+    char carpeta[] = "/tmp/perfiles-XXXXXX";
+    if (mkdtemp(carpeta) == NULL)
+    {
+        perror("carpeta temporal");
+        exit(2);
+    }
+    sim::RaizSD(carpeta);
+    if (mutexSD == NULL)
+        mutexSD = xSemaphoreCreateMutex();
+}
+
+static std::vector<uint8_t> LeerArchivo(void)
+{
+    char ruta[512];
+    std::vector<uint8_t> datos;
+    FILE *f = fopen(sim::RutaSD(PERFILES_ARCHIVO, ruta, sizeof(ruta)), "rb");
+    if (f)
+    {
+        int c;
+        while ((c = fgetc(f)) != EOF)
+            datos.push_back(c);
+        fclose(f);
+    }
+    return datos;
+}
+
+static void EscribirArchivo(const std::vector<uint8_t> &datos)
+{
+    char ruta[512];
+    FILE *f = fopen(sim::RutaSD(PERFILES_ARCHIVO, ruta, sizeof(ruta)), "wb");
+    fwrite(datos.data(), 1, datos.size(), f);
+    fclose(f);
+}
+
+static const CubetaPerfiles *Cubeta(const std::vector<uint8_t> &datos, uint16_t c)
+{
+    return (const CubetaPerfiles *)(datos.data() + (size_t)c * PERFILES_TAM_SECTOR);
+}
+
+// Nicks de tres letras que empiezan en la misma cubeta
+static std::vector<std::string> Colisiones(uint16_t cubeta, size_t n)
+{
+    std::vector<std::string> nicks;
+    char nick[4] = "AAA";
+    for (int i = 0; i < 26 * 26 * 26 && nicks.size() < n; i++)
+    {
+        nick[0] = 'A' + i / 676;
+        nick[1] = 'A' + i / 26 % 26;
+        nick[2] = 'A' + i % 26;
+        if (AlmacenPerfiles::Hash(nick) == cubeta)
+            nicks.push_back(nick);
+    }
+    return nicks;
+}
+
+PRUEBA(crea_y_reabre_sin_perder_datos)
+{
+    SDNueva();
+    AlmacenPerfiles perfiles;
+    Perfil perfil;
+    COMPROBAR(perfiles.Iniciar(mutexSD));
+    COMPROBAR_IGUAL(PERFILES_CUBETAS * PERFILES_TAM_SECTOR, LeerArchivo().size());
+    COMPROBAR(!perfiles.Buscar("ABC", &perfil));
+
+    COMPROBAR(perfiles.RegistrarPartida("ABC", 12, 1, 12, &perfil));
+    COMPROBAR(perfiles.RegistrarPartida("ABC", 30, 3, 30, &perfil));
+    COMPROBAR(perfiles.RegistrarPartida("ABC", 20, 2, 20, &perfil));
+    COMPROBAR(perfiles.RegistrarPartida("XYZ", 5, 0, 5, &perfil));
+    COMPROBAR_IGUAL(1, perfil.partidas);
+
+    // Un almacén nuevo (reinicio) lee lo mismo de la SD
+    AlmacenPerfiles reabierto;
+    COMPROBAR(reabierto.Iniciar(mutexSD));
+    COMPROBAR_IGUAL(PERFILES_CUBETAS * PERFILES_TAM_SECTOR, LeerArchivo().size());
+    COMPROBAR(reabierto.Buscar("ABC", &perfil));
+    COMPROBAR(strcmp(perfil.nick, "ABC") == 0);
+    COMPROBAR_IGUAL(3, perfil.partidas);
+    COMPROBAR_IGUAL(30, perfil.mejorPuntaje);
+    COMPROBAR_IGUAL(62, perfil.diamantes);
+    COMPROBAR_IGUAL(3, perfil.nivelMaximo);
+    COMPROBAR(reabierto.Buscar("XYZ", &perfil));
+    COMPROBAR_IGUAL(5, perfil.mejorPuntaje);
+    COMPROBAR(!reabierto.Buscar("QQQ", &perfil));
+}
+
+PRUEBA(archivo_invalido_no_se_recrea)
+{
+    SDNueva();
+    AlmacenPerfiles perfiles;
+    Perfil perfil;
+    perfiles.Iniciar(mutexSD);
+    perfiles.RegistrarPartida("ABC", 12, 1, 12, &perfil);
+    const std::vector<uint8_t> valido = LeerArchivo();
+
+    std::vector<std::vector<uint8_t>> danados;
+    danados.push_back(std::vector<uint8_t>(valido.begin(), valido.begin() + 100)); // Lectura corta
+    danados.push_back(std::vector<uint8_t>(valido.begin(), valido.end() - PERFILES_TAM_SECTOR));
+    danados.push_back(valido);
+    danados.back()[0] ^= 1; // Magia
+    for (const std::vector<uint8_t> &datos : danados)
+    {
+        EscribirArchivo(datos);
+        uint32_t escritos = bitacora.Escritos();
+        AlmacenPerfiles otro;
+        COMPROBAR(!otro.Iniciar(mutexSD));
+        COMPROBAR_IGUAL(escritos + 1, bitacora.Escritos());
+        COMPROBAR(LeerArchivo() == datos);
+    }
+    bitacora.Descartar();
+}
+
+PRUEBA(cubeta_llena_pasa_a_la_siguiente)
+{
+    SDNueva();
+    const uint16_t c = 5;
+    std::vector<std::string> nicks = Colisiones(c, PERFILES_POR_CUBETA + 2);
+    COMPROBAR_IGUAL(PERFILES_POR_CUBETA + 2, nicks.size());
+
+    AlmacenPerfiles perfiles;
+    Perfil perfil;
+    perfiles.Iniciar(mutexSD);
+    for (size_t i = 0; i < nicks.size(); i++)
+        COMPROBAR(perfiles.RegistrarPartida(nicks[i].c_str(), 100 + i, 1, 1, &perfil));
+
+    std::vector<uint8_t> datos = LeerArchivo();
+    COMPROBAR_IGUAL(PERFILES_POR_CUBETA, Cubeta(datos, c)->cuenta);
+    COMPROBAR_IGUAL(2, Cubeta(datos, c + 1)->cuenta);
+    COMPROBAR(strcmp(Cubeta(datos, c + 1)->perfiles[0].nick, nicks[PERFILES_POR_CUBETA].c_str()) == 0);
+
+    // Tras reabrir (caché vacía) se encuentran todos, también los desbordados
+    AlmacenPerfiles reabierto;
+    reabierto.Iniciar(mutexSD);
+    bool todos = true;
+    for (size_t i = 0; i < nicks.size(); i++)
+        todos = todos && reabierto.Buscar(nicks[i].c_str(), &perfil) && perfil.mejorPuntaje == 100 + i;
+    COMPROBAR(todos);
+}
+
+PRUEBA(cache_lru)
+{
+    SDNueva();
+    AlmacenPerfiles perfiles;
+    Perfil perfil;
+    char nick[4] = "AAA";
+    perfiles.Iniciar(mutexSD);
+    for (int i = 0; i < PERFILES_CACHE; i++)
+    {
+        nick[2] = 'A' + i;
+        perfiles.RegistrarPartida(nick, i, 0, 0, &perfil);
+    }
+    uint32_t aciertos = perfiles.Aciertos(), fallos = perfiles.Fallos();
+
+    // Todos caben en la caché
+    COMPROBAR(perfiles.Buscar("AAB", &perfil));
+    COMPROBAR(perfiles.Buscar("AAA", &perfil));
+    COMPROBAR_IGUAL(aciertos + 2, perfiles.Aciertos());
+    COMPROBAR_IGUAL(fallos, perfiles.Fallos());
+
+    // Uno más saca al usado hace más tiempo ("AAC"); "AAA" y "AAB" se acaban de usar
+    perfiles.RegistrarPartida("ZZZ", 1, 0, 0, &perfil);
+    aciertos = perfiles.Aciertos();
+    fallos = perfiles.Fallos();
+    COMPROBAR(perfiles.Buscar("AAA", &perfil));
+    COMPROBAR(perfiles.Buscar("AAB", &perfil));
+    COMPROBAR(perfiles.Buscar("ZZZ", &perfil));
+    COMPROBAR_IGUAL(aciertos + 3, perfiles.Aciertos());
+    COMPROBAR_IGUAL(fallos, perfiles.Fallos());
+
+    // El desalojado se vuelve a leer de la SD con sus datos
+    COMPROBAR(perfiles.Buscar("AAC", &perfil));
+    COMPROBAR_IGUAL(fallos + 1, perfiles.Fallos());
+    COMPROBAR_IGUAL(2, perfil.mejorPuntaje);
+    COMPROBAR(perfiles.Buscar("AAC", &perfil));
+    COMPROBAR_IGUAL(aciertos + 4, perfiles.Aciertos());
+}
+
+PRUEBA(escritura_fallida_no_cambia_la_cache)
+{
+    SDNueva();
+    AlmacenPerfiles perfiles;
+    Perfil perfil;
+    perfiles.Iniciar(mutexSD);
+    COMPROBAR(perfiles.RegistrarPartida("ABC", 10, 1, 10, &perfil));
+
+    // La SD deja de aceptar escrituras: el perfil devuelto y la caché no cambian
+    Perfil devuelto = perfil;
+    sim::FallarSD(0);
+    COMPROBAR(!perfiles.RegistrarPartida("ABC", 50, 3, 50, &devuelto));
+    sim::FallarSD(-1);
+    COMPROBAR(memcmp(&devuelto, &perfil, sizeof(Perfil)) == 0);
+    COMPROBAR(perfiles.Buscar("ABC", &perfil));
+    COMPROBAR_IGUAL(1, perfil.partidas);
+    COMPROBAR_IGUAL(10, perfil.mejorPuntaje);
+
+    // Un perfil nuevo que no se pudo crear no queda en la caché ni en la SD
+    sim::FallarSD(0);
+    COMPROBAR(!perfiles.RegistrarPartida("NEW", 5, 0, 5, &perfil));
+    sim::FallarSD(-1);
+    COMPROBAR(!perfiles.Buscar("NEW", &perfil));
+
+    // Si falla sólo la escritura del resultado, el perfil vacío ya creado es lo que hay en la SD
+    sim::FallarSD(2); // Perfil vacío y cuenta de la cubeta
+    COMPROBAR(!perfiles.RegistrarPartida("OTR", 7, 0, 7, &perfil));
+    sim::FallarSD(-1);
+    COMPROBAR(perfiles.Buscar("OTR", &perfil));
+    COMPROBAR_IGUAL(0, perfil.partidas);
+
+    // Con la SD de vuelta se guarda y coincide con lo que se lee al reabrir
+    COMPROBAR(perfiles.RegistrarPartida("ABC", 50, 3, 50, &perfil));
+    COMPROBAR_IGUAL(2, perfil.partidas);
+    AlmacenPerfiles reabierto;
+    reabierto.Iniciar(mutexSD);
+    COMPROBAR(reabierto.Buscar("ABC", &perfil));
+    COMPROBAR_IGUAL(2, perfil.partidas);
+    COMPROBAR_IGUAL(50, perfil.mejorPuntaje);
+    COMPROBAR_IGUAL(60, perfil.diamantes);
+}
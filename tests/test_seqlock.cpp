@@ -0,0 +1,115 @@
+// Pruebas del seqlock (include/Seqlock.h) con hilos reales: un escritor y tres lectores
+
+#include "prueba.h"
+#include "Seqlock.h"
+
+#include <thread>
+#include <vector>
+
+#define SEQLOCK_PUBLICACIONES 200000
+#define SEQLOCK_LECTORES 3
+#define SEQLOCK_CAMPOS 1022 // Valor de 4 KB: la copia dura lo suficiente para que la interrumpan
+
+// Todos los campos se derivan del mismo contador: una copia a medias los deja distintos
+struct ValorPrueba
+{
+    uint32_t contador;
+    uint32_t campos[SEQLOCK_CAMPOS];
+    uint32_t suma;
+};
+
+static ValorPrueba Valor(uint32_t contador)
+{
+    ValorPrueba valor;
+    valor.contador = contador;
+    valor.suma = 0;
+    for (uint32_t i = 0; i < SEQLOCK_CAMPOS; i++)
+    {
+        valor.campos[i] = contador * 2654435761UL + i;
+        valor.suma += valor.campos[i];
+    }
+    return valor;
+}
+
+static bool Consistente(const ValorPrueba &valor)
+{
+    ValorPrueba esperado = Valor(valor.contador);
+    return memcmp(&esperado, &valor, sizeof(ValorPrueba)) == 0;
+}
+
+struct ResultadoLector
+{
+    uint32_t lecturas;
+    uint32_t inconsistentes;
+    uint32_t retrocesos; // El contador nunca debe bajar para un mismo lector
+    uint32_t ultimo;
+};
+
+PRUEBA(un_hilo)
+{
+    Seqlock<ValorPrueba> seqlock;
+    ValorPrueba leido;
+    COMPROBAR(seqlock.IntentarLeer(&leido));
+    COMPROBAR_IGUAL(0, leido.contador);
+    COMPROBAR_IGUAL(0, seqlock.Publicaciones());
+
+    seqlock.Publicar(Valor(7));
+    leido = seqlock.Leer();
+    COMPROBAR(Consistente(leido));
+    COMPROBAR_IGUAL(7, leido.contador);
+    COMPROBAR_IGUAL(1, seqlock.Publicaciones());
+    COMPROBAR_IGUAL(0, seqlock.Reintentos());
+}
+
+PRUEBA(un_escritor_tres_lectores)
+{
+    static Seqlock<ValorPrueba> seqlock;
+    std::atomic<bool> terminado(false);
+    ResultadoLector resultados[SEQLOCK_LECTORES];
+    std::vector<std::thread> lectores;
+
+    seqlock.Publicar(Valor(0));
+    for (int i = 0; i < SEQLOCK_LECTORES; i++)
+    {
+        lectores.emplace_back([&terminado, &resultados, i]()
+        {
+            ResultadoLector r = {0, 0, 0, 0};
+            bool ultima;
+            do
+            {
+                ultima = terminado.load(std::memory_order_acquire);
+                ValorPrueba valor = seqlock.Leer();
+                r.lecturas++;
+                if (!Consistente(valor))
+                    r.inconsistentes++;
+                if (valor.contador < r.ultimo)
+                    r.retrocesos++;
+                r.ultimo = valor.contador;
+            } while (!ultima);
+            resultados[i] = r;
+        });
+    }
+
+    std::thread escritor([]()
+    {
+        for (uint32_t n = 1; n <= SEQLOCK_PUBLICACIONES; n++)
+            seqlock.Publicar(Valor(n));
+    });
+    escritor.join();
+    terminado.store(true, std::memory_order_release);
+    for (std::thread &lector : lectores)
+        lector.join();
+
+    COMPROBAR_IGUAL(SEQLOCK_PUBLICACIONES + 1, seqlock.Publicaciones());
+    uint32_t lecturas = 0;
+    for (int i = 0; i < SEQLOCK_LECTORES; i++)
+    {
+        COMPROBAR_IGUAL(0, resultados[i].inconsistentes);
+        COMPROBAR_IGUAL(0, resultados[i].retrocesos);
+        // La lectura posterior al fin del escritor ve la última publicación
+        COMPROBAR_IGUAL(SEQLOCK_PUBLICACIONES, resultados[i].ultimo);
+        lecturas += resultados[i].lecturas;
+    }
+    printf("  %u publicaciones, %u lecturas, %u reintentos\n", (unsigned)SEQLOCK_PUBLICACIONES,
+           (unsigned)lecturas, (unsigned)seqlock.Reintentos());
+}
@@ -0,0 +1,213 @@
+// Pruebas del snapshot de la partida (include/Snapshot.h) con la NVS sustituida por archivos
+
+#include "prueba.h"
+#include "Snapshot.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+// Cada caso trabaja en una carpeta vacía: las claves de la NVS son archivos del directorio actual
+static void CarpetaNueva(void)
+{
+    char carpeta[] = "/tmp/snapshot-XXXXXX";
+    if (mkdtemp(carpeta) == NULL || chdir(carpeta) != 0)
+    {
+        perror("carpeta temporal");
+        exit(2);
+    }
+}
+
+static SnapshotJuego Partida(uint16_t puntaje)
+{
+    SnapshotJuego snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.banderas = SNAPSHOT_BANDERA_PAUSA;
+    snapshot.nivel = 2;
+    snapshot.puntaje = puntaje;
+    snapshot.puntajeNivel = puntaje / 2;
+    snapshot.transcurridoNivel = 4321;
+    snapshot.personajeX = 7;
+    snapshot.personajeY = 1;
+    snapshot.diamanteX = 12;
+    snapshot.diamanteY = 0;
+    snapshot.aleatorio = 0xDEADBEEF;
+    return snapshot;
+}
+
+// Escribe una ranura directamente, como la dejaría una versión anterior del firmware
+static void EscribirRanura(uint8_t ranura, const SnapshotJuego &snapshot)
+{
+    Preferences nvs;
+    char clave[8];
+    snprintf(clave, sizeof(clave), "snap%u", ranura);
+    nvs.begin(SNAPSHOT_ESPACIO);
+    nvs.putBytes(clave, &snapshot, sizeof(snapshot));
+    nvs.end();
+}
+
+static SnapshotJuego Sellado(uint16_t puntaje, uint32_t secuencia)
+{
+    SnapshotJuego snapshot = Partida(puntaje);
+    snapshot.magia = SNAPSHOT_MAGIA;
+    snapshot.version = SNAPSHOT_VERSION;
+    snapshot.secuencia = secuencia;
+    snapshot.crc = AlmacenSnapshot::CRC32((const uint8_t *)&snapshot, offsetof(SnapshotJuego, crc));
+    return snapshot;
+}
+
+static bool ExisteRanura(uint8_t ranura)
+{
+    char ruta[32];
+    snprintf(ruta, sizeof(ruta), "%s.snap%u.bin", SNAPSHOT_ESPACIO, ranura);
+    return access(ruta, F_OK) == 0;
+}
+
+PRUEBA(crc32_ieee)
+{
+    // Valor de referencia del CRC-32 de "123456789"
+    COMPROBAR_IGUAL(0xCBF43926UL, AlmacenSnapshot::CRC32((const uint8_t *)"123456789", 9));
+}
+
+PRUEBA(ida_y_vuelta_en_las_cuatro_ranuras)
+{
+    CarpetaNueva();
+    AlmacenSnapshot almacen;
+    SnapshotJuego cargado;
+
+    COMPROBAR(!almacen.Cargar(&cargado)); // Sin Iniciar no hay NVS
+    COMPROBAR(almacen.Iniciar());
+    COMPROBAR(!almacen.Cargar(&cargado));
+
+    SnapshotJuego guardado;
+    for (uint16_t i = 1; i <= 6; i++)
+    {
+        guardado = Partida(100 * i);
+        COMPROBAR(almacen.Guardar(&guardado));
+        COMPROBAR_IGUAL(i, guardado.secuencia);
+        COMPROBAR(almacen.Cargar(&cargado));
+        COMPROBAR_IGUAL(i, cargado.secuencia);
+    }
+
+    // Las secuencias 3..6 ocupan las cuatro ranuras y se carga la más reciente, intacta
+    for (uint8_t ranura = 0; ranura < SNAPSHOT_RANURAS; ranura++)
+        COMPROBAR(ExisteRanura(ranura));
+    COMPROBAR(memcmp(&guardado, &cargado, sizeof(SnapshotJuego)) == 0);
+    COMPROBAR_IGUAL(600, cargado.puntaje);
+    COMPROBAR_IGUAL(0xDEADBEEF, cargado.aleatorio);
+
+    // Tras un reinicio se continúa con la secuencia siguiente en la ranura que toca
+    AlmacenSnapshot reiniciado;
+    COMPROBAR(reiniciado.Iniciar());
+    COMPROBAR(reiniciado.Cargar(&cargado));
+    COMPROBAR_IGUAL(6, cargado.secuencia);
+    guardado = Partida(700);
+    COMPROBAR(reiniciado.Guardar(&guardado));
+    COMPROBAR_IGUAL(7, guardado.secuencia);
+    COMPROBAR(reiniciado.Cargar(&cargado));
+    COMPROBAR_IGUAL(700, cargado.puntaje);
+}
+
+PRUEBA(ranura_corrupta_regresa_a_la_anterior)
+{
+    CarpetaNueva();
+    AlmacenSnapshot almacen;
+    SnapshotJuego snapshot, cargado;
+    COMPROBAR(almacen.Iniciar());
+    for (uint16_t i = 1; i <= 4; i++)
+    {
+        snapshot = Partida(i);
+        almacen.Guardar(&snapshot);
+    }
+
+    // Un bit cambiado en la más reciente (secuencia 4, ranura 0): el CRC la rechaza
+    SnapshotJuego corrupto = snapshot;
+    corrupto.puntaje ^= 0x0100;
+    EscribirRanura(0, corrupto);
+    COMPROBAR(almacen.Cargar(&cargado));
+    COMPROBAR_IGUAL(3, cargado.secuencia);
+    COMPROBAR_IGUAL(3, cargado.puntaje);
+
+    // Una escritura cortada (registro incompleto) tampoco cuenta
+    Preferences nvs;
+    nvs.begin(SNAPSHOT_ESPACIO);
+    nvs.putBytes("snap3", &cargado, sizeof(cargado) / 2);
+    nvs.end();
+    COMPROBAR(almacen.Cargar(&cargado));
+    COMPROBAR_IGUAL(2, cargado.secuencia);
+
+    // Otra versión del formato se ignora aunque su CRC sea correcto
+    SnapshotJuego otraVersion = Sellado(99, 5);
+    otraVersion.version = SNAPSHOT_VERSION + 1;
+    otraVersion.crc = AlmacenSnapshot::CRC32((const uint8_t *)&otraVersion, offsetof(SnapshotJuego, crc));
+    EscribirRanura(1, otraVersion);
+    COMPROBAR(almacen.Cargar(&cargado));
+    COMPROBAR_IGUAL(2, cargado.secuencia);
+
+    // Al reiniciar se sigue desde la última válida; la nueva pisa la ranura corrupta
+    AlmacenSnapshot reiniciado;
+    COMPROBAR(reiniciado.Iniciar());
+    snapshot = Partida(50);
+    COMPROBAR(reiniciado.Guardar(&snapshot));
+    COMPROBAR_IGUAL(3, snapshot.secuencia);
+    COMPROBAR(reiniciado.Cargar(&cargado));
+    COMPROBAR_IGUAL(50, cargado.puntaje);
+}
+
+PRUEBA(desborde_de_la_secuencia)
+{
+    CarpetaNueva();
+    EscribirRanura((UINT32_MAX - 1) % SNAPSHOT_RANURAS, Sellado(1, UINT32_MAX - 1));
+    EscribirRanura(UINT32_MAX % SNAPSHOT_RANURAS, Sellado(2, UINT32_MAX));
+
+    AlmacenSnapshot almacen;
+    SnapshotJuego snapshot, cargado;
+    COMPROBAR(almacen.Iniciar());
+    COMPROBAR(almacen.Cargar(&cargado));
+    COMPROBAR_IGUAL(UINT32_MAX, cargado.secuencia);
+
+    // La secuencia da la vuelta a 0 y aun así es la más reciente
+    snapshot = Partida(3);
+    COMPROBAR(almacen.Guardar(&snapshot));
+    COMPROBAR_IGUAL(0, snapshot.secuencia);
+    COMPROBAR(almacen.Cargar(&cargado));
+    COMPROBAR_IGUAL(0, cargado.secuencia);
+    COMPROBAR_IGUAL(3, cargado.puntaje);
+
+    snapshot = Partida(4);
+    COMPROBAR(almacen.Guardar(&snapshot));
+    COMPROBAR_IGUAL(1, snapshot.secuencia);
+
+    AlmacenSnapshot reiniciado;
+    COMPROBAR(reiniciado.Iniciar());
+    COMPROBAR(reiniciado.Cargar(&cargado));
+    COMPROBAR_IGUAL(1, cargado.secuencia);
+    COMPROBAR_IGUAL(4, cargado.puntaje);
+}
+
+PRUEBA(descartar_borra_todas_las_ranuras)
+{
+    CarpetaNueva();
+    AlmacenSnapshot almacen;
+    SnapshotJuego snapshot, cargado;
+    COMPROBAR(almacen.Iniciar());
+    for (uint16_t i = 1; i <= 5; i++)
+    {
+        snapshot = Partida(i);
+        almacen.Guardar(&snapshot);
+    }
+
+    almacen.Descartar();
+    for (uint8_t ranura = 0; ranura < SNAPSHOT_RANURAS; ranura++)
+        COMPROBAR(!ExisteRanura(ranura));
+    COMPROBAR(!almacen.Cargar(&cargado));
+
+    AlmacenSnapshot reiniciado;
+    COMPROBAR(reiniciado.Iniciar());
+    COMPROBAR(!reiniciado.Cargar(&cargado));
+
+    // Se puede volver a guardar después de descartar
+    snapshot = Partida(9);
+    COMPROBAR(almacen.Guardar(&snapshot));
+    COMPROBAR(almacen.Cargar(&cargado));
+    COMPROBAR_IGUAL(9, cargado.puntaje);
+}
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Compara los microbenchmarks del tablero con la línea base (ver include/Benchmark.h).
+
+El firmware del entorno esp32dev-bench imprime líneas "BENCH <métrica> <valor>"
+y termina con "BENCH_FIN". Este script las lee del puerto serie (o de un archivo
+con la salida capturada), las compara con tools/benchmark_base.json y termina con
+código 1 si alguna métrica empeoró más que su tolerancia, falta en la salida o no
+aparece en la línea base. En todas las métricas un valor menor es mejor.
+
+Una métrica con "valor": null en la línea base todavía no se registró en un
+tablero: se informa como "sin registrar" y no se compara ni cuenta como falla.
+Los tiempos de tools/benchmark_base.json quedan así hasta que alguien corra el
+benchmark en el tablero con --actualizar y confirme el archivo resultante.
+
+Si un archivo trae varias corridas seguidas, cuenta el mínimo de cada métrica: el
+ruido de la máquina sólo hace más lento un benchmark, nunca más rápido.
+
+tests/banco.cpp corre los mismos benchmarks en la PC (make -C tests bench) contra
+tools/benchmark_host.json; sus tiempos no se comparan con los del tablero. Las
+tolerancias de la PC salen del ruido medido entre corridas del mínimo de cinco.
+
+Ejemplos:
+    pio run -e esp32dev-bench -t upload
+    python tools/benchmark.py --puerto /dev/ttyUSB0
+    python tools/benchmark.py --archivo salida.txt
+    python tools/benchmark.py --puerto COM3 --actualizar
+    python tools/benchmark.py --archivo tests/build/banco.txt --base tools/benchmark_host.json
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+BASE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "benchmark_base.json")
+
+
+def leer_lineas_puerto(puerto, baudios, espera, reiniciar):
+    import serial  # pyserial
+
+    with serial.serial_for_url(puerto, baudios, timeout=0.5) as serie:
+        if reiniciar:
+            # EN del ESP32 está conectado a RTS en las tarjetas de desarrollo
+            serie.dtr = False
+            serie.rts = True
+            time.sleep(0.1)
+            serie.rts = False
+        limite = time.monotonic() + espera
+        while time.monotonic() < limite:
+            linea = serie.readline().decode("utf-8", "replace").strip()
+            if linea:
+                yield linea
+                if linea == "BENCH_FIN":
+                    return
+    raise TimeoutError(f"no se recibió BENCH_FIN en {espera} s")
+
+
+def leer_lineas_archivo(ruta):
+    with open(ruta, encoding="utf-8", errors="replace") as f:
+        for linea in f:
+            yield linea.strip()
+
+
+def medir(lineas):
+    metricas = {}
+    for linea in lineas:
+        partes = linea.split()
+        if len(partes) == 3 and partes[0] == "BENCH":
+            valor = float(partes[2])
+            metricas[partes[1]] = min(valor, metricas.get(partes[1], valor))
+    return metricas
+
+
+def comparar(metricas, base):
+    regresiones = []
+    sin_registrar = []
+    print(f"{'métrica':28} {'base':>12} {'medido':>12} {'cambio':>9}")
+    for nombre in sorted(set(base) | set(metricas)):
+        entrada = base.get(nombre, {})
+        referencia = entrada.get("valor")
+        medido = metricas.get(nombre)
+        if medido is None:
+            print(f"{nombre:28} {'':>12} {'falta':>12}")
+            regresiones.append(f"{nombre} (falta)")
+            continue
+        if nombre not in base:
+            # Una métrica nueva que nadie agregó a la línea base no está vigilada
+            print(f"{nombre:28} {'-':>12} {medido:12.2f} {'sin base':>9}")
+            regresiones.append(f"{nombre} (sin base)")
+            continue
+        if referencia is None:
+            print(f"{nombre:28} {'sin registrar':>12} {medido:12.2f}")
+            sin_registrar.append(nombre)
+            continue
+        cambio = (medido - referencia) / referencia if referencia else 0.0
+        marca = ""
+        if cambio > entrada.get("tolerancia", 0.15):
+            marca = "  REGRESIÓN"
+            regresiones.append(nombre)
+        print(f"{nombre:28} {referencia:12.2f} {medido:12.2f} {cambio:+9.1%}{marca}")
+    if sin_registrar:
+        print(f"{len(sin_registrar)} métrica(s) sin registrar en la línea base, no comparadas: {', '.join(sin_registrar)}")
+    return regresiones
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    origen = parser.add_mutually_exclusive_group(required=True)
+    origen.add_argument("--puerto")
+    origen.add_argument("--archivo", help="salida serie ya capturada")
+    parser.add_argument("--baudios", type=int, default=115200)
+    parser.add_argument("--espera", type=float, default=60, help="segundos máximos esperando BENCH_FIN")
+    parser.add_argument("--sin-reinicio", action="store_true", help="no reiniciar el tablero por RTS")
+    parser.add_argument("--base", default=BASE)
+    parser.add_argument("--actualizar", action="store_true", help="guardar lo medido como nueva línea base")
+    args = parser.parse_args()
+
+    if args.puerto:
+        lineas = leer_lineas_puerto(args.puerto, args.baudios, args.espera, not args.sin_reinicio)
+    else:
+        lineas = leer_lineas_archivo(args.archivo)
+    metricas = medir(lineas)
+    if not metricas:
+        sys.exit("no se encontraron líneas BENCH")
+
+    with open(args.base, encoding="utf-8") as f:
+        base = json.load(f)
+
+    if args.actualizar:
+        for nombre, valor in metricas.items():
+            base.setdefault(nombre, {"tolerancia": 0.15})["valor"] = valor
+        with open(args.base, "w", encoding="utf-8") as f:
+            json.dump(base, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"línea base actualizada en {args.base}")
+        return
+
+    regresiones = comparar(metricas, base)
+    if regresiones:
+        print(f"{len(regresiones)} métrica(s) con regresión o sin base: {', '.join(regresiones)}")
+        sys.exit(1)
+    print("sin regresiones")
+
+
+if __name__ == "__main__":
+    main()
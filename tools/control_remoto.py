@@ -0,0 +1,387 @@
+#!/usr/bin/env python3
+"""Cliente del protocolo binario de control remoto (ver include/ControlRemoto.h).
+
+Funciona con el tablero real (puerto serie) o con el simulador de Wokwi a través
+del servidor RFC2217 que se configura en wokwi.toml.
+
+Ejemplos:
+    python tools/control_remoto.py --puerto /dev/ttyUSB0 estado
+    python tools/control_remoto.py --puerto rfc2217://localhost:4000 pantalla
+    python tools/control_remoto.py --puerto COM3 ping -n 200
+    python tools/control_remoto.py --puerto COM3 stream --modo tick --segundos 10
+    python tools/control_remoto.py --puerto COM3 latencia -n 20
+    python tools/control_remoto.py --puerto COM3 escala 100
+    python tools/control_remoto.py --puerto COM3 script sesion.txt
+
+Formato de los scripts (una instrucción por línea, '#' para comentarios):
+    inyectar X Y [enter] [exit]   valores crudos del joystick (0..4095) y botones
+    neutral                       joystick al centro, botones sueltos
+    liberar                       volver a las lecturas reales de los pines
+    esperar MS
+    esperar_estado NOMBRE [MS]    INTRO, MENU, GAME, SCORES o PAUSE
+    escala FACTOR                 velocidad del reloj del juego (0 = congelado, 1 = real, hasta 1000)
+    estado
+    pantalla
+"""
+
+import argparse
+import statistics
+import struct
+import sys
+import time
+
+import serial  # pyserial
+
+SINC = b"\xA5\x5A"
+
+PING = 0x01
+INYECTAR = 0x02
+LIBERAR = 0x03
+ESTADO = 0x04
+PANTALLA = 0x05
+STREAM = 0x06
+INVARIANTES = 0x07
+ESCALA = 0x08
+
+ACK = 0x80
+PONG = 0x81
+R_ESTADO = 0x84
+R_PANTALLA = 0x85
+R_INVARIANTES = 0x87
+NACK = 0xFF
+
+STREAM_APAGADO = 0
+STREAM_POR_TICK = 1
+STREAM_PERIODICO = 2
+
+ESTADOS_JUEGO = ["INTRO", "MENU", "GAME", "SCORES", "PAUSE"]
+FORMATO_ESTADO = struct.Struct("<BBHhBBBBBII")
+
+CENTRO = 2048
+MAXIMO = 4095
+
+
+def crc16(datos, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, igual que ControlRemoto::CRC16."""
+    for b in datos:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def armar_trama(tipo, datos=b""):
+    cuerpo = bytes([tipo, len(datos)]) + datos
+    return SINC + cuerpo + struct.pack("<H", crc16(cuerpo))
+
+
+def decodificar_estado(datos):
+    (estado, nivel, puntaje, tiempo_restante, px, py, dx, dy,
+     banderas, tick, millis) = FORMATO_ESTADO.unpack(datos)
+    return {
+        "estado": ESTADOS_JUEGO[estado] if estado < len(ESTADOS_JUEGO) else estado,
+        "nivel": nivel,
+        "puntaje": puntaje,
+        "tiempo_restante": tiempo_restante,
+        "personaje": (px, py),
+        "diamante": (dx, dy),
+        "en_juego": bool(banderas & 0x01),
+        "pausa": bool(banderas & 0x02),
+        "inyectada": bool(banderas & 0x04),
+        "tick": tick,
+        "millis": millis,
+    }
+
+
+class ErrorRemoto(Exception):
+    pass
+
+
+class ControlRemoto:
+    def __init__(self, puerto, baudios=115200, espera=1.0, eco=False):
+        self.serie = serial.serial_for_url(puerto, baudrate=baudios, timeout=0.05)
+        self.espera = espera
+        self.eco = eco
+        self.bufer = bytearray()
+        self.tramas = []
+
+    def cerrar(self):
+        self.serie.close()
+
+    # --- Transporte ---
+
+    def enviar(self, tipo, datos=b""):
+        self.serie.write(armar_trama(tipo, datos))
+
+    def _extraer_tramas(self):
+        while True:
+            inicio = self.bufer.find(SINC)
+            if inicio < 0:
+                # Texto de depuración sin tramas; conservar un posible 0xA5 final
+                corte = len(self.bufer) - (1 if self.bufer.endswith(b"\xA5") else 0)
+                self._eco(self.bufer[:corte])
+                del self.bufer[:corte]
+                return
+            self._eco(self.bufer[:inicio])
+            del self.bufer[:inicio]
+            if len(self.bufer) < 4:
+                return
+            longitud = self.bufer[3]
+            total = 4 + longitud + 2
+            if len(self.bufer) < total:
+                return
+            cuerpo = bytes(self.bufer[2:4 + longitud])
+            (crc,) = struct.unpack_from("<H", self.bufer, 4 + longitud)
+            if crc == crc16(cuerpo):
+                self.tramas.append((cuerpo[0], cuerpo[2:]))
+                del self.bufer[:total]
+            else:
+                # Sincronía falsa dentro del texto: saltar un byte y seguir buscando
+                del self.bufer[:1]
+
+    def _eco(self, datos):
+        if self.eco and datos:
+            sys.stderr.write(bytes(datos).decode("utf-8", "replace"))
+
+    def recibir(self, tipos, espera=None):
+        """Devuelve la primera trama cuyo tipo esté en 'tipos'."""
+        limite = time.monotonic() + (self.espera if espera is None else espera)
+        while True:
+            for i, (tipo, datos) in enumerate(self.tramas):
+                if tipo in tipos or tipo == NACK:
+                    del self.tramas[i]
+                    if tipo == NACK and NACK not in tipos:
+                        raise ErrorRemoto(f"NACK del comando 0x{datos[0]:02X}, código {datos[1]}")
+                    return tipo, datos
+            if time.monotonic() > limite:
+                raise TimeoutError(f"sin respuesta (esperando {[hex(t) for t in tipos]})")
+            self.bufer += self.serie.read(max(1, self.serie.in_waiting))
+            self._extraer_tramas()
+
+    def _comando_con_ack(self, tipo, datos=b""):
+        self.enviar(tipo, datos)
+        _, respuesta = self.recibir({ACK})
+        if respuesta[0] != tipo:
+            raise ErrorRemoto(f"ACK inesperado para 0x{respuesta[0]:02X}")
+
+    # --- Comandos ---
+
+    def ping(self, datos=b""):
+        self.enviar(PING, datos)
+        _, respuesta = self.recibir({PONG})
+        return respuesta
+
+    def inyectar(self, x=CENTRO, y=CENTRO, enter=False, salir=False):
+        botones = (0x01 if enter else 0) | (0x02 if salir else 0)
+        self._comando_con_ack(INYECTAR, struct.pack("<HHB", x, y, botones))
+
+    def liberar(self):
+        self._comando_con_ack(LIBERAR)
+
+    def estado(self):
+        self.enviar(ESTADO)
+        _, datos = self.recibir({R_ESTADO})
+        return decodificar_estado(datos)
+
+    def pantalla(self):
+        self.enviar(PANTALLA)
+        _, datos = self.recibir({R_PANTALLA})
+        columnas, filas = datos[0], datos[1]
+        celdas = datos[2:]
+        return [celdas[f * columnas:(f + 1) * columnas] for f in range(filas)]
+
+    def invariantes(self):
+        """(violaciones, última invariante, línea) del firmware esp32dev-soak."""
+        self.enviar(INVARIANTES)
+        _, datos = self.recibir({R_INVARIANTES})
+        violaciones, ultima, linea, _ = struct.unpack("<HBHI", datos)
+        return violaciones, ultima, linea
+
+    def escala(self, factor):
+        """Velocidad del reloj del juego: 0 lo congela, 1 es tiempo real, hasta 1000."""
+        self._comando_con_ack(ESCALA, struct.pack("<I", round(factor * 1000)))
+
+    def stream(self, modo, periodo_ms=0):
+        self._comando_con_ack(STREAM, struct.pack("<BH", modo, periodo_ms))
+
+    def estados_stream(self, segundos):
+        limite = time.monotonic() + segundos
+        while time.monotonic() < limite:
+            try:
+                _, datos = self.recibir({R_ESTADO}, espera=limite - time.monotonic())
+            except TimeoutError:
+                return
+            yield time.monotonic(), decodificar_estado(datos)
+
+    def esperar_estado(self, nombre, espera=10.0):
+        limite = time.monotonic() + espera
+        while time.monotonic() < limite:
+            actual = self.estado()
+            if actual["estado"] == nombre:
+                return actual
+            time.sleep(0.02)
+        raise TimeoutError(f"el juego no llegó a {nombre}")
+
+
+def pantalla_a_texto(filas):
+    # Los glifos personalizados (0..7) se muestran como dígitos entre corchetes
+    lineas = []
+    for fila in filas:
+        lineas.append("".join(chr(c) if 32 <= c < 127 else f"[{c}]" if c < 8 else "#" for c in fila))
+    return "\n".join(lineas)
+
+
+# --- Subcomandos ---
+
+def cmd_estado(remoto, args):
+    print(remoto.estado())
+
+
+def cmd_pantalla(remoto, args):
+    print(pantalla_a_texto(remoto.pantalla()))
+
+
+def cmd_invariantes(remoto, args):
+    violaciones, ultima, linea = remoto.invariantes()
+    print(f"violaciones={violaciones} ultima={ultima} linea={linea}")
+
+
+def cmd_escala(remoto, args):
+    remoto.escala(args.factor)
+
+
+def cmd_ping(remoto, args):
+    tiempos = []
+    for i in range(args.n):
+        carga = struct.pack("<I", i)
+        inicio = time.perf_counter()
+        if remoto.ping(carga) != carga:
+            raise ErrorRemoto("PONG con datos distintos")
+        tiempos.append((time.perf_counter() - inicio) * 1000)
+    imprimir_estadisticas("ida y vuelta (ms)", tiempos)
+
+
+def cmd_stream(remoto, args):
+    modo = STREAM_POR_TICK if args.modo == "tick" else STREAM_PERIODICO
+    remoto.stream(modo, args.periodo)
+    recibidos = []
+    try:
+        for instante, estado in remoto.estados_stream(args.segundos):
+            recibidos.append((instante, estado))
+            if args.verbose:
+                print(estado)
+    finally:
+        remoto.stream(STREAM_APAGADO)
+    if len(recibidos) < 2:
+        print("no se recibieron suficientes estados")
+        return
+    duracion = recibidos[-1][0] - recibidos[0][0]
+    ticks = recibidos[-1][1]["tick"] - recibidos[0][1]["tick"]
+    print(f"estados recibidos: {len(recibidos)} ({len(recibidos) / duracion:.1f}/s)")
+    print(f"ticks de la lógica: {ticks} ({ticks / duracion:.1f}/s)")
+
+
+def cmd_latencia(remoto, args):
+    """Mide desde que se inyecta un movimiento hasta que el estado lo refleja."""
+    remoto.stream(STREAM_APAGADO)
+    remoto.esperar_estado("GAME", espera=args.espera)
+    tiempos = []
+    try:
+        for _ in range(args.n):
+            remoto.inyectar()
+            time.sleep(0.3)
+            antes = remoto.estado()["personaje"]
+            x = MAXIMO if antes[0] == 0 else 0
+            inicio = time.perf_counter()
+            remoto.inyectar(x=x)
+            while remoto.estado()["personaje"] == antes:
+                if time.perf_counter() - inicio > 2:
+                    raise TimeoutError("el personaje no se movió")
+            tiempos.append((time.perf_counter() - inicio) * 1000)
+    finally:
+        remoto.liberar()
+    imprimir_estadisticas("entrada -> estado (ms)", tiempos)
+
+
+def cmd_script(remoto, args):
+    with open(args.archivo, encoding="utf-8") as f:
+        for numero, linea in enumerate(f, 1):
+            partes = linea.split("#", 1)[0].split()
+            if not partes:
+                continue
+            instruccion, parametros = partes[0].lower(), partes[1:]
+            if instruccion == "inyectar":
+                x, y = int(parametros[0]), int(parametros[1])
+                remoto.inyectar(x, y, "enter" in parametros[2:], "exit" in parametros[2:])
+            elif instruccion == "neutral":
+                remoto.inyectar()
+            elif instruccion == "liberar":
+                remoto.liberar()
+            elif instruccion == "esperar":
+                time.sleep(int(parametros[0]) / 1000)
+            elif instruccion == "esperar_estado":
+                espera = int(parametros[1]) / 1000 if len(parametros) > 1 else 10.0
+                remoto.esperar_estado(parametros[0].upper(), espera)
+            elif instruccion == "escala":
+                remoto.escala(float(parametros[0]))
+            elif instruccion == "estado":
+                print(remoto.estado())
+            elif instruccion == "pantalla":
+                print(pantalla_a_texto(remoto.pantalla()))
+            else:
+                raise ValueError(f"{args.archivo}:{numero}: instrucción desconocida '{instruccion}'")
+
+
+def imprimir_estadisticas(titulo, valores):
+    valores = sorted(valores)
+    p95 = valores[min(len(valores) - 1, int(len(valores) * 0.95))]
+    print(f"{titulo}: n={len(valores)} min={valores[0]:.2f} mediana={statistics.median(valores):.2f} "
+          f"p95={p95:.2f} max={valores[-1]:.2f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--puerto", required=True, help="puerto serie o URL (rfc2217://host:puerto)")
+    parser.add_argument("--baudios", type=int, default=115200)
+    parser.add_argument("--eco", action="store_true", help="mostrar en stderr el texto de depuración")
+    sub = parser.add_subparsers(dest="comando", required=True)
+
+    sub.add_parser("estado").set_defaults(funcion=cmd_estado)
+    sub.add_parser("pantalla").set_defaults(funcion=cmd_pantalla)
+    sub.add_parser("invariantes").set_defaults(funcion=cmd_invariantes)
+
+    p = sub.add_parser("ping")
+    p.add_argument("-n", type=int, default=100)
+    p.set_defaults(funcion=cmd_ping)
+
+    p = sub.add_parser("escala")
+    p.add_argument("factor", type=float, help="0 = congelado, 1 = tiempo real, hasta 1000")
+    p.set_defaults(funcion=cmd_escala)
+
+    p = sub.add_parser("stream")
+    p.add_argument("--modo", choices=["tick", "periodico"], default="tick")
+    p.add_argument("--periodo", type=int, default=10, help="ms entre estados en modo periódico")
+    p.add_argument("--segundos", type=float, default=5)
+    p.add_argument("-v", "--verbose", action="store_true")
+    p.set_defaults(funcion=cmd_stream)
+
+    p = sub.add_parser("latencia")
+    p.add_argument("-n", type=int, default=20)
+    p.add_argument("--espera", type=float, default=30, help="segundos para llegar a una partida")
+    p.set_defaults(funcion=cmd_latencia)
+
+    p = sub.add_parser("script")
+    p.add_argument("archivo")
+    p.set_defaults(funcion=cmd_script)
+
+    args = parser.parse_args()
+    remoto = ControlRemoto(args.puerto, args.baudios, eco=args.eco)
+    try:
+        args.funcion(remoto, args)
+    finally:
+        remoto.cerrar()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""Histogramas de latencia joystick -> LCD a partir de las trazas del tablero (ver include/Latencia.h).
+
+El firmware del entorno esp32dev-latencia vuelca al terminar cada partida:
+    LAT_INICIO <cerradas> <sin_cerrar>
+    LATH <etapa> <cuenta> <min> <p50> <p90> <p99> <max>
+    LATB <etapa> <cubeta>:<cuenta> ...
+    LATT <muestra> <publicado> <consumido> <presentado> <envio> <fin>   (micros)
+    LAT_FIN
+
+Este script reproduce las trazas crudas (LATT) con el mismo esquema de cubetas del
+tablero y muestra los percentiles por etapa. Si el volcado trae todas las trazas de
+la partida, comprueba que los histogramas coinciden con los del tablero (LATB).
+Con --periodo-cuadro estima cómo cambiaría la latencia con otra compuerta de
+actualización (hoy 100 ms) sin volver a flashear.
+
+Ejemplos:
+    pio run -e esp32dev-latencia -t upload
+    python tools/latencia.py --puerto /dev/ttyUSB0
+    python tools/latencia.py --archivo salida.txt --csv trazas.csv
+    python tools/latencia.py --archivo salida.txt --periodo-cuadro 50
+"""
+
+import argparse
+import csv
+import sys
+import time
+
+ETAPAS = ["rebote", "espera", "actualizacion", "cola_render", "envio", "total"]
+CAMPOS = ["muestra", "publicado", "consumido", "presentado", "envio", "fin"]
+CUBETAS = 128
+PERCENTILES = [50, 90, 99]
+MASCARA = 0xFFFFFFFF
+
+
+def leer_lineas_puerto(puerto, baudios, espera):
+    import serial  # pyserial
+
+    with serial.serial_for_url(puerto, baudios, timeout=0.5) as serie:
+        limite = time.monotonic() + espera
+        while time.monotonic() < limite:
+            linea = serie.readline().decode("utf-8", "replace").strip()
+            if linea:
+                yield linea
+                if linea == "LAT_FIN":
+                    return
+    raise TimeoutError(f"no se recibió LAT_FIN en {espera} s")
+
+
+def leer_lineas_archivo(ruta):
+    with open(ruta, encoding="utf-8", errors="replace") as f:
+        for linea in f:
+            yield linea.strip()
+
+
+def leer_volcados(lineas):
+    """Lista de volcados: {'cerradas', 'sin_cerrar', 'trazas', 'cubetas'}."""
+    volcados = []
+    actual = None
+    for linea in lineas:
+        partes = linea.split()
+        if not partes:
+            continue
+        if partes[0] == "LAT_INICIO" and len(partes) == 3:
+            actual = {"cerradas": int(partes[1]), "sin_cerrar": int(partes[2]), "trazas": [], "cubetas": {}}
+        elif actual is None:
+            continue
+        elif partes[0] == "LATT" and len(partes) == 7:
+            actual["trazas"].append([int(p) for p in partes[1:]])
+        elif partes[0] == "LATB" and len(partes) >= 2:
+            actual["cubetas"][partes[1]] = {int(i): int(c) for i, c in (p.split(":") for p in partes[2:])}
+        elif partes[0] == "LAT_FIN":
+            volcados.append(actual)
+            actual = None
+    return volcados
+
+
+def indice(us):
+    """El mismo que HistogramaLatencia::Indice: exacto hasta 15, luego 4 cubetas por octava."""
+    if us < 16:
+        return us
+    octava = us.bit_length() - 1
+    return 16 + (octava - 4) * 4 + ((us >> (octava - 2)) & 3)
+
+
+def limite_superior(i):
+    if i < 16:
+        return i
+    octava = 4 + (i - 16) // 4
+    return ((4 + (i - 16) % 4 + 1) << (octava - 2)) - 1
+
+
+class Histograma:
+    def __init__(self):
+        self.cubetas = [0] * CUBETAS
+        self.valores = []
+
+    def registrar(self, us):
+        self.cubetas[indice(us)] += 1
+        self.valores.append(us)
+
+    def percentil(self, p):
+        """Como en el tablero: límite superior de la cubeta del rango ceil(n*p/100)."""
+        if not self.valores:
+            return 0
+        objetivo = max(1, (len(self.valores) * p + 99) // 100)
+        acumulado = 0
+        for i, cuenta in enumerate(self.cubetas):
+            acumulado += cuenta
+            if acumulado >= objetivo:
+                return min(limite_superior(i), max(self.valores))
+        return max(self.valores)
+
+    def no_vacias(self):
+        return {i: c for i, c in enumerate(self.cubetas) if c}
+
+
+def duraciones(traza):
+    muestra, publicado, consumido, presentado, envio, fin = traza
+    return [(b - a) & MASCARA for a, b in (
+        (muestra, publicado), (publicado, consumido), (consumido, presentado),
+        (presentado, envio), (envio, fin), (muestra, fin))]
+
+
+def construir(trazas):
+    histogramas = {etapa: Histograma() for etapa in ETAPAS}
+    for traza in trazas:
+        for etapa, us in zip(ETAPAS, duraciones(traza)):
+            histogramas[etapa].registrar(us)
+    return histogramas
+
+
+def recuantizar(trazas, periodo_us):
+    """Repite las trazas con otra compuerta: el evento se toma en el siguiente tick de
+    una rejilla de 'periodo_us' alineada con el primer cuadro; el resto de las etapas
+    conserva su duración medida."""
+    if not trazas:
+        return []
+    origen = trazas[0][2]
+    nuevas = []
+    for muestra, publicado, consumido, presentado, envio, fin in trazas:
+        desde_origen = (publicado - origen) & MASCARA
+        ticks = -(-desde_origen // periodo_us)
+        nuevo = (origen + ticks * periodo_us) & MASCARA
+        desplazamiento = (nuevo - consumido) & MASCARA
+        nuevas.append([muestra, publicado] + [(t + desplazamiento) & MASCARA for t in (consumido, presentado, envio, fin)])
+    return nuevas
+
+
+def imprimir(histogramas, titulo):
+    print(titulo)
+    print(f"  {'etapa':14} {'n':>6} {'min':>8} " + " ".join(f"{'p' + str(p):>8}" for p in PERCENTILES) + f" {'max':>8}   (us)")
+    for etapa in ETAPAS:
+        h = histogramas[etapa]
+        if not h.valores:
+            print(f"  {etapa:14} {0:6}")
+            continue
+        percentiles = " ".join(f"{h.percentil(p):8}" for p in PERCENTILES)
+        print(f"  {etapa:14} {len(h.valores):6} {min(h.valores):8} {percentiles} {max(h.valores):8}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    origen = parser.add_mutually_exclusive_group(required=True)
+    origen.add_argument("--puerto")
+    origen.add_argument("--archivo", help="salida serie ya capturada")
+    parser.add_argument("--baudios", type=int, default=115200)
+    parser.add_argument("--espera", type=float, default=600, help="segundos máximos esperando LAT_FIN")
+    parser.add_argument("--ultimo", action="store_true", help="usar sólo el último volcado (por omisión se juntan todos)")
+    parser.add_argument("--csv", help="escribir las trazas y sus etapas en este CSV")
+    parser.add_argument("--periodo-cuadro", type=float, metavar="MS", help="estimar la latencia con otra compuerta de cuadro")
+    args = parser.parse_args()
+
+    if args.puerto:
+        lineas = leer_lineas_puerto(args.puerto, args.baudios, args.espera)
+    else:
+        lineas = leer_lineas_archivo(args.archivo)
+    volcados = leer_volcados(lineas)
+    if not volcados:
+        sys.exit("no se encontró ningún volcado LAT_INICIO ... LAT_FIN")
+    if args.ultimo:
+        volcados = volcados[-1:]
+
+    discrepancias = 0
+    for n, volcado in enumerate(volcados, 1):
+        if volcado["sin_cerrar"]:
+            print(f"volcado {n}: {volcado['sin_cerrar']} traza(s) en cuadros descartados")
+        if len(volcado["trazas"]) != volcado["cerradas"]:
+            continue  # El anillo del tablero sólo guardó las últimas: no se puede comparar
+        propios = construir(volcado["trazas"])
+        for etapa in ETAPAS:
+            if etapa in volcado["cubetas"] and propios[etapa].no_vacias() != volcado["cubetas"][etapa]:
+                print(f"volcado {n}: el histograma '{etapa}' no coincide con el del tablero")
+                discrepancias += 1
+
+    trazas = [t for v in volcados for t in v["trazas"]]
+    imprimir(construir(trazas), f"{len(trazas)} trazas de {len(volcados)} volcado(s)")
+
+    if args.periodo_cuadro:
+        estimadas = recuantizar(trazas, int(args.periodo_cuadro * 1000))
+        imprimir(construir(estimadas), f"estimación con compuerta de {args.periodo_cuadro:g} ms")
+
+    if args.csv:
+        with open(args.csv, "w", newline="", encoding="utf-8") as f:
+            escritor = csv.writer(f)
+            escritor.writerow(CAMPOS + [f"{e}_us" for e in ETAPAS])
+            for traza in trazas:
+                escritor.writerow(traza + duraciones(traza))
+
+    if discrepancias:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
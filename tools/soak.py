@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+"""Prueba de resistencia (soak) y fuzzing de la máquina de estados del juego.
+
+Maneja el tablero (o el simulador de Wokwi) con el protocolo de control remoto:
+inyecta secuencias aleatorias de joystick y botones, recibe el estado en cada tick
+de la lógica y verifica invariantes. Las secuencias que descubren transiciones
+nuevas se guardan y se mutan (fuzzing guiado por cobertura). Cuando una secuencia
+falla se minimiza con delta debugging y se guarda como script reproducible para
+tools/control_remoto.py.
+
+Conviene usar el firmware del entorno esp32dev-soak, que además verifica
+invariantes dentro del tablero (bandera VERIFICAR_INVARIANTES).
+
+Ésta es la variante para el tablero: la UART limita la prueba a unos cientos de
+ticks por minuto. La búsqueda larga se hace en la PC con tests/soak.cpp
+(make -C tests soak), que corre el mismo firmware con tiempo simulado a millones
+de ticks por minuto y guarda los fallos con el mismo formato de script; aquí se
+confirman en el hardware real (tiempos, SD, pantalla).
+
+Ejemplos:
+    python tools/soak.py --puerto /dev/ttyUSB0 --minutos 30
+    python tools/soak.py --puerto rfc2217://localhost:4000 --reinicio ninguno --semilla 7
+"""
+
+import argparse
+import random
+import sys
+import time
+
+import control_remoto as cr
+
+# Campo de juego (columnas, filas) de cada geometría de include/Geometria.h
+CAMPOS = {"16x2": (14, 2), "20x4": (16, 4), "40x4": (32, 4)}
+ANCHO_JUEGO, FILAS = CAMPOS["16x2"]
+INVARIANTES = {
+    1: "puntaje decreciente",
+    2: "estado perdido en la cola",
+    3: "índice de nivel",
+    4: "posición del personaje",
+    5: "posición del selector de nombre",
+}
+
+
+# --- Secuencias de entrada ---
+
+def accion_aleatoria(rnd):
+    """(x, y, enter, exit, duración en ms) con sesgo hacia entradas útiles."""
+    x = rnd.choice([0, cr.CENTRO, cr.CENTRO, cr.MAXIMO])
+    y = rnd.choice([0, cr.CENTRO, cr.CENTRO, cr.MAXIMO])
+    enter = rnd.random() < 0.15
+    salir = rnd.random() < 0.08
+    duracion = rnd.choice([30, 60, 120, 250, 500, 1200])
+    return (x, y, enter, salir, duracion)
+
+
+def secuencia_aleatoria(rnd, longitud):
+    return [accion_aleatoria(rnd) for _ in range(longitud)]
+
+
+def mutar(rnd, secuencia):
+    nueva = list(secuencia)
+    for _ in range(rnd.randint(1, 4)):
+        operacion = rnd.random()
+        posicion = rnd.randrange(len(nueva) + 1)
+        if operacion < 0.4 or not nueva:
+            nueva.insert(posicion, accion_aleatoria(rnd))
+        elif operacion < 0.7:
+            del nueva[min(posicion, len(nueva) - 1)]
+        else:
+            nueva[min(posicion, len(nueva) - 1)] = accion_aleatoria(rnd)
+    return nueva
+
+
+def guardar_script(secuencia, ruta, comentario):
+    with open(ruta, "w", encoding="utf-8") as f:
+        f.write(f"# {comentario}\n")
+        f.write("esperar_estado MENU 15000\n")
+        for x, y, enter, salir, duracion in secuencia:
+            botones = (" enter" if enter else "") + (" exit" if salir else "")
+            f.write(f"inyectar {x} {y}{botones}\nesperar {duracion}\n")
+        f.write("liberar\nestado\n")
+
+
+# --- Ejecución y verificación ---
+
+class Fallo(Exception):
+    pass
+
+
+class Verificador:
+    """Invariantes que se comprueban desde la PC con cada estado recibido."""
+
+    def __init__(self):
+        self.anterior = None
+
+    def revisar(self, estado):
+        if estado["estado"] not in cr.ESTADOS_JUEGO:
+            raise Fallo(f"estado de juego inválido: {estado['estado']}")
+        px, py = estado["personaje"]
+        if not (0 <= px < ANCHO_JUEGO and 0 <= py < FILAS):
+            raise Fallo(f"personaje fuera de la pantalla: {estado['personaje']}")
+        previo = self.anterior
+        self.anterior = estado
+        if previo is None or not (previo["en_juego"] and estado["en_juego"]):
+            return
+        # Dentro de una misma partida el puntaje nunca baja
+        if estado["puntaje"] < previo["puntaje"]:
+            raise Fallo(f"el puntaje bajó de {previo['puntaje']} a {estado['puntaje']}")
+        if estado["tick"] < previo["tick"]:
+            raise Fallo("el contador de ticks retrocedió")
+
+
+class Soak:
+    def __init__(self, remoto, reinicio, rnd):
+        self.remoto = remoto
+        self.reinicio = reinicio
+        self.rnd = rnd
+        self.cobertura = set()
+        self.corpus = []
+        self.ticks = 0
+        self.ejecuciones = 0
+
+    def reiniciar_tablero(self):
+        if self.reinicio == "rts":
+            # EN del ESP32 está conectado a RTS en las tarjetas de desarrollo
+            self.remoto.serie.dtr = False
+            self.remoto.serie.rts = True
+            time.sleep(0.1)
+            self.remoto.serie.rts = False
+            time.sleep(0.5)
+            self.remoto.bufer.clear()
+            self.remoto.tramas.clear()
+        self.remoto.inyectar()
+        self.remoto.esperar_estado("MENU", espera=20)
+
+    def ejecutar(self, secuencia):
+        """Ejecuta la secuencia; devuelve las transiciones nuevas o lanza Fallo."""
+        self.reiniciar_tablero()
+        violaciones_iniciales = self.remoto.invariantes()[0]
+        verificador = Verificador()
+        cubierto = set()
+        previo = None
+
+        def registrar(estado):
+            nonlocal previo
+            verificador.revisar(estado)
+            clave = (estado["estado"], estado["nivel"], estado["pausa"], estado["en_juego"])
+            cubierto.add(clave)
+            if previo is not None and previo != estado["estado"]:
+                cubierto.add((previo, estado["estado"]))
+            previo = estado["estado"]
+
+        self.remoto.stream(cr.STREAM_POR_TICK)
+        tick_inicial = None
+        ultimo_tick = None
+        try:
+            for x, y, enter, salir, duracion in secuencia:
+                self.remoto.inyectar(x, y, enter, salir)
+                registrar(self.remoto.estado())
+                for _, estado in self.remoto.estados_stream(duracion / 1000):
+                    registrar(estado)
+                    tick_inicial = estado["tick"] if tick_inicial is None else tick_inicial
+                    ultimo_tick = estado["tick"]
+        finally:
+            self.remoto.stream(cr.STREAM_APAGADO)
+            self.remoto.inyectar()
+
+        if tick_inicial is not None:
+            self.ticks += ultimo_tick - tick_inicial
+        self.ejecuciones += 1
+
+        violaciones, ultima, linea = self.remoto.invariantes()
+        if violaciones > violaciones_iniciales:
+            raise Fallo(f"invariante del tablero: {INVARIANTES.get(ultima, ultima)} (línea {linea})")
+
+        nuevas = cubierto - self.cobertura
+        self.cobertura |= cubierto
+        return nuevas
+
+    def falla(self, secuencia):
+        try:
+            self.ejecutar(secuencia)
+            return None
+        except (Fallo, TimeoutError, cr.ErrorRemoto) as e:
+            return str(e)
+
+    def minimizar(self, secuencia):
+        """Delta debugging (ddmin): la secuencia más corta que sigue fallando."""
+        n = 2
+        while len(secuencia) >= 2:
+            tamano = len(secuencia) // n
+            redujo = False
+            for i in range(n):
+                complemento = secuencia[:i * tamano] + secuencia[(i + 1) * tamano:]
+                if complemento and self.falla(complemento):
+                    print(f"  minimizada a {len(complemento)} acciones")
+                    secuencia = complemento
+                    n = max(n - 1, 2)
+                    redujo = True
+                    break
+            if not redujo:
+                if n >= len(secuencia):
+                    break
+                n = min(n * 2, len(secuencia))
+        return secuencia
+
+    def siguiente_secuencia(self, longitud):
+        if self.corpus and self.rnd.random() < 0.6:
+            return mutar(self.rnd, self.rnd.choice(self.corpus))
+        return secuencia_aleatoria(self.rnd, longitud)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--puerto", required=True)
+    parser.add_argument("--baudios", type=int, default=115200)
+    parser.add_argument("--minutos", type=float, default=10)
+    parser.add_argument("--longitud", type=int, default=40, help="acciones por secuencia aleatoria")
+    parser.add_argument("--semilla", type=int, default=None)
+    parser.add_argument("--reinicio", choices=["rts", "ninguno"], default="rts",
+                        help="cómo reiniciar el tablero antes de cada secuencia")
+    parser.add_argument("--salida", default="fallo_soak.txt", help="script con la secuencia minimizada")
+    parser.add_argument("--pantalla", choices=sorted(CAMPOS), default="16x2",
+                        help="geometría con la que se compiló el firmware")
+    args = parser.parse_args()
+
+    global ANCHO_JUEGO, FILAS
+    ANCHO_JUEGO, FILAS = CAMPOS[args.pantalla]
+
+    semilla = args.semilla if args.semilla is not None else random.randrange(1 << 30)
+    print(f"semilla: {semilla}")
+    rnd = random.Random(semilla)
+    remoto = cr.ControlRemoto(args.puerto, args.baudios)
+    soak = Soak(remoto, args.reinicio, rnd)
+    limite = time.monotonic() + args.minutos * 60
+    inicio = time.monotonic()
+
+    try:
+        while time.monotonic() < limite:
+            secuencia = soak.siguiente_secuencia(args.longitud)
+            error = None
+            try:
+                nuevas = soak.ejecutar(secuencia)
+                if nuevas:
+                    soak.corpus.append(secuencia)
+            except (Fallo, TimeoutError, cr.ErrorRemoto) as e:
+                error = str(e)
+
+            transcurrido = time.monotonic() - inicio
+            print(f"[{transcurrido:7.1f}s] ejecuciones={soak.ejecuciones} ticks={soak.ticks} "
+                  f"({soak.ticks / transcurrido * 60:.0f}/min) cobertura={len(soak.cobertura)} "
+                  f"corpus={len(soak.corpus)}")
+
+            if error:
+                print(f"FALLO: {error}")
+                minima = soak.minimizar(secuencia)
+                guardar_script(minima, args.salida, f"semilla {semilla}: {error}")
+                print(f"secuencia mínima ({len(minima)} acciones) guardada en {args.salida}")
+                sys.exit(1)
+    finally:
+        try:
+            remoto.liberar()
+        finally:
+            remoto.cerrar()
+
+    print("sin fallos")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Convierte el registro binario de telemetría (telemetria.bin) a CSV.
+
+Cada registro mide 16 bytes (ver include/Telemetria.h):
+    uint32 tiempo, uint8 tipo, uint8 nivel, uint16 sesion, uint16 a, uint16 b, uint32 c
+
+Uso:
+    python tools/telemetria_csv.py telemetria.bin > eventos.csv
+    python tools/telemetria_csv.py telemetria.bin --sesiones > sesiones.csv
+    python tools/telemetria_csv.py telemetria.bin --energia > energia.csv
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+REGISTRO = struct.Struct("<IBBHHHI")
+VERSION_SOPORTADA = 1
+
+TIPOS = {
+    1: "arranque",
+    2: "sesion_inicio",
+    3: "sesion_fin",
+    4: "sesion_abandonada",
+    5: "nivel_fin",
+    6: "pausa",
+    7: "reanudar",
+    8: "cuadros",
+    9: "perdidos",
+    10: "energia",
+}
+
+NIVELES_ENERGIA = ["activo", "ahorro", "sueno"]
+
+COLUMNAS = [
+    "arranque", "tiempo_ms", "sesion", "evento", "nivel",
+    "puntaje", "obtenidos", "requeridos", "superado", "pausas", "duracion_ms",
+    "cuadros", "cuadro_prom_us", "cuadro_min_us", "cuadro_max_us", "perdidos",
+    "energia", "energia_anterior",
+]
+
+
+def leer_registros(ruta):
+    with open(ruta, "rb") as f:
+        datos = f.read()
+    sobrante = len(datos) % REGISTRO.size
+    if sobrante:
+        print(f"aviso: se ignoran {sobrante} bytes finales incompletos", file=sys.stderr)
+    for desplazamiento in range(0, len(datos) - sobrante, REGISTRO.size):
+        yield REGISTRO.unpack_from(datos, desplazamiento)
+
+
+def nivel_energia(valor):
+    return NIVELES_ENERGIA[valor] if valor < len(NIVELES_ENERGIA) else valor
+
+
+def resumir_energia(filas):
+    """Tiempo total en cada nivel de energía por arranque (sólo tramos cerrados)."""
+    totales = {}
+    for fila in filas:
+        if fila["evento"] != "energia":
+            continue
+        t = totales.setdefault(fila["arranque"], dict.fromkeys(NIVELES_ENERGIA, 0))
+        t[fila["energia_anterior"]] = t.get(fila["energia_anterior"], 0) + fila["duracion_ms"]
+    return [{"arranque": arranque, **{f"{n}_ms": v for n, v in t.items()}} for arranque, t in totales.items()]
+
+
+def decodificar(ruta):
+    """Genera un diccionario por registro con las columnas de COLUMNAS."""
+    arranque = 0
+    for tiempo, tipo, nivel, sesion, a, b, c in leer_registros(ruta):
+        fila = dict.fromkeys(COLUMNAS, "")
+        fila.update(tiempo_ms=tiempo, sesion=sesion, nivel=nivel,
+                    evento=TIPOS.get(tipo, f"desconocido_{tipo}"))
+
+        if tipo == 1:
+            arranque += 1
+            if c != VERSION_SOPORTADA:
+                print(f"aviso: version de formato {c} no soportada", file=sys.stderr)
+        elif tipo == 2:
+            fila.update(puntaje=b)
+        elif tipo in (3, 4):
+            fila.update(pausas=a, puntaje=b, duracion_ms=c)
+        elif tipo == 5:
+            fila.update(obtenidos=a, requeridos=b, superado=c)
+        elif tipo == 6:
+            fila.update(pausas=a, puntaje=b)
+        elif tipo == 7:
+            fila.update(pausas=a, duracion_ms=c)
+        elif tipo == 8:
+            fila.update(cuadros=a, cuadro_prom_us=b, cuadro_min_us=c & 0xFFFF, cuadro_max_us=c >> 16)
+        elif tipo == 9:
+            fila.update(perdidos=c)
+        elif tipo == 10:
+            fila.update(energia=nivel_energia(a), energia_anterior=nivel_energia(b), duracion_ms=c)
+
+        fila["arranque"] = arranque
+        yield fila
+
+
+def resumir_sesiones(filas):
+    """Agrupa los eventos en una fila por sesión."""
+    sesiones = {}
+    for fila in filas:
+        if fila["sesion"] == 0:
+            continue
+        clave = (fila["arranque"], fila["sesion"])
+        s = sesiones.setdefault(clave, {
+            "arranque": clave[0], "sesion": clave[1], "resultado": "incompleta",
+            "niveles_superados": "", "nivel_fallado": "", "puntaje": "",
+            "pausas": 0, "duracion_ms": "",
+        })
+        evento = fila["evento"]
+        if evento == "nivel_fin" and not fila["superado"] and s["nivel_fallado"] == "":
+            s["nivel_fallado"] = fila["nivel"]
+        elif evento == "pausa":
+            s["pausas"] = fila["pausas"]
+        elif evento in ("sesion_fin", "sesion_abandonada"):
+            s.update(resultado="terminada" if evento == "sesion_fin" else "abandonada",
+                     niveles_superados=fila["nivel"], puntaje=fila["puntaje"],
+                     pausas=fila["pausas"], duracion_ms=fila["duracion_ms"])
+    return list(sesiones.values())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("archivo", help="telemetria.bin copiado de la SD")
+    resumen = parser.add_mutually_exclusive_group()
+    resumen.add_argument("--sesiones", action="store_true", help="una fila por sesión en lugar de una por evento")
+    resumen.add_argument("--energia", action="store_true", help="tiempo en cada nivel de energía por arranque")
+    args = parser.parse_args()
+
+    filas = decodificar(args.archivo)
+    if args.energia:
+        filas = resumir_energia(filas)
+        columnas = ["arranque"] + [f"{n}_ms" for n in NIVELES_ENERGIA]
+    elif args.sesiones:
+        filas = resumir_sesiones(filas)
+        columnas = ["arranque", "sesion", "resultado", "niveles_superados", "nivel_fallado",
+                    "puntaje", "pausas", "duracion_ms"]
+    else:
+        columnas = COLUMNAS
+
+    escritor = csv.DictWriter(sys.stdout, fieldnames=columnas)
+    escritor.writeheader()
+    escritor.writerows(filas)
+
+
+if __name__ == "__main__":
+    main()
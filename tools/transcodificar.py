@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""Convierte pistas WAV al formato .adp que reproduce el mezclador (ver include/PistaAudio.h).
+
+La pista se mezcla a mono, se remuestrea a la frecuencia del mezclador y se codifica
+en bloques de 512 bytes (un sector de la SD) de IMA-ADPCM, o de PCM de 16 bits con
+--pcm. Cada bloque ADPCM guarda su predictor e índice, así que se decodifica solo.
+Por omisión la pista completa se repite en bucle; --bucle fija otro tramo y
+--sin-bucle la reproduce una vez.
+
+Disposición del archivo:
+    sector 0      cabecera (magia "PADP", formato, total de muestras, bucle, tabla)
+    sector 1..    tabla de búsqueda: uint32 con el desplazamiento del bloque i*intervalo
+    ...           bloques de datos, alineados a sector
+
+Sólo lee WAV PCM (8, 16, 24 o 32 bits). Para MP3 u otros formatos, convertir antes:
+    ffmpeg -i game.mp3 game.wav
+
+Uso:
+    python tools/transcodificar.py game.wav game.adp
+    python tools/transcodificar.py intro.wav intro.adp --sin-bucle
+    python tools/transcodificar.py menu.wav menu.adp --bucle 1.25 31.8 --verificar menu_adp.wav
+"""
+
+import argparse
+import math
+import struct
+import sys
+import wave
+
+MAGIA = 0x50444150  # "PADP"
+VERSION = 1
+TAM_SECTOR = 512
+TAM_BLOQUE = 512
+SIN_BUCLE = 0xFFFFFFFF
+FRECUENCIA = 22050  # MEZCLADOR_FRECUENCIA
+INTERVALO_BUSQUEDA = 16  # Bloques por entrada de la tabla (~0.74 s en ADPCM)
+
+CODEC_PCM16 = 0
+CODEC_IMA_ADPCM = 1
+
+CABECERA = struct.Struct("<IBBHIIIIIIIIII")
+
+PASOS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDICES = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def muestras_por_bloque(codec):
+    return (TAM_BLOQUE - 4) * 2 + 1 if codec == CODEC_IMA_ADPCM else TAM_BLOQUE // 2
+
+
+def leer_wav(ruta):
+    """Devuelve (frecuencia, muestras mono en el rango de 16 bits)."""
+    with wave.open(ruta, "rb") as w:
+        canales, ancho, frecuencia, cuadros = w.getnchannels(), w.getsampwidth(), w.getframerate(), w.getnframes()
+        crudo = w.readframes(cuadros)
+
+    if ancho == 1:
+        valores = [(b - 128) << 8 for b in crudo]
+    elif ancho == 2:
+        valores = list(struct.unpack(f"<{len(crudo) // 2}h", crudo))
+    elif ancho == 3:
+        valores = [int.from_bytes(crudo[i:i + 3], "little", signed=True) >> 8 for i in range(0, len(crudo), 3)]
+    elif ancho == 4:
+        valores = [v >> 16 for v in struct.unpack(f"<{len(crudo) // 4}i", crudo)]
+    else:
+        sys.exit(f"{ruta}: {ancho * 8} bits por muestra no soportado")
+
+    mono = [sum(valores[i:i + canales]) // canales for i in range(0, len(valores), canales)]
+    return frecuencia, mono
+
+
+def remuestrear(muestras, origen, destino):
+    """Interpolación lineal; suficiente para música que luego pasa por ADPCM de 4 bits."""
+    if origen == destino or not muestras:
+        return muestras
+    total = int(len(muestras) * destino / origen)
+    razon = origen / destino
+    salida = []
+    for i in range(total):
+        x = i * razon
+        j = int(x)
+        f = x - j
+        a = muestras[j]
+        b = muestras[j + 1] if j + 1 < len(muestras) else a
+        salida.append(int(round(a + (b - a) * f)))
+    return salida
+
+
+def limitar(valor, minimo, maximo):
+    return minimo if valor < minimo else maximo if valor > maximo else valor
+
+
+def codificar_bloque_ima(muestras, indice):
+    """Codifica un bloque; el predictor reproduce exactamente al decodificador del ESP32."""
+    predictor = muestras[0]
+    datos = bytearray(struct.pack("<hBB", predictor, indice, 0))
+    nibbles = []
+    for muestra in muestras[1:]:
+        paso = PASOS[indice]
+        diferencia = muestra - predictor
+        nibble = 0
+        if diferencia < 0:
+            nibble = 8
+            diferencia = -diferencia
+        delta = paso >> 3
+        if diferencia >= paso:
+            nibble |= 4
+            diferencia -= paso
+            delta += paso
+        paso >>= 1
+        if diferencia >= paso:
+            nibble |= 2
+            diferencia -= paso
+            delta += paso
+        paso >>= 1
+        if diferencia >= paso:
+            nibble |= 1
+            delta += paso
+        predictor = limitar(predictor - delta if nibble & 8 else predictor + delta, -32768, 32767)
+        indice = limitar(indice + INDICES[nibble], 0, 88)
+        nibbles.append(nibble)
+    for i in range(0, len(nibbles), 2):
+        datos.append(nibbles[i] | (nibbles[i + 1] << 4))
+    return bytes(datos), indice
+
+
+def decodificar_bloque_ima(datos):
+    predictor, indice, _ = struct.unpack_from("<hBB", datos)
+    indice = min(indice, 88)
+    salida = [predictor]
+    for byte in datos[4:]:
+        for nibble in (byte & 0x0F, byte >> 4):
+            paso = PASOS[indice]
+            delta = paso >> 3
+            if nibble & 4:
+                delta += paso
+            if nibble & 2:
+                delta += paso >> 1
+            if nibble & 1:
+                delta += paso >> 2
+            predictor = limitar(predictor - delta if nibble & 8 else predictor + delta, -32768, 32767)
+            indice = limitar(indice + INDICES[nibble], 0, 88)
+            salida.append(predictor)
+    return salida
+
+
+def codificar(muestras, codec):
+    """Lista de bloques de TAM_BLOQUE bytes; el último se rellena con silencio."""
+    por_bloque = muestras_por_bloque(codec)
+    bloques = []
+    indice = 0
+    for inicio in range(0, len(muestras), por_bloque):
+        tramo = muestras[inicio:inicio + por_bloque]
+        tramo += [0] * (por_bloque - len(tramo))
+        if codec == CODEC_IMA_ADPCM:
+            datos, indice = codificar_bloque_ima(tramo, indice)
+        else:
+            datos = struct.pack(f"<{por_bloque}h", *tramo)
+        bloques.append(datos)
+    return bloques
+
+
+def decodificar(bloques, codec, total):
+    salida = []
+    for datos in bloques:
+        if codec == CODEC_IMA_ADPCM:
+            salida.extend(decodificar_bloque_ima(datos))
+        else:
+            salida.extend(struct.unpack(f"<{len(datos) // 2}h", datos))
+    return salida[:total]
+
+
+def alinear(valor):
+    return (valor + TAM_SECTOR - 1) // TAM_SECTOR * TAM_SECTOR
+
+
+def escribir_pista(ruta, bloques, codec, total, inicio_bucle, fin_bucle):
+    entradas = (len(bloques) + INTERVALO_BUSQUEDA - 1) // INTERVALO_BUSQUEDA
+    desplazamiento_busqueda = TAM_SECTOR
+    desplazamiento_datos = alinear(desplazamiento_busqueda + entradas * 4)
+    tabla = [desplazamiento_datos + i * INTERVALO_BUSQUEDA * TAM_BLOQUE for i in range(entradas)]
+
+    cabecera = CABECERA.pack(
+        MAGIA, VERSION, codec, TAM_BLOQUE, FRECUENCIA, muestras_por_bloque(codec), total, len(bloques),
+        inicio_bucle, fin_bucle, INTERVALO_BUSQUEDA, entradas, desplazamiento_busqueda, desplazamiento_datos)
+    with open(ruta, "wb") as f:
+        f.write(cabecera.ljust(TAM_SECTOR, b"\0"))
+        f.write(struct.pack(f"<{entradas}I", *tabla).ljust(desplazamiento_datos - desplazamiento_busqueda, b"\0"))
+        for datos in bloques:
+            f.write(datos)
+    return desplazamiento_datos + len(bloques) * TAM_BLOQUE
+
+
+def escribir_wav(ruta, muestras):
+    with wave.open(ruta, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(FRECUENCIA)
+        w.writeframes(struct.pack(f"<{len(muestras)}h", *muestras))
+
+
+def relacion_senal_ruido(original, decodificado):
+    senal = sum(m * m for m in original)
+    ruido = sum((a - b) ** 2 for a, b in zip(original, decodificado))
+    return math.inf if ruido == 0 else 10 * math.log10(max(senal, 1) / ruido)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("entrada", help="archivo WAV")
+    parser.add_argument("salida", help="archivo .adp para la SD")
+    parser.add_argument("--pcm", action="store_true", help="PCM de 16 bits en lugar de IMA-ADPCM (4x más grande)")
+    bucle = parser.add_mutually_exclusive_group()
+    bucle.add_argument("--bucle", nargs=2, type=float, metavar=("INICIO", "FIN"), help="tramo que se repite, en segundos")
+    bucle.add_argument("--sin-bucle", action="store_true", help="reproducir una sola vez")
+    parser.add_argument("--ganancia", type=float, default=1.0, help="factor aplicado antes de codificar")
+    parser.add_argument("--verificar", metavar="WAV", help="decodificar el resultado a este WAV para escucharlo")
+    args = parser.parse_args()
+
+    frecuencia, muestras = leer_wav(args.entrada)
+    muestras = remuestrear(muestras, frecuencia, FRECUENCIA)
+    if args.ganancia != 1.0:
+        muestras = [limitar(int(m * args.ganancia), -32768, 32767) for m in muestras]
+    total = len(muestras)
+    if total == 0:
+        sys.exit(f"{args.entrada}: no tiene muestras")
+
+    if args.sin_bucle:
+        inicio_bucle, fin_bucle = SIN_BUCLE, 0
+    elif args.bucle:
+        inicio_bucle = int(args.bucle[0] * FRECUENCIA)
+        fin_bucle = min(int(args.bucle[1] * FRECUENCIA), total)
+        if not 0 <= inicio_bucle < fin_bucle:
+            sys.exit("el bucle debe cumplir 0 <= INICIO < FIN dentro de la pista")
+    else:
+        inicio_bucle, fin_bucle = 0, total
+
+    codec = CODEC_PCM16 if args.pcm else CODEC_IMA_ADPCM
+    bloques = codificar(muestras, codec)
+    tamano = escribir_pista(args.salida, bloques, codec, total, inicio_bucle, fin_bucle)
+
+    print(f"{args.salida}: {'PCM16' if args.pcm else 'IMA-ADPCM'}, {total / FRECUENCIA:.2f} s, "
+          f"{len(bloques)} bloques, {tamano} bytes ({tamano * 8 / (total / FRECUENCIA) / 1000:.1f} kbit/s)")
+    if inicio_bucle != SIN_BUCLE:
+        print(f"bucle: {inicio_bucle / FRECUENCIA:.3f} s -> {fin_bucle / FRECUENCIA:.3f} s")
+
+    if args.verificar:
+        decodificado = decodificar(bloques, codec, total)
+        escribir_wav(args.verificar, decodificado)
+        print(f"{args.verificar}: SNR {relacion_senal_ruido(muestras, decodificado):.1f} dB")
+
+
+if __name__ == "__main__":
+    main()